@@ -86,6 +86,8 @@ SOURCES = [
     "ldapentry.c",
     "ldapconnectiter.c",
     "ldapconnection.c",
+    "ldapdn.c",
+    "ldapfilter.c",
     "ldapmodlist.c",
     "ldap-xplat.c",
     "ldapsearchiter.c",
@@ -96,6 +98,7 @@ DEPENDS = [
     "ldapconnection.h",
     "ldapentry.h",
     "ldapconnectiter.h",
+    "ldapdn.h",
     "ldapmodlist.h",
     "ldapsearchiter.h",
     "ldap-xplat.h",
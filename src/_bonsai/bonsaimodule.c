@@ -7,6 +7,8 @@
 #include "ldapsearchiter.h"
 #include "ldapmodlist.h"
 #include "ldapconnectiter.h"
+#include "ldapdn.h"
+#include "ldapfilter.h"
 #include "utils.h"
 
 PyObject *LDAPDNObj = NULL;
@@ -110,6 +112,72 @@ bonsai_unique_contains(PyObject *self, PyObject *args) {
     return unique_contains(list, value);
 }
 
+/* Parse a DN string into its RDNs and normalized form. */
+static PyObject *
+bonsai_parse_dn(PyObject *self, PyObject *args) {
+    PyObject *strdn = NULL;
+
+    if (!PyArg_ParseTuple(args, "U", &strdn)) return NULL;
+
+    return parse_dn(strdn);
+}
+
+/* Return the normalized form of a DN string. */
+static PyObject *
+bonsai_normalize_dn(PyObject *self, PyObject *args) {
+    PyObject *strdn = NULL;
+
+    if (!PyArg_ParseTuple(args, "U", &strdn)) return NULL;
+
+    return normalize_dn(strdn);
+}
+
+/* Encode the value of an attribute scoped query control. */
+static PyObject *
+bonsai_encode_asq_control(PyObject *self, PyObject *args) {
+    int rc = 0;
+    char *attr = NULL;
+    LDAPControl *ctrl = NULL;
+    PyObject *value = NULL;
+
+    if (!PyArg_ParseTuple(args, "s", &attr)) return NULL;
+
+    rc = _ldap_create_asq_control(NULL, attr, &ctrl);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(NULL, rc);
+        return NULL;
+    }
+    value = PyBytes_FromStringAndSize(ctrl->ldctl_value.bv_val,
+        ctrl->ldctl_value.bv_len);
+    _ldap_control_free(ctrl);
+    return value;
+}
+
+/* Decode the result code from the value of an attribute scoped query
+   response control. */
+static PyObject *
+bonsai_decode_asq_control(PyObject *self, PyObject *args) {
+    int rc = 0;
+    int result = 0;
+    Py_buffer buf;
+    LDAPControl ctrl;
+    LDAPControl *ctrls[2] = {&ctrl, NULL};
+
+    if (!PyArg_ParseTuple(args, "y*", &buf)) return NULL;
+
+    ctrl.ldctl_oid = (char *)LDAP_SERVER_ASQ_OID;
+    ctrl.ldctl_value.bv_val = (char *)buf.buf;
+    ctrl.ldctl_value.bv_len = (ber_len_t)buf.len;
+    ctrl.ldctl_iscritical = 0;
+    rc = _ldap_parse_asq_control(ctrls, &result);
+    PyBuffer_Release(&buf);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(NULL, rc);
+        return NULL;
+    }
+    return PyLong_FromLong(result);
+}
+
 static void
 bonsai_free(PyObject *self) {
     Py_DECREF(LDAPDNObj);
@@ -132,6 +200,16 @@ static PyMethodDef bonsai_methods[] = {
     {"_unique_contains", (PyCFunction)bonsai_unique_contains, METH_VARARGS,
         "Check that the item is in the LDAPValueList. Returns with a tuple of"
         "status of the search and the matched element."},
+    {"_parse_dn", (PyCFunction)bonsai_parse_dn, METH_VARARGS,
+        "Parse a DN string. Returns with a tuple of the RDN strings, the RDNs"
+        " as tuples of attribute type and value pairs, and the normalized DN."},
+    {"_normalize_dn", (PyCFunction)bonsai_normalize_dn, METH_VARARGS,
+        "Return the normalized form of a DN string."},
+    {"_encode_asq_control", (PyCFunction)bonsai_encode_asq_control,
+        METH_VARARGS, "Return the BER encoded value of an ASQ control."},
+    {"_decode_asq_control", (PyCFunction)bonsai_decode_asq_control,
+        METH_VARARGS, "Return the result code of a BER encoded ASQ response"
+        " control."},
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -165,6 +243,7 @@ PyInit__bonsai(void) {
     if (PyType_Ready(&LDAPConnectIterType) < 0) return NULL;
     if (PyType_Ready(&LDAPEntryType) < 0) return NULL;
     if (PyType_Ready(&LDAPModListType) < 0) return NULL;
+    if (PyType_Ready(&LDAPFilterType) < 0) return NULL;
 
     Py_INCREF(&LDAPEntryType);
     PyModule_AddObject(module, "ldapentry", (PyObject *)&LDAPEntryType);
@@ -175,5 +254,8 @@ PyInit__bonsai(void) {
     Py_INCREF(&LDAPSearchIterType);
     PyModule_AddObject(module, "ldapsearchiter", (PyObject *)&LDAPSearchIterType);
 
+    Py_INCREF(&LDAPFilterType);
+    PyModule_AddObject(module, "ldapfilter", (PyObject *)&LDAPFilterType);
+
     return module;
 }
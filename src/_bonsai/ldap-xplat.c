@@ -159,6 +159,12 @@ _ldap_control_free(LDAPControl *ctrl) {
     free(ctrl);
 }
 
+/* WinLDAP does not expose its receive buffer. */
+int
+_ldap_data_ready(LDAP *ld) {
+    return 0;
+}
+
 #else
 
 #ifdef HAVE_KRB5
@@ -317,54 +323,222 @@ set_cert_policy(LDAP *ld, int cert_policy) {
     ldap_set_option(NULL, LDAP_OPT_X_TLS_REQUIRE_CERT, &cert_policy);
 }
 
-#ifdef MACOSX
+/* The initialisation jobs are run by a shared pool of worker threads instead
+   of a new thread for every connection. The queue of the jobs, the number of
+   the workers and the state of the jobs are guarded by `init_pool_mux`. */
+static pthread_mutex_t init_pool_mux = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when a new job is queued. */
+static pthread_cond_t init_pool_cond = PTHREAD_COND_INITIALIZER;
+/* Broadcasted when a job is finished. */
+static pthread_cond_t init_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t init_pool_once = PTHREAD_ONCE_INIT;
+static ldapInitThreadData *init_queue_head = NULL;
+static ldapInitThreadData *init_queue_tail = NULL;
+static int init_pool_workers = 0;
+static int init_pool_idle = 0;
+
+static void *ldap_init_thread_func(void *params);
+
+/* Reset the pool in the child process after fork, the worker
+   threads of the parent are not present anymore. */
+static void
+init_pool_atfork_child(void) {
+    pthread_mutex_init(&init_pool_mux, NULL);
+    pthread_cond_init(&init_pool_cond, NULL);
+    pthread_cond_init(&init_done_cond, NULL);
+    init_queue_head = NULL;
+    init_queue_tail = NULL;
+    init_pool_workers = 0;
+    init_pool_idle = 0;
+}
+
+static void
+init_pool_setup(void) {
+    pthread_atfork(NULL, NULL, init_pool_atfork_child);
+}
 
-/* Drop in replacement for pthread_mutext_timedlock for Mac OS X system. */
+/* Free the initialisation data with the LDAP struct, if it's still set. */
+static void
+free_init_thread_data(ldapInitThreadData *data) {
+    if (data->ld != NULL) ldap_unbind_ext(data->ld, NULL, NULL);
+    free(data->url);
+    free(data->sasl_sec_props);
+    free(data);
+}
+
+/* Signal the end of the initialisation through the notifier descriptor. */
 static int
-_pthread_mutex_timedlock(pthread_mutex_t *mutex, struct timespec *abs_timeout) {
-    int rc = -1;
-    struct timeval timenow;
-    struct timespec rest;
+send_init_notification(SOCKET sock) {
+#ifdef __linux__
+    uint64_t val = 1;
+    if (write(sock, &val, sizeof(val)) != sizeof(val)) return -1;
+#else
+    if (write(sock, "s", 1) != 1) return -1;
+#endif
+    return 0;
+}
 
-    /* Set 10ms for sleeping time. */
-    rest.tv_sec = 0;
-    rest.tv_nsec = 10000000;
+/* Worker function of the initialisation pool. Takes the jobs from the queue
+   one by one, and runs them. An abandoned job is freed by the worker. */
+static void *
+init_pool_worker_func(void *params) {
+    ldapInitThreadData *data = NULL;
+
+    pthread_mutex_lock(&init_pool_mux);
+    while (1) {
+        while (init_queue_head == NULL) {
+            init_pool_idle++;
+            pthread_cond_wait(&init_pool_cond, &init_pool_mux);
+            init_pool_idle--;
+        }
+        data = init_queue_head;
+        init_queue_head = data->next;
+        if (init_queue_head == NULL) init_queue_tail = NULL;
 
-    DEBUG("%s", "_pthread_mutex_timedlock");
-    while ((rc = pthread_mutex_trylock(mutex)) == EBUSY) {
+        if (data->abandoned) {
+            free_init_thread_data(data);
+            continue;
+        }
+        data->flag = 1;
+        pthread_mutex_unlock(&init_pool_mux);
 
-        gettimeofday(&timenow, NULL);
+        ldap_init_thread_func(data);
 
-        if (timenow.tv_sec > abs_timeout->tv_sec || 
-            (timenow.tv_sec == abs_timeout->tv_sec &&
-            (timenow.tv_usec * 1000) >= abs_timeout->tv_nsec)) {
-            return ETIMEDOUT;
+        pthread_mutex_lock(&init_pool_mux);
+        data->flag = 2;
+        if (data->abandoned) {
+            /* Nobody is waiting on the result anymore. */
+            free_init_thread_data(data);
+            continue;
         }
-        /* Little sleep to avoid hammering on the lock. */
-        nanosleep(&rest, NULL);
+        if (data->sock != -1 && send_init_notification(data->sock) != 0) {
+            /* Signalling is failed. */
+            data->retval = -1;
+        }
+        pthread_cond_broadcast(&init_done_cond);
     }
+    return NULL;
+}
 
+/* Put the job into the pool's queue, and start a new worker if every
+   started worker is busy and the pool is not full yet. */
+static int
+submit_init_job(ldapInitThreadData *data) {
+    int rc = 0;
+    pthread_t worker;
+    pthread_attr_t attr;
+
+    pthread_once(&init_pool_once, init_pool_setup);
+    pthread_mutex_lock(&init_pool_mux);
+    if (init_pool_idle == 0 && init_pool_workers < LDAP_INIT_POOL_SIZE) {
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        rc = pthread_create(&worker, &attr, init_pool_worker_func, NULL);
+        pthread_attr_destroy(&attr);
+        if (rc == 0) init_pool_workers++;
+        else if (init_pool_workers > 0) rc = 0;
+    }
+    if (rc == 0) {
+        data->next = NULL;
+        if (init_queue_tail != NULL) init_queue_tail->next = data;
+        else init_queue_head = data;
+        init_queue_tail = data;
+        pthread_cond_signal(&init_pool_cond);
+    }
+    pthread_mutex_unlock(&init_pool_mux);
     return rc;
 }
+
+/* Give up the initialisation job. A queued or running job is marked, thus
+   the worker will drop it, a finished job is freed immediately. */
+void
+_ldap_abandon_init_thread(void *misc) {
+    ldapInitThreadData *data = (ldapInitThreadData *)misc;
+
+    if (data == NULL) return;
+
+    DEBUG("_ldap_abandon_init_thread (misc:%p)", misc);
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&init_pool_mux);
+    data->sock = -1;
+#ifdef HAVE_KRB5
+    /* The running job uses the connection info that is freed by the
+       caller after abandoning, it has to be waited to be finished. */
+    while (data->flag == 1 && data->info->request_tgt == 1) {
+        pthread_cond_wait(&init_done_cond, &init_pool_mux);
+    }
+#endif
+    if (data->flag != 2) {
+        data->abandoned = 1;
+        data = NULL;
+    }
+    pthread_mutex_unlock(&init_pool_mux);
+    Py_END_ALLOW_THREADS
+    if (data != NULL) free_init_thread_data(data);
+}
+
+/* Create a notifier for signalling the end of the initialisation. On Linux,
+   an eventfd is used (the `csock` and `ssock` are the same), elsewhere a
+   pipe's read and write ends. */
+int
+create_init_notifier(SOCKET *csock, SOCKET *ssock) {
+#ifdef __linux__
+    *csock = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (*csock == -1) goto error;
+    *ssock = *csock;
 #else
-static int
-_pthread_mutex_timedlock(pthread_mutex_t *mutex, struct timespec *abs_timeout) {
-    DEBUG("%s", "_pthread_mutex_timedlock");
-    return pthread_mutex_timedlock(mutex, abs_timeout);
+    int fds[2];
+
+    if (pipe(fds) != 0) goto error;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    *csock = fds[0];
+    *ssock = fds[1];
+#endif
+    return 0;
+error:
+    PyErr_SetFromErrno(PyExc_OSError);
+    return -1;
 }
+
+/* Read and drop the signal from the notifier. */
+int
+read_init_notifier(SOCKET csock) {
+#ifdef __linux__
+    uint64_t val = 0;
+    if (read(csock, &val, sizeof(val)) != sizeof(val)) goto error;
+#else
+    char buff[1];
+    if (read(csock, buff, 1) != 1) goto error;
 #endif
+    return 0;
+error:
+    PyErr_SetFromErrno(PyExc_OSError);
+    return -1;
+}
 
-/* Check on the initialisation thread and set cert policy. The `misc`
-   parameter is never used (on Linux platform). The pointer of initialised
-   LDAP struct is passed to the `ld` parameter. Return 1 if the initialisation
-   thread is finished, 0 if it is still in progress, and -1 for error. */
+/* Close the descriptors of the notifier, and set them to -1. */
+void
+close_init_notifier(SOCKET *csock, SOCKET *ssock) {
+    if (*ssock != -1 && *ssock != *csock) close(*ssock);
+    if (*csock != -1) close(*csock);
+    *csock = -1;
+    *ssock = -1;
+}
+
+/* Check on the initialisation job and set cert policy. The `thread`
+   parameter is never used (on Unix platforms), the `misc` is the job's data.
+   The pointer of initialised LDAP struct is passed to the `ld` parameter.
+   Return 1 if the initialisation is finished, 0 if it is still in progress,
+   and -1 for error. The job's data is freed, unless 0 is returned. */
 int
 _ldap_finish_init_thread(char async, XTHREAD thread, int *timeout, void *misc, LDAP **ld) {
     int rc = 0;
+    int finished = 0;
     ldapInitThreadData *val = (ldapInitThreadData *)misc;
     struct timespec ts;
     struct timeval now;
-    struct timespec rest;
     int wait_msec = 100;
     long long nanosecs = 0;
     unsigned long long start_time, end_time;
@@ -373,8 +547,8 @@ _ldap_finish_init_thread(char async, XTHREAD thread, int *timeout, void *misc, L
     /* Sanity check. */
     if (val == NULL) return -1;
 
-    DEBUG("_ldap_finish_init_thread (async:%d, thread:%lu, timeout:%d, misc:%p)",
-            async, thread, *timeout, misc);
+    DEBUG("_ldap_finish_init_thread (async:%d, timeout:%d, misc:%p)",
+            async, *timeout, misc);
     if (async) {
         wait_msec = 100;
     } else if (*timeout == -1) {
@@ -387,9 +561,9 @@ _ldap_finish_init_thread(char async, XTHREAD thread, int *timeout, void *misc, L
     /* Create absolute time. */
     rc = gettimeofday(&now, NULL);
     if (rc != 0) {
+        _ldap_abandon_init_thread(val);
         PyErr_BadInternalCall();
-        retval = -1;
-        goto end;
+        return -1;
     }
     ts.tv_sec = now.tv_sec;
     nanosecs = (now.tv_usec + 1000UL * wait_msec) * 1000UL;
@@ -400,84 +574,60 @@ _ldap_finish_init_thread(char async, XTHREAD thread, int *timeout, void *misc, L
     }
     ts.tv_nsec = (long)nanosecs;
 
-    /* Waiting on thread to release the lock. */
-    rc = _pthread_mutex_timedlock(val->mux, &ts);
+    /* Waiting on the worker to finish the job. */
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&init_pool_mux);
+    rc = 0;
+    while (val->flag != 2 && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&init_done_cond, &init_pool_mux, &ts);
+    }
+    finished = (val->flag == 2);
+    pthread_mutex_unlock(&init_pool_mux);
+    Py_END_ALLOW_THREADS
+
+    if (!finished) {
+        if (async) return 0;
+        _ldap_abandon_init_thread(val);
+        set_exception(NULL, LDAP_TIMEOUT);
+        return -1;
+    }
 
-    switch (rc) {
-    case ETIMEDOUT:
-        if (async == 0) {
-            pthread_cancel(thread);
-            set_exception(NULL, LDAP_TIMEOUT);
-            free(val->ld);
-            retval = -1;
-            goto end;
-        }
-        return 0;
-    case 0:
-        if (val->flag == 0) {
-            /* Premature locking, thread function is not finished. */
-            pthread_mutex_unlock(val->mux);
-            /* Set 5ms for sleeping time. */
-            rest.tv_sec = 0;
-            rest.tv_nsec = 5000000;
-            /* Take a nap, try to avoid constantly locking from the main thread. */
-            nanosleep(&rest, NULL);
-            if (*timeout != -1) {
-                *timeout -= 5;
-                if (*timeout < 0) *timeout = 0;
-            }
-            return 0;
-        }
-        /* Block until thread is finished, but if it's async already
-           waited enough on releasing the lock. */
-        rc = pthread_join(thread, NULL);
-        /* Thread is finished. */
-        if (val->retval != LDAP_SUCCESS) {
+    /* The job is finished. */
+    if (val->retval != LDAP_SUCCESS) {
 #ifdef HAVE_KRB5
-            if (val->info->errmsg != NULL) {
-                PyObject *error = get_error_by_code(0x31);
-                if (error == NULL) goto end;
-                PyErr_SetString(error, val->info->errmsg);
-                Py_DECREF(error);
-            } else {
-                set_exception(NULL, val->retval);
-            }
-#else
+        if (val->info->errmsg != NULL) {
+            PyObject *error = get_error_by_code(0x31);
+            if (error == NULL) goto end;
+            PyErr_SetString(error, val->info->errmsg);
+            Py_DECREF(error);
+        } else {
             set_exception(NULL, val->retval);
-#endif
-            free(val->ld);
-            retval = -1;
-            goto end;
         }
-        if (*timeout != -1) {
-            /* Calculate passed time in milliseconds. */
-            start_time = (unsigned long long)(now.tv_sec) * 1000
-                    + (unsigned long long)(now.tv_usec) / 1000;
-
-            gettimeofday(&now, NULL);
-            end_time = (unsigned long long)(now.tv_sec) * 1000
-                            + (unsigned long long)(now.tv_usec) / 1000;
-            /* Deduct the passed time from the overall timeout. */
-            *timeout -= (end_time - start_time);
-            if (*timeout < 0) *timeout = 0;
-        }
-        /* Set initialised LDAP struct pointer. */
-        *ld = val->ld;
-        retval = 1;
-        goto end;
-    default:
-        /* The thread is failed. */
-        PyErr_BadInternalCall();
+#else
+        set_exception(NULL, val->retval);
+#endif
         retval = -1;
         goto end;
     }
+    if (*timeout != -1) {
+        /* Calculate passed time in milliseconds. */
+        start_time = (unsigned long long)(now.tv_sec) * 1000
+                + (unsigned long long)(now.tv_usec) / 1000;
+
+        gettimeofday(&now, NULL);
+        end_time = (unsigned long long)(now.tv_sec) * 1000
+                        + (unsigned long long)(now.tv_usec) / 1000;
+        /* Deduct the passed time from the overall timeout. */
+        *timeout -= (end_time - start_time);
+        if (*timeout < 0) *timeout = 0;
+    }
+    /* Set initialised LDAP struct pointer. */
+    *ld = val->ld;
+    val->ld = NULL;
+    retval = 1;
 end:
     /* Clean-up. */
-    free(val->url);
-    free(val->sasl_sec_props);
-    pthread_mutex_destroy(val->mux);
-    free(val->mux);
-    free(val);
+    free_init_thread_data(val);
     return retval;
 }
 
@@ -597,6 +747,19 @@ _ldap_control_free(LDAPControl *ctrl) {
     ldap_control_free(ctrl);
 }
 
+/* Check that libldap has already received data in its socket buffer, that
+   is not processed yet. Such data does not make the socket readable again. */
+int
+_ldap_data_ready(LDAP *ld) {
+    Sockbuf *sb = NULL;
+
+    if (ldap_get_option(ld, LDAP_OPT_SOCKBUF, &sb) != LDAP_OPT_SUCCESS
+            || sb == NULL) {
+        return 0;
+    }
+    return ber_sockbuf_ctrl(sb, LBER_SB_OPT_DATA_READY, NULL) > 0;
+}
+
 #endif
 
 /*  This function is based on the OpenLDAP liblutil's sasl.c source
@@ -688,9 +851,10 @@ dealloc_conn_info(ldap_conndata_t* info) {
 /* Thread function. The ldap_initialize function opens the LDAP client's
 config file on Unix and ldap_start_tls_s blocks for create SSL context on Windows,
 thus to avoid the I/O blocking in the main (Python) thread the initialisation
-is done in a separate (POSIX and Windows) thread. A signal is sent through an
-internal socketpair when the thread is finished, thus select() can be used on
-the socket descriptor. */
+is done in a separate thread: a new one on Windows, and one of the shared
+pool's workers on Unix. A signal is sent through an internal socketpair
+(Windows) or notifier descriptor (Unix) when the initialisation is finished,
+thus select() can be used on the descriptor. */
 #ifdef WIN32
 static int WINAPI
 #else
@@ -710,11 +874,6 @@ ldap_init_thread_func(void *params) {
         return NULL;
 #endif
     }
-#ifndef WIN32
-    pthread_mutex_lock(data->mux);
-    /* Lock already acquired by this thread, flag can be set now. */
-    data->flag = 1;
-#endif
     rc = ldap_initialize(&(data->ld), data->url);
     if (rc != LDAP_SUCCESS) {
         data->retval = rc;
@@ -764,6 +923,7 @@ ldap_init_thread_func(void *params) {
     }
 #endif
 end:
+#ifdef WIN32
     if (data->sock != -1) {
         /* Send a signal through an internal socketpair. */
         if (send(data->sock, "s", 1, 0) == -1) {
@@ -772,15 +932,17 @@ end:
         }
     }
     DEBUG("ldap_init_thread_func [retval:%d]", data->retval);
-#ifdef WIN32
     return 0;
 #else
-    pthread_mutex_unlock(data->mux);
+    /* The signal is sent by the pool's worker. */
+    DEBUG("ldap_init_thread_func [retval:%d]", data->retval);
     return NULL;
 #endif
 }
 
-/*  Create a platform-independent initialisation thread.
+/*  Create a platform-independent initialisation thread. On Unix, the
+    initialisation is queued to the shared worker pool instead, and the
+    `thread` parameter is not set.
     On success it returns 0 and sets the thread parameter,
     on failure returns -1.
 */
@@ -789,26 +951,16 @@ create_init_thread(void *param, ldap_conndata_t *info, XTHREAD *thread) {
     int rc = 0;
     ldapInitThreadData *data = (ldapInitThreadData *)param;
     
-    DEBUG("create_init_thread (ld:%p, info:%p, thread:%lu)", param, info, *thread);
+    DEBUG("create_init_thread (ld:%p, info:%p)", param, info);
 #ifdef WIN32
     *thread = CreateThread(NULL, 0, ldap_init_thread_func, (void *)data, 0, NULL);
     if (*thread == NULL) rc = -1;
 #else
-    data->mux = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    if (data->mux == NULL) {
-        PyErr_NoMemory();
-        return -1;
-    }
-
-    rc = pthread_mutex_init(data->mux, NULL);
-    if (rc != 0) {
-        PyErr_BadInternalCall();
-        return -1;
-    }
-    pthread_mutex_lock(data->mux);
     data->flag = 0;
-#ifdef HAVE_KRB5
+    data->abandoned = 0;
+    data->next = NULL;
     data->info = info;
+#ifdef HAVE_KRB5
     if (data->info->mech != NULL && (strcmp("GSSAPI", data->info->mech) == 0 ||
             strcmp("GSS-SPNEGO", data->info->mech) == 0)
             && data->info->realm != NULL && strlen(data->info->realm) != 0
@@ -818,9 +970,11 @@ create_init_thread(void *param, ldap_conndata_t *info, XTHREAD *thread) {
         if (rc != 0) return -1;
     }
 #endif
-    pthread_mutex_unlock(data->mux);
-
-    rc = pthread_create(thread, NULL, ldap_init_thread_func, data);
+    rc = submit_init_job(data);
+    if (rc != 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+            "Failed to start the initialisation worker thread.");
+    }
 #endif
     if (rc != 0) return -1;
 
@@ -876,3 +1030,189 @@ int _ldap_create_sd_flags_control(LDAP *ld, int flags, LDAPControl **edn_ctrl) {
     *edn_ctrl = ctrl;
     return LDAP_SUCCESS;
 }
+
+/* Create a Sync Request control of the content synchronization (RFC 4533). */
+int _ldap_create_sync_control(LDAP *ld, int mode, struct berval *cookie,
+        int reload_hint, LDAPControl **sync_ctrl) {
+    int rc = -1;
+    BerElement *ber = NULL;
+    struct berval *value = NULL;
+    LDAPControl *ctrl = NULL;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) return LDAP_NO_MEMORY;
+
+    /* Transcode the data into a berval struct. */
+    rc = ber_printf(ber, "{e", mode);
+    if (rc != -1 && cookie != NULL && cookie->bv_val != NULL) {
+        rc = ber_printf(ber, "O", cookie);
+    }
+    if (rc != -1 && reload_hint) rc = ber_printf(ber, "b", (ber_int_t)1);
+    if (rc != -1) rc = ber_printf(ber, "}");
+    if (rc == -1) {
+        ber_free(ber, 1);
+        return LDAP_ENCODING_ERROR;
+    }
+    rc = ber_flatten(ber, &value);
+    ber_free(ber, 1);
+    if (rc != 0) return rc;
+
+    rc = ldap_control_create(LDAP_CONTROL_SYNC, 1, value, 1, &ctrl);
+    ber_bvfree(value);
+
+    if (rc != LDAP_SUCCESS) return rc;
+
+    *sync_ctrl = ctrl;
+    return LDAP_SUCCESS;
+}
+
+/* Create an LDAP_SERVER_DIRSYNC control of Active Directory. */
+int _ldap_create_dirsync_control(LDAP *ld, unsigned int flags, int max_bytes,
+        struct berval *cookie, LDAPControl **dirsync_ctrl) {
+    int rc = -1;
+    BerElement *ber = NULL;
+    struct berval *value = NULL;
+    struct berval empty = {0, NULL};
+    LDAPControl *ctrl = NULL;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) return LDAP_NO_MEMORY;
+
+    /* The flags are a 32-bit mask, the incremental values flag is the
+       sign bit of the encoded INTEGER. */
+    if (cookie == NULL || cookie->bv_val == NULL) cookie = &empty;
+    rc = ber_printf(ber, "{iiO}", (ber_int_t)flags, (ber_int_t)max_bytes,
+        cookie);
+    if (rc == -1) {
+        ber_free(ber, 1);
+        return LDAP_ENCODING_ERROR;
+    }
+    rc = ber_flatten(ber, &value);
+    ber_free(ber, 1);
+    if (rc != 0) return rc;
+
+    rc = ldap_control_create(LDAP_SERVER_DIRSYNC_OID, 1, value, 1, &ctrl);
+    ber_bvfree(value);
+
+    if (rc != LDAP_SUCCESS) return rc;
+
+    *dirsync_ctrl = ctrl;
+    return LDAP_SUCCESS;
+}
+
+/* Parse the LDAP_SERVER_DIRSYNC response control from the list of the
+   returned controls. The `cookie` is set to NULL, if the control is
+   missing, otherwise it has to be freed with ber_bvfree. */
+int _ldap_parse_dirsync_control(LDAPControl **ctrls, int *more_results,
+        struct berval **cookie) {
+    int i = 0;
+    ber_int_t more = 0, unused = 0;
+    BerElement *ber = NULL;
+
+    *cookie = NULL;
+    *more_results = 0;
+    if (ctrls == NULL) return LDAP_SUCCESS;
+
+    for (i = 0; ctrls[i] != NULL; i++) {
+        if (strcmp(ctrls[i]->ldctl_oid, LDAP_SERVER_DIRSYNC_OID) == 0) break;
+    }
+    if (ctrls[i] == NULL) return LDAP_SUCCESS;
+
+    ber = ber_init(&(ctrls[i]->ldctl_value));
+    if (ber == NULL) return LDAP_NO_MEMORY;
+    if (ber_scanf(ber, "{iiO}", &more, &unused, cookie) == LBER_ERROR) {
+        ber_free(ber, 1);
+        *cookie = NULL;
+        return LDAP_DECODING_ERROR;
+    }
+    ber_free(ber, 1);
+    *more_results = (more != 0);
+    return LDAP_SUCCESS;
+}
+
+/* Create an LDAP_SERVER_ASQ control of Active Directory, that runs the
+   search on the entries referenced by the `attr` of the base entry. */
+int _ldap_create_asq_control(LDAP *ld, char *attr, LDAPControl **asq_ctrl) {
+    int rc = -1;
+    BerElement *ber = NULL;
+    struct berval *value = NULL;
+    LDAPControl *ctrl = NULL;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) return LDAP_NO_MEMORY;
+
+    rc = ber_printf(ber, "{s}", attr);
+    if (rc == -1) {
+        ber_free(ber, 1);
+        return LDAP_ENCODING_ERROR;
+    }
+    rc = ber_flatten(ber, &value);
+    ber_free(ber, 1);
+    if (rc != 0) return rc;
+
+    rc = ldap_control_create(LDAP_SERVER_ASQ_OID, 1, value, 1, &ctrl);
+    ber_bvfree(value);
+
+    if (rc != LDAP_SUCCESS) return rc;
+
+    *asq_ctrl = ctrl;
+    return LDAP_SUCCESS;
+}
+
+/* Parse the result code of the LDAP_SERVER_ASQ response control from the
+   list of the returned controls. The `result` is left LDAP_SUCCESS, if
+   the control is not in the list. */
+int _ldap_parse_asq_control(LDAPControl **ctrls, int *result) {
+    int i = 0;
+    ber_int_t code = 0;
+    BerElement *ber = NULL;
+
+    *result = LDAP_SUCCESS;
+    if (ctrls == NULL) return LDAP_SUCCESS;
+
+    for (i = 0; ctrls[i] != NULL; i++) {
+        if (strcmp(ctrls[i]->ldctl_oid, LDAP_SERVER_ASQ_OID) == 0) break;
+    }
+    if (ctrls[i] == NULL) return LDAP_SUCCESS;
+
+    ber = ber_init(&(ctrls[i]->ldctl_value));
+    if (ber == NULL) return LDAP_NO_MEMORY;
+    if (ber_scanf(ber, "{e}", &code) == LBER_ERROR) {
+        ber_free(ber, 1);
+        return LDAP_DECODING_ERROR;
+    }
+    ber_free(ber, 1);
+    *result = (int)code;
+    return LDAP_SUCCESS;
+}
+
+/* Create a persistent search control, that asks for the entry change
+   notification controls too. */
+int _ldap_create_psearch_control(LDAP *ld, int change_types,
+        int changes_only, LDAPControl **psearch_ctrl) {
+    int rc = -1;
+    BerElement *ber = NULL;
+    struct berval *value = NULL;
+    LDAPControl *ctrl = NULL;
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) return LDAP_NO_MEMORY;
+
+    rc = ber_printf(ber, "{ibb}", (ber_int_t)change_types,
+        (ber_int_t)(changes_only != 0), (ber_int_t)1);
+    if (rc == -1) {
+        ber_free(ber, 1);
+        return LDAP_ENCODING_ERROR;
+    }
+    rc = ber_flatten(ber, &value);
+    ber_free(ber, 1);
+    if (rc != 0) return rc;
+
+    rc = ldap_control_create(LDAP_CONTROL_PERSIST_REQUEST, 1, value, 1, &ctrl);
+    ber_bvfree(value);
+
+    if (rc != LDAP_SUCCESS) return rc;
+
+    *psearch_ctrl = ctrl;
+    return LDAP_SUCCESS;
+}
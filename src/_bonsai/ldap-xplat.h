@@ -26,6 +26,11 @@ int _ldap_parse_passwordpolicy_control(LDAP *ld, LDAPControl **ctrls,
 #include <sys/time.h>
 #include <pthread.h>
 #include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 #ifdef HAVE_KRB5
 #include <krb5.h>
@@ -80,24 +85,92 @@ typedef struct ldap_thread_data_s {
     SOCKET sock;
 #ifdef WIN32
 #else
-    /* For the POSIX's thread. */
-    pthread_mutex_t *mux;
+    /* For the shared worker pool, guarded by the pool's mutex.
+       The flag is 0 if the job is queued, 1 if it's running
+       and 2 if it's finished. */
     int flag;
+    char abandoned;
+    struct ldap_thread_data_s *next;
     ldap_conndata_t *info;
 #endif
 } ldapInitThreadData;
 
+/* Maximal number of threads for initialising connections. */
+#define LDAP_INIT_POOL_SIZE 4
+
 #define LDAP_SERVER_EXTENDED_DN_OID "1.2.840.113556.1.4.529"
 #define LDAP_SERVER_TREE_DELETE_OID "1.2.840.113556.1.4.805"
 #define LDAP_SERVER_SD_FLAGS_OID "1.2.840.113556.1.4.801"
+#ifndef LDAP_SERVER_DIRSYNC_OID
+#define LDAP_SERVER_DIRSYNC_OID "1.2.840.113556.1.4.841"
+#endif
+#ifndef LDAP_SERVER_NOTIFICATION_OID
+#define LDAP_SERVER_NOTIFICATION_OID "1.2.840.113556.1.4.528"
+#endif
+#ifndef LDAP_SERVER_ASQ_OID
+#define LDAP_SERVER_ASQ_OID "1.2.840.113556.1.4.1504"
+#endif
+
+/* Matched values control (RFC 3876). */
+#ifndef LDAP_CONTROL_VALUESRETURNFILTER
+#define LDAP_CONTROL_VALUESRETURNFILTER "1.2.826.0.1.3344810.2.3"
+#endif
+
+/* Persistent search (draft-ietf-ldapext-psearch). */
+#ifndef LDAP_CONTROL_PERSIST_REQUEST
+#define LDAP_CONTROL_PERSIST_REQUEST "2.16.840.1.113730.3.4.3"
+#define LDAP_CONTROL_PERSIST_ENTRY_CHANGE_NOTICE "2.16.840.1.113730.3.4.7"
+#endif
+
+/* Change notification modes of a search. */
+#define LDAP_NOTIFY_AD 1
+#define LDAP_NOTIFY_PSEARCH 2
+
+/* Content synchronization operation (RFC 4533). */
+#ifndef LDAP_CONTROL_SYNC
+#define LDAP_CONTROL_SYNC "1.3.6.1.4.1.4203.1.9.1.1"
+#define LDAP_CONTROL_SYNC_STATE "1.3.6.1.4.1.4203.1.9.1.2"
+#define LDAP_CONTROL_SYNC_DONE "1.3.6.1.4.1.4203.1.9.1.3"
+#define LDAP_SYNC_INFO "1.3.6.1.4.1.4203.1.9.1.4"
+#endif
+#ifndef LDAP_SYNC_REFRESH_AND_PERSIST
+#define LDAP_SYNC_REFRESH_ONLY 0x01
+#define LDAP_SYNC_REFRESH_AND_PERSIST 0x03
+#endif
+#ifndef LDAP_TAG_SYNC_NEW_COOKIE
+#define LDAP_TAG_SYNC_NEW_COOKIE ((ber_tag_t) 0x80U)
+#define LDAP_TAG_SYNC_REFRESH_DELETE ((ber_tag_t) 0xa1U)
+#define LDAP_TAG_SYNC_REFRESH_PRESENT ((ber_tag_t) 0xa2U)
+#define LDAP_TAG_SYNC_ID_SET ((ber_tag_t) 0xa3U)
+#define LDAP_TAG_SYNC_COOKIE ((ber_tag_t) 0x04U)
+#define LDAP_TAG_REFRESHDELETES ((ber_tag_t) 0x01U)
+#define LDAP_TAG_REFRESHDONE ((ber_tag_t) 0x01U)
+#endif
 
 int _ldap_finish_init_thread(char async, XTHREAD thread, int *timeout, void *misc, LDAP **ld);
 int _ldap_bind(LDAP *ld, ldap_conndata_t *info, char ppolicy, LDAPMessage *result, int *msgid);
 int _ldap_create_extended_dn_control(LDAP *ld, int format, LDAPControl **edn_ctrl);
 int _ldap_create_sd_flags_control(LDAP *ld, int flags, LDAPControl **edn_ctrl);
+int _ldap_create_sync_control(LDAP *ld, int mode, struct berval *cookie,
+    int reload_hint, LDAPControl **sync_ctrl);
+int _ldap_create_dirsync_control(LDAP *ld, unsigned int flags, int max_bytes,
+    struct berval *cookie, LDAPControl **dirsync_ctrl);
+int _ldap_create_psearch_control(LDAP *ld, int change_types,
+    int changes_only, LDAPControl **psearch_ctrl);
+int _ldap_parse_dirsync_control(LDAPControl **ctrls, int *more_results,
+    struct berval **cookie);
+int _ldap_create_asq_control(LDAP *ld, char *attr, LDAPControl **asq_ctrl);
+int _ldap_parse_asq_control(LDAPControl **ctrls, int *result);
 void _ldap_control_free(LDAPControl *ctrl);
+int _ldap_data_ready(LDAP *ld);
 
 int create_init_thread(void *param, ldap_conndata_t *info, XTHREAD *thread);
+#ifndef WIN32
+void _ldap_abandon_init_thread(void *misc);
+int create_init_notifier(SOCKET *csock, SOCKET *ssock);
+int read_init_notifier(SOCKET csock);
+void close_init_notifier(SOCKET *csock, SOCKET *ssock);
+#endif
 void *create_conn_info(char *mech, SOCKET sock, PyObject *creds);
 void dealloc_conn_info(ldap_conndata_t* info);
 
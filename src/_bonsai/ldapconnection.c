@@ -2,6 +2,7 @@
 #include "ldapentry.h"
 #include "ldapsearchiter.h"
 #include "ldapconnectiter.h"
+#include "ldapfilter.h"
 
 /*  Dealloc the LDAPConnection object. */
 static void
@@ -14,6 +15,9 @@ ldapconnection_dealloc(LDAPConnection* self) {
     Py_XDECREF(self->client);
     Py_XDECREF(self->pending_ops);
     Py_XDECREF(self->socketpair);
+#ifndef WIN32
+    close_init_notifier(&(self->csock), &(self->ssock));
+#endif
 
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
@@ -42,6 +46,7 @@ ldapconnection_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
         self->async = 0;
         self->ppolicy = 0;
         self->csock = -1;
+        self->ssock = -1;
         self->socketpair = NULL;
     }
 
@@ -153,8 +158,14 @@ connecting(LDAPConnection *self, LDAPConnectIter **conniter) {
     Py_DECREF(tmp);
 
     if (self->async) {
+#ifdef WIN32
         /* Init the socketpair. */
         rc = get_socketpair(&(self->socketpair), &(self->csock), &ssock);
+#else
+        /* Init the notifier for the initialisation pool. */
+        rc = create_init_notifier(&(self->csock), &(self->ssock));
+        ssock = self->ssock;
+#endif
         if (rc != 0) {
             free(mech);
             return -1;
@@ -360,6 +371,61 @@ ldapconnection_delentry(LDAPConnection *self, PyObject *args) {
     return PyLong_FromLong((long int)msgid);
 }
 
+/* Compare an attribute value of an entry on the server. */
+static PyObject *
+ldapconnection_compare(LDAPConnection *self, PyObject *args) {
+    int rc = 0;
+    char *dnstr = NULL;
+    char *attr = NULL;
+    char *value = NULL;
+    long int len = 0;
+    int msgid = -1;
+    PyObject *valobj = NULL;
+    LDAPControl *mdi_ctrl = NULL;
+    LDAPControl *server_ctrls[2] = {NULL, NULL};
+    struct berval bvalue;
+    struct berval ctrl_null_value = {0, NULL};
+
+    DEBUG("ldapconnection_compare (self:%p, args:%p)", self, args);
+    if (LDAPConnection_IsClosed(self) != 0) return NULL;
+
+    if (!PyArg_ParseTuple(args, "ssO", &dnstr, &attr, &valobj)) return NULL;
+
+    if (PyObject2char_withlength(valobj, &value, &len) != 0) return NULL;
+    bvalue.bv_val = value;
+    bvalue.bv_len = len;
+
+    if (self->managedsait == 1) {
+        /* Create ManageDsaIT control. */
+        rc = ldap_control_create(LDAP_CONTROL_MANAGEDSAIT, 0, &ctrl_null_value,
+                                 1, &mdi_ctrl);
+        if (rc != LDAP_SUCCESS) {
+            free(value);
+            PyErr_BadInternalCall();
+            return NULL;
+        }
+        server_ctrls[0] = mdi_ctrl;
+    }
+
+    rc = ldap_compare_ext(self->ld, dnstr, attr, &bvalue, server_ctrls, NULL,
+                          &msgid);
+
+    if (mdi_ctrl != NULL) _ldap_control_free(mdi_ctrl);
+    free(value);
+
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+
+    /* Add new compare operation to the pending_ops. */
+    if (add_to_pending_ops(self->pending_ops, msgid, Py_None) != 0) {
+        return NULL;
+    }
+
+    return PyLong_FromLong((long int)msgid);
+}
+
 /* Perform an LDAP search using an LDAPSearchIter object that contains
    the parameters of the search. */
 int
@@ -376,6 +442,11 @@ LDAPConnection_Searching(LDAPConnection *self, ldapsearchparams *params_in,
     LDAPControl *vlv_ctrl = NULL;
     LDAPControl *edn_ctrl = NULL;
     LDAPControl *mdi_ctrl = NULL;
+    LDAPControl *sync_ctrl = NULL;
+    LDAPControl *dirsync_ctrl = NULL;
+    LDAPControl *notify_ctrl = NULL;
+    LDAPControl *asq_ctrl = NULL;
+    LDAPControl *vr_ctrl = NULL;
     LDAPControl **server_ctrls = NULL;
     LDAPSearchIter *search_iter = (LDAPSearchIter *)iterator;
     struct berval ctrl_null_value = {0, NULL};
@@ -421,6 +492,11 @@ LDAPConnection_Searching(LDAPConnection *self, ldapsearchparams *params_in,
     if (params->sort_list != NULL) num_of_ctrls++;
     if (search_iter != NULL && search_iter->page_size > 0) num_of_ctrls++;
     if (search_iter != NULL && search_iter->vlv_info != NULL) num_of_ctrls++;
+    if (search_iter != NULL && search_iter->sync_mode != 0) num_of_ctrls++;
+    if (search_iter != NULL && search_iter->dirsync != 0) num_of_ctrls++;
+    if (search_iter != NULL && search_iter->notify_mode != 0) num_of_ctrls++;
+    if (params->asq_attr != NULL) num_of_ctrls++;
+    if (params->vr_filter != NULL) num_of_ctrls++;
     if (num_of_ctrls > 0) {
         server_ctrls = (LDAPControl **)malloc(sizeof(LDAPControl *) *
                                               (num_of_ctrls + 1));
@@ -470,6 +546,78 @@ LDAPConnection_Searching(LDAPConnection *self, ldapsearchparams *params_in,
             server_ctrls[num_of_ctrls] = NULL;
         }
 
+        if (search_iter != NULL && search_iter->sync_mode != 0) {
+            /* Create sync request control. */
+            rc = _ldap_create_sync_control(self->ld, search_iter->sync_mode,
+                    search_iter->sync_cookie, search_iter->sync_reload_hint,
+                    &sync_ctrl);
+            if (rc != LDAP_SUCCESS) {
+                PyErr_BadInternalCall();
+                msgid = -1;
+                goto end;
+            }
+            server_ctrls[num_of_ctrls++] = sync_ctrl;
+            server_ctrls[num_of_ctrls] = NULL;
+        }
+
+        if (search_iter != NULL && search_iter->dirsync != 0) {
+            /* Create DirSync control. */
+            rc = _ldap_create_dirsync_control(self->ld, search_iter->dirsync_flags,
+                    search_iter->dirsync_max_bytes, search_iter->dirsync_cookie,
+                    &dirsync_ctrl);
+            if (rc != LDAP_SUCCESS) {
+                PyErr_BadInternalCall();
+                msgid = -1;
+                goto end;
+            }
+            server_ctrls[num_of_ctrls++] = dirsync_ctrl;
+            server_ctrls[num_of_ctrls] = NULL;
+        }
+
+        if (search_iter != NULL && search_iter->notify_mode != 0) {
+            /* Create change notification or persistent search control. */
+            if (search_iter->notify_mode == LDAP_NOTIFY_AD) {
+                rc = ldap_control_create(LDAP_SERVER_NOTIFICATION_OID, 1, NULL,
+                        1, &notify_ctrl);
+            } else {
+                rc = _ldap_create_psearch_control(self->ld,
+                        search_iter->psearch_types,
+                        search_iter->psearch_changes_only, &notify_ctrl);
+            }
+            if (rc != LDAP_SUCCESS) {
+                PyErr_BadInternalCall();
+                msgid = -1;
+                goto end;
+            }
+            server_ctrls[num_of_ctrls++] = notify_ctrl;
+            server_ctrls[num_of_ctrls] = NULL;
+        }
+
+        if (params->asq_attr != NULL) {
+            /* Create attribute scoped query control. */
+            rc = _ldap_create_asq_control(self->ld, params->asq_attr, &asq_ctrl);
+            if (rc != LDAP_SUCCESS) {
+                PyErr_BadInternalCall();
+                msgid = -1;
+                goto end;
+            }
+            server_ctrls[num_of_ctrls++] = asq_ctrl;
+            server_ctrls[num_of_ctrls] = NULL;
+        }
+
+        if (params->vr_filter != NULL) {
+            /* Create matched values control. */
+            rc = ldap_control_create(LDAP_CONTROL_VALUESRETURNFILTER, 1,
+                                     params->vr_filter, 1, &vr_ctrl);
+            if (rc != LDAP_SUCCESS) {
+                PyErr_BadInternalCall();
+                msgid = -1;
+                goto end;
+            }
+            server_ctrls[num_of_ctrls++] = vr_ctrl;
+            server_ctrls[num_of_ctrls] = NULL;
+        }
+
         if (extdn_format != -1) {
             /* Create extended dn control. */
             rc = _ldap_create_extended_dn_control(self->ld, extdn_format, &edn_ctrl);
@@ -544,6 +692,7 @@ LDAPConnection_Searching(LDAPConnection *self, ldapsearchparams *params_in,
         msgid = -1;
         goto end;
     }
+    if (search_iter != NULL) search_iter->msgid = msgid;
 end:
     /* Cleanup. */
     if (page_ctrl != NULL) ldap_control_free(page_ctrl);
@@ -551,11 +700,34 @@ end:
     if (vlv_ctrl != NULL) ldap_control_free(vlv_ctrl);
     if (edn_ctrl != NULL) _ldap_control_free(edn_ctrl);
     if (mdi_ctrl != NULL) _ldap_control_free(mdi_ctrl);
+    if (sync_ctrl != NULL) _ldap_control_free(sync_ctrl);
+    if (dirsync_ctrl != NULL) _ldap_control_free(dirsync_ctrl);
+    if (notify_ctrl != NULL) _ldap_control_free(notify_ctrl);
+    if (asq_ctrl != NULL) _ldap_control_free(asq_ctrl);
+    if (vr_ctrl != NULL) _ldap_control_free(vr_ctrl);
     free(server_ctrls);
 
     return msgid;
 }
 
+/* Copy the content of a bytes object into a newly allocated berval. */
+static struct berval *
+bytes_to_berval(PyObject *bytes) {
+    struct berval *bval = NULL;
+
+    bval = (struct berval *)malloc(sizeof(struct berval));
+    if (bval == NULL) return (struct berval *)PyErr_NoMemory();
+
+    bval->bv_len = (ber_len_t)PyBytes_Size(bytes);
+    bval->bv_val = (char *)malloc(bval->bv_len + 1);
+    if (bval->bv_val == NULL) {
+        free(bval);
+        return (struct berval *)PyErr_NoMemory();
+    }
+    memcpy(bval->bv_val, PyBytes_AsString(bytes), bval->bv_len);
+    return bval;
+}
+
 /* Search for LDAP entries. */
 static PyObject *
 ldapconnection_search(LDAPConnection *self, PyObject *args, PyObject *kwds) {
@@ -569,43 +741,145 @@ ldapconnection_search(LDAPConnection *self, PyObject *args, PyObject *kwds) {
     double timeout = 0;
     char *basestr = NULL;
     char *filterstr = NULL;
+    char *asq_attr = NULL;
+    char *values_filter = NULL;
     char **attrs = NULL;
     struct berval *attrvalue = NULL;
+    struct berval *vr_filter = NULL;
     PyObject *attrlist = NULL;
     PyObject *attrsonlyo = NULL;
     PyObject *sort_order = NULL;
     PyObject *attrvalue_obj = NULL;
+    PyObject *context_obj = NULL;
+    PyObject *sync_cookie_obj = NULL;
+    PyObject *reload_hint_obj = NULL;
+    PyObject *dirsync_flags_obj = NULL;
+    PyObject *dirsync_cookie_obj = NULL;
+    PyObject *changes_only_obj = NULL;
+    int sync_mode = 0, reload_hint = 0;
+    int dirsync_max_bytes = 0;
+    int notify_mode = 0, psearch_types = 0;
+    struct berval *context = NULL;
     ldapsearchparams params;
     LDAPSortKey **sort_list = NULL;
     LDAPSearchIter *search_iter = NULL;
     static char *kwlist[] = {"base", "scope", "filter", "attrlist", "timeout",
             "sizelimit", "attrsonly", "sort_order", "page_size", "offset",
-            "before_count", "after_count", "est_list_count", "attrvalue", NULL};
+            "before_count", "after_count", "est_list_count", "attrvalue",
+            "context_id", "sync_mode", "sync_cookie", "reload_hint",
+            "dirsync_flags", "dirsync_max_bytes", "dirsync_cookie",
+            "notify_mode", "psearch_types", "psearch_changes_only", "asq_attr",
+            "values_filter", NULL};
 
     DEBUG("ldapconnection_search (self:%p, args:%p, kwds:%p)",
             self, args, kwds);
     if (LDAPConnection_IsClosed(self) != 0) return NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ziz#O!diO!O!iiiiiO", kwlist,
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ziz#O!diO!O!iiiiiOOiOO!OiOiiO!zz", kwlist,
             &basestr, &scope, &filterstr, &len, &PyList_Type, &attrlist, &timeout,
             &sizelimit, &PyBool_Type, &attrsonlyo, &PyList_Type, &sort_order,
             &page_size, &offset, &before_count, &after_count, &list_count,
-            &attrvalue_obj)) {
+            &attrvalue_obj, &context_obj, &sync_mode, &sync_cookie_obj,
+            &PyBool_Type, &reload_hint_obj, &dirsync_flags_obj,
+            &dirsync_max_bytes, &dirsync_cookie_obj, &notify_mode,
+            &psearch_types, &PyBool_Type, &changes_only_obj, &asq_attr,
+            &values_filter)) {
         PyErr_SetString(PyExc_TypeError,
                 "Wrong parameters (base<str|LDAPDN>, scope<int>, filter<str>,"
                 " attrlist<List>, timeout<float>, attrsonly<bool>,"
                 " sort_order<List>, page_size<int>, offset<int>,"
                 " before_count<int>, after_count<int>, est_list_count<int>,"
-                " attrvalue<object>).");
+                " attrvalue<object>, context_id<bytes>, sync_mode<int>,"
+                " sync_cookie<bytes>, reload_hint<bool>, dirsync_flags<int>,"
+                " dirsync_max_bytes<int>, dirsync_cookie<bytes>,"
+                " notify_mode<int>, psearch_types<int>,"
+                " psearch_changes_only<bool>, asq_attr<str>,"
+                " values_filter<str>).");
+        return NULL;
+    }
+
+    if (context_obj == Py_None) context_obj = NULL;
+    if (context_obj != NULL && !PyBytes_Check(context_obj)) {
+        PyErr_SetString(PyExc_TypeError, "The context_id must be bytes.");
         return NULL;
     }
 
+    if (sync_cookie_obj == Py_None) sync_cookie_obj = NULL;
+    if (sync_cookie_obj != NULL && !PyBytes_Check(sync_cookie_obj)) {
+        PyErr_SetString(PyExc_TypeError, "The sync_cookie must be bytes.");
+        return NULL;
+    }
+
+    if (sync_mode != 0 && sync_mode != LDAP_SYNC_REFRESH_ONLY
+            && sync_mode != LDAP_SYNC_REFRESH_AND_PERSIST) {
+        PyErr_SetString(PyExc_ValueError, "Invalid sync_mode.");
+        return NULL;
+    }
+    if (reload_hint_obj != NULL) reload_hint = PyObject_IsTrue(reload_hint_obj);
+
+    if (dirsync_flags_obj == Py_None) dirsync_flags_obj = NULL;
+    if (dirsync_flags_obj != NULL && !PyLong_Check(dirsync_flags_obj)) {
+        PyErr_SetString(PyExc_TypeError, "The dirsync_flags must be int.");
+        return NULL;
+    }
+    if (dirsync_cookie_obj == Py_None) dirsync_cookie_obj = NULL;
+    if (dirsync_cookie_obj != NULL && !PyBytes_Check(dirsync_cookie_obj)) {
+        PyErr_SetString(PyExc_TypeError, "The dirsync_cookie must be bytes.");
+        return NULL;
+    }
+    if (dirsync_flags_obj != NULL && sync_mode != 0) {
+        PyErr_SetString(PyExc_ValueError,
+            "DirSync and content synchronization cannot be used together.");
+        return NULL;
+    }
+    if (dirsync_flags_obj != NULL && page_size > 0) {
+        PyErr_SetString(PyExc_ValueError,
+            "DirSync and paged search cannot be used together.");
+        return NULL;
+    }
+
+    if (notify_mode != 0 && notify_mode != LDAP_NOTIFY_AD
+            && notify_mode != LDAP_NOTIFY_PSEARCH) {
+        PyErr_SetString(PyExc_ValueError, "Invalid notify_mode.");
+        return NULL;
+    }
+    if (notify_mode != 0 && (sync_mode != 0 || dirsync_flags_obj != NULL)) {
+        PyErr_SetString(PyExc_ValueError, "Change notification cannot be used"
+            " with content synchronization or DirSync.");
+        return NULL;
+    }
+#ifdef WIN32
+    if (notify_mode != 0) {
+        PyErr_SetString(PyExc_NotImplementedError,
+            "Change notification is not supported with WinLDAP.");
+        return NULL;
+    }
+    if (sync_mode != 0) {
+        PyErr_SetString(PyExc_NotImplementedError,
+            "Content synchronization is not supported with WinLDAP.");
+        return NULL;
+    }
+#endif
+
     /* Check that scope's value is not remained the default. */
     if (scope == -1) {
         PyErr_SetString(PyExc_ValueError, "Search scope must be set.");
         return NULL;
     }
 
+    if (asq_attr != NULL && scope != LDAP_SCOPE_BASE) {
+        PyErr_SetString(PyExc_ValueError,
+            "Attribute scoped query requires base scope.");
+        return NULL;
+    }
+
+    /* Malformed filters are rejected before sending the request. */
+    if (validate_filter(filterstr) != 0) return NULL;
+    if (values_filter != NULL
+            && encode_values_return_filter(values_filter, &vr_filter) != 0) {
+        return NULL;
+    }
+
     /* If attrvalue_obj is None, then it is not set.*/
     if (attrvalue_obj == Py_None) attrvalue_obj = NULL;
 
@@ -613,6 +887,7 @@ ldapconnection_search(LDAPConnection *self, PyObject *args, PyObject *kwds) {
         /* Convert the attribute, reverse order pairs to LDAPSortKey struct. */
         sort_list = PyList2LDAPSortKeyList(sort_order);
         if (sort_list == NULL) {
+            if (vr_filter != NULL) ber_bvfree(vr_filter);
             PyErr_BadInternalCall();
             return NULL;
         }
@@ -623,11 +898,13 @@ ldapconnection_search(LDAPConnection *self, PyObject *args, PyObject *kwds) {
     if (attrlist != NULL) attrs = PyList2StringList(attrlist);
 
     if (set_search_params(&params, attrs, attrsonly, basestr,
-            filterstr, len, scope, sizelimit, timeout, sort_list) != 0) {
+            filterstr, len, scope, sizelimit, timeout, sort_list, asq_attr,
+            vr_filter) != 0) {
         return NULL;
     }
 
-    if (page_size > 0 || offset != 0 || attrvalue_obj != NULL) {
+    if (page_size > 0 || offset != 0 || attrvalue_obj != NULL || sync_mode != 0
+            || dirsync_flags_obj != NULL || notify_mode != 0) {
         /* Create a SearchIter for storing the search params and result. */
         search_iter = LDAPSearchIter_New(self);
         if (search_iter == NULL) return PyErr_NoMemory();
@@ -674,6 +951,52 @@ ldapconnection_search(LDAPConnection *self, PyObject *args, PyObject *kwds) {
                 attrvalue->bv_len = len;
             }
             search_iter->vlv_info->ldvlv_attrvalue = attrvalue;
+
+            if (context_obj != NULL) {
+                /* Context ID of the previous VLV response. */
+                context = bytes_to_berval(context_obj);
+                if (context == NULL) {
+                    Py_DECREF(search_iter);
+                    return NULL;
+                }
+                search_iter->vlv_info->ldvlv_context = context;
+            }
+        }
+
+        if (sync_mode != 0) {
+            search_iter->sync_mode = sync_mode;
+            search_iter->sync_reload_hint = (char)reload_hint;
+            if (sync_cookie_obj != NULL) {
+                search_iter->sync_cookie = bytes_to_berval(sync_cookie_obj);
+                if (search_iter->sync_cookie == NULL) {
+                    Py_DECREF(search_iter);
+                    return NULL;
+                }
+            }
+        }
+
+        if (dirsync_flags_obj != NULL) {
+            search_iter->dirsync = 1;
+            /* Keep the lower 32 bits, the flags are an unsigned mask. */
+            search_iter->dirsync_flags =
+                (unsigned int)PyLong_AsUnsignedLongMask(dirsync_flags_obj);
+            search_iter->dirsync_max_bytes = dirsync_max_bytes;
+            if (dirsync_cookie_obj != NULL) {
+                search_iter->dirsync_cookie = bytes_to_berval(dirsync_cookie_obj);
+                if (search_iter->dirsync_cookie == NULL) {
+                    Py_DECREF(search_iter);
+                    return NULL;
+                }
+            }
+        }
+
+        if (notify_mode != 0) {
+            search_iter->notify_mode = notify_mode;
+            search_iter->psearch_types = psearch_types;
+            if (changes_only_obj != NULL) {
+                search_iter->psearch_changes_only =
+                    (char)PyObject_IsTrue(changes_only_obj);
+            }
         }
     }
 
@@ -846,6 +1169,52 @@ end:
     return tmp;
 }
 
+/* Return a new reference of the table for interning the values of the DN
+   attributes. The table is kept by the search iterator to be shared between
+   the pages. Return NULL without an error set, if the client has no DN
+   attributes. */
+static PyObject *
+get_dn_table(LDAPConnection *self, LDAPSearchIter *search_iter) {
+    int rc = 0;
+    PyObject *dnattr_list = NULL;
+
+    dnattr_list = PyObject_GetAttrString(self->client, "dn_attributes");
+    if (dnattr_list == NULL) return NULL;
+    rc = PyObject_IsTrue(dnattr_list);
+    Py_DECREF(dnattr_list);
+    if (rc != 1) return NULL;
+
+    if (search_iter == NULL) return PyDict_New();
+
+    if (search_iter->dn_table == NULL) {
+        search_iter->dn_table = PyDict_New();
+        if (search_iter->dn_table == NULL) return NULL;
+    }
+    Py_INCREF(search_iter->dn_table);
+    return search_iter->dn_table;
+}
+
+/*  Check that the ranged attributes of the search result have to be
+    merged by their names. The remaining ranges are retrieved by the
+    Python layer only for the simple and the virtual list view searches.
+    Returns -1 on error. */
+static int
+use_auto_range(LDAPConnection *self, LDAPSearchIter *search_iter) {
+    int rc = 0;
+    PyObject *value = NULL;
+
+    if (search_iter != NULL && (search_iter->page_size > 0
+            || search_iter->dirsync || search_iter->sync_mode != 0
+            || search_iter->notify_mode != 0)) {
+        return 0;
+    }
+    value = PyObject_GetAttrString(self->client, "auto_range_acquire");
+    if (value == NULL) return -1;
+    rc = PyObject_IsTrue(value);
+    Py_DECREF(value);
+    return rc;
+}
+
 /* Process the server result after a search request. */
 static PyObject *
 parse_search_result(LDAPConnection *self, LDAPMessage *res, PyObject *obj) {
@@ -853,8 +1222,11 @@ parse_search_result(LDAPConnection *self, LDAPMessage *res, PyObject *obj) {
     int err = 0;
     int ref_opt = 0;
     int target_pos = 0, list_count = 0;
+    int more_results = 0;
+    int auto_range = 0;
     char *attr = NULL;
     char **referrals = NULL;
+    struct berval *context = NULL;
     LDAPMessage *entry;
     FINDCTRL ctrl = NULL;
     LDAPControl **returned_ctrls = NULL;
@@ -865,28 +1237,43 @@ parse_search_result(LDAPConnection *self, LDAPMessage *res, PyObject *obj) {
     PyObject *ctrl_obj = NULL;
     PyObject *refobj = NULL;
     PyObject *retval = NULL;
+    PyObject *dn_table = NULL;
 
     DEBUG("parse_search_result (self:%p, res:%p, obj:%p)", self, res, obj);
 
     if (obj != Py_None) search_iter = (LDAPSearchIter *)obj;
+
+    auto_range = use_auto_range(self, search_iter);
+    if (auto_range < 0) return NULL;
+
+    dn_table = get_dn_table(self, search_iter);
+    if (dn_table == NULL && PyErr_Occurred()) return NULL;
+
     buffer = PyList_New(0);
-    if (buffer == NULL) return PyErr_NoMemory();
+    if (buffer == NULL) {
+        Py_XDECREF(dn_table);
+        return PyErr_NoMemory();
+    }
 
     /* Iterate over the received LDAP messages. */
     for (entry = ldap_first_entry(self->ld, res); entry != NULL;
         entry = ldap_next_entry(self->ld, entry)) {
-        entryobj = LDAPEntry_FromLDAPMessage(entry, self);
+        entryobj = LDAPEntry_FromLDAPMessage(entry, self, dn_table,
+            auto_range);
         if (entryobj == NULL) {
+            Py_XDECREF(dn_table);
             Py_DECREF(buffer);
             return NULL;
         }
         if (PyList_Append(buffer, (PyObject *)entryobj) != 0) {
             Py_DECREF(entryobj);
+            Py_XDECREF(dn_table);
             Py_DECREF(buffer);
             return PyErr_NoMemory();
         }
         Py_DECREF(entryobj);
     }
+    Py_XDECREF(dn_table);
 
     ldap_get_option(self->ld, LDAP_OPT_REFERRALS, &ref_opt);
 
@@ -956,6 +1343,17 @@ parse_search_result(LDAPConnection *self, LDAPMessage *res, PyObject *obj) {
         ctrl = NULL;
     }
 
+    /* Check the result of an attribute scoped query. */
+    rc = _ldap_parse_asq_control(returned_ctrls, &err);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        goto error;
+    }
+    if (err != LDAP_SUCCESS) {
+        set_exception(self->ld, err);
+        goto error;
+    }
+
     if (search_iter != NULL) {
         if (search_iter->page_size > 0) {
             ctrl = ldap_control_find(LDAP_CONTROL_PAGEDRESULTS, returned_ctrls, NULL);
@@ -983,18 +1381,61 @@ parse_search_result(LDAPConnection *self, LDAPMessage *res, PyObject *obj) {
         if (search_iter->vlv_info != NULL) {
             rc = ldap_parse_vlvresponse_control(self->ld,
                     ldap_control_find(LDAP_CONTROL_VLVRESPONSE, returned_ctrls, NULL),
-                    &target_pos, &list_count, NULL, &err);
+                    &target_pos, &list_count, &context, &err);
 
             if (rc != LDAP_SUCCESS || err != LDAP_SUCCESS) {
+                if (context != NULL) ber_bvfree(context);
                 set_exception(self->ld, err);
                 goto error;
             }
 
             /* Create ctrl dict. */
-            ctrl_obj = Py_BuildValue("{s,s,s,i,s,i}",
-                    "oid", LDAP_CONTROL_VLVRESPONSE,
-                    "target_position", target_pos,
-                    "list_count", list_count);
+            if (context != NULL && context->bv_val != NULL) {
+                ctrl_obj = Py_BuildValue("{s,s,s,i,s,i,s,y#}",
+                        "oid", LDAP_CONTROL_VLVRESPONSE,
+                        "target_position", target_pos,
+                        "list_count", list_count,
+                        "context_id", context->bv_val,
+                        (Py_ssize_t)context->bv_len);
+            } else {
+                ctrl_obj = Py_BuildValue("{s,s,s,i,s,i,s,O}",
+                        "oid", LDAP_CONTROL_VLVRESPONSE,
+                        "target_position", target_pos,
+                        "list_count", list_count,
+                        "context_id", Py_None);
+            }
+            if (context != NULL) ber_bvfree(context);
+            if (ctrl_obj == NULL) goto error;
+
+            /* Create (result, ctrl) tuple as return value. */
+            retval = Py_BuildValue("(O,O)", buffer, ctrl_obj);
+            Py_DECREF(ctrl_obj);
+            if (retval == NULL) {
+                goto error;
+            }
+            Py_DECREF(buffer);
+        } else if (search_iter->dirsync != 0) {
+            rc = _ldap_parse_dirsync_control(returned_ctrls, &more_results,
+                    &context);
+            if (rc != LDAP_SUCCESS) {
+                set_exception(self->ld, rc);
+                goto error;
+            }
+
+            /* Create ctrl dict. */
+            if (context != NULL && context->bv_val != NULL) {
+                ctrl_obj = Py_BuildValue("{s,s,s,O,s,y#}",
+                        "oid", LDAP_SERVER_DIRSYNC_OID,
+                        "more_results", more_results ? Py_True : Py_False,
+                        "cookie", context->bv_val,
+                        (Py_ssize_t)context->bv_len);
+            } else {
+                ctrl_obj = Py_BuildValue("{s,s,s,O,s,O}",
+                        "oid", LDAP_SERVER_DIRSYNC_OID,
+                        "more_results", more_results ? Py_True : Py_False,
+                        "cookie", Py_None);
+            }
+            if (context != NULL) ber_bvfree(context);
             if (ctrl_obj == NULL) goto error;
 
             /* Create (result, ctrl) tuple as return value. */
@@ -1027,6 +1468,412 @@ error:
     return NULL;
 }
 
+#ifndef WIN32
+/* Decode the optional cookie and the optional boolean of a Sync Info or a
+   Sync Done value into the `event` dict. The boolean is set with the `key`
+   and with the `dflt` value, if it's missing. */
+static int
+scan_sync_cookie_flag(BerElement *ber, PyObject *event, const char *key,
+        int dflt) {
+    int rc = 0;
+    ber_tag_t tag;
+    ber_len_t len;
+    ber_int_t flag = dflt;
+    struct berval cookie = {0, NULL};
+    PyObject *value = NULL;
+
+    tag = ber_peek_tag(ber, &len);
+    if (tag == LDAP_TAG_SYNC_COOKIE) {
+        if (ber_scanf(ber, "m", &cookie) == LBER_ERROR) return -1;
+        tag = ber_peek_tag(ber, &len);
+    }
+    if (tag == LDAP_TAG_REFRESHDONE) {
+        /* The refreshDone and the refreshDeletes have the same tag. */
+        if (ber_scanf(ber, "b", &flag) == LBER_ERROR) return -1;
+    }
+
+    if (cookie.bv_val != NULL) {
+        value = PyBytes_FromStringAndSize(cookie.bv_val, cookie.bv_len);
+        if (value == NULL) return -1;
+    } else {
+        value = Py_None;
+        Py_INCREF(value);
+    }
+    rc = PyDict_SetItemString(event, "cookie", value);
+    Py_DECREF(value);
+    if (rc != 0) return -1;
+
+    return PyDict_SetItemString(event, key, flag ? Py_True : Py_False);
+}
+
+/* Create the event of a search entry with its Sync State control. */
+static PyObject *
+create_sync_entry_event(LDAPConnection *self, LDAPMessage *msg,
+        PyObject *dn_table) {
+    int rc = 0;
+    ber_int_t state = 0;
+    ber_tag_t tag;
+    ber_len_t len;
+    struct berval uuid = {0, NULL};
+    struct berval cookie = {0, NULL};
+    BerElement *ber = NULL;
+    LDAPControl **ctrls = NULL;
+    LDAPControl *ctrl = NULL;
+    LDAPEntry *entryobj = NULL;
+    PyObject *event = NULL;
+
+    rc = ldap_get_entry_controls(self->ld, msg, &ctrls);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+    ctrl = ldap_control_find(LDAP_CONTROL_SYNC_STATE, ctrls, NULL);
+    if (ctrl == NULL) goto decoding_error;
+
+    ber = ber_init(&(ctrl->ldctl_value));
+    if (ber == NULL) {
+        ldap_controls_free(ctrls);
+        return PyErr_NoMemory();
+    }
+    if (ber_scanf(ber, "{em", &state, &uuid) == LBER_ERROR) goto decoding_error;
+    tag = ber_peek_tag(ber, &len);
+    if (tag == LDAP_TAG_SYNC_COOKIE) {
+        if (ber_scanf(ber, "m", &cookie) == LBER_ERROR) goto decoding_error;
+    }
+
+    entryobj = LDAPEntry_FromLDAPMessage(msg, self, dn_table, 0);
+    if (entryobj == NULL) goto end;
+
+    if (cookie.bv_val != NULL) {
+        event = Py_BuildValue("{s:s,s:O,s:i,s:y#,s:y#}", "type", "entry",
+            "entry", entryobj, "state", (int)state, "uuid", uuid.bv_val,
+            (Py_ssize_t)uuid.bv_len, "cookie", cookie.bv_val,
+            (Py_ssize_t)cookie.bv_len);
+    } else {
+        event = Py_BuildValue("{s:s,s:O,s:i,s:y#,s:O}", "type", "entry",
+            "entry", entryobj, "state", (int)state, "uuid", uuid.bv_val,
+            (Py_ssize_t)uuid.bv_len, "cookie", Py_None);
+    }
+    Py_DECREF(entryobj);
+    goto end;
+decoding_error:
+    set_exception(NULL, LDAP_DECODING_ERROR);
+end:
+    if (ber != NULL) ber_free(ber, 1);
+    if (ctrls != NULL) ldap_controls_free(ctrls);
+    return event;
+}
+
+/* Create the event of a Sync Info intermediate response. Returns None for
+   other intermediate responses. */
+static PyObject *
+create_sync_info_event(LDAPConnection *self, LDAPMessage *msg) {
+    int rc = 0;
+    ber_tag_t tag;
+    ber_len_t len;
+    char *last = NULL;
+    char *retoid = NULL;
+    struct berval *data = NULL;
+    struct berval value = {0, NULL};
+    BerElement *ber = NULL;
+    PyObject *event = NULL;
+    PyObject *uuids = NULL;
+    PyObject *item = NULL;
+
+    rc = ldap_parse_intermediate(self->ld, msg, &retoid, &data, NULL, 0);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+    if (retoid == NULL || strcmp(retoid, LDAP_SYNC_INFO) != 0 || data == NULL) {
+        event = Py_None;
+        Py_INCREF(event);
+        goto end;
+    }
+
+    ber = ber_init(data);
+    if (ber == NULL) {
+        PyErr_NoMemory();
+        goto end;
+    }
+    event = PyDict_New();
+    if (event == NULL) goto end;
+
+    tag = ber_peek_tag(ber, &len);
+    switch (tag) {
+    case LDAP_TAG_SYNC_NEW_COOKIE:
+        if (ber_scanf(ber, "m", &value) == LBER_ERROR) goto decoding_error;
+        Py_DECREF(event);
+        event = Py_BuildValue("{s:s,s:y#}", "type", "new_cookie",
+            "cookie", value.bv_val, (Py_ssize_t)value.bv_len);
+        break;
+    case LDAP_TAG_SYNC_REFRESH_DELETE:
+    case LDAP_TAG_SYNC_REFRESH_PRESENT:
+        if (ber_scanf(ber, "{") == LBER_ERROR) goto decoding_error;
+        if (scan_sync_cookie_flag(ber, event, "refresh_done", 1) != 0) {
+            goto decoding_error;
+        }
+        item = PyUnicode_FromString(tag == LDAP_TAG_SYNC_REFRESH_DELETE ?
+            "refresh_delete" : "refresh_present");
+        if (item == NULL) goto error;
+        rc = PyDict_SetItemString(event, "type", item);
+        Py_DECREF(item);
+        if (rc != 0) goto error;
+        break;
+    case LDAP_TAG_SYNC_ID_SET:
+        if (ber_scanf(ber, "{") == LBER_ERROR) goto decoding_error;
+        if (scan_sync_cookie_flag(ber, event, "refresh_deletes", 0) != 0) {
+            goto decoding_error;
+        }
+        uuids = PyList_New(0);
+        if (uuids == NULL) goto error;
+        /* Iterate over the set of syncUUIDs. */
+        for (tag = ber_first_element(ber, &len, &last); tag != LBER_DEFAULT;
+                tag = ber_next_element(ber, &len, last)) {
+            if (ber_scanf(ber, "m", &value) == LBER_ERROR) goto decoding_error;
+            item = PyBytes_FromStringAndSize(value.bv_val, value.bv_len);
+            if (item == NULL) goto error;
+            rc = PyList_Append(uuids, item);
+            Py_DECREF(item);
+            if (rc != 0) goto error;
+        }
+        rc = PyDict_SetItemString(event, "uuids", uuids);
+        Py_CLEAR(uuids);
+        if (rc != 0) goto error;
+        item = PyUnicode_FromString("id_set");
+        if (item == NULL) goto error;
+        rc = PyDict_SetItemString(event, "type", item);
+        Py_DECREF(item);
+        if (rc != 0) goto error;
+        break;
+    default:
+        goto decoding_error;
+    }
+    goto end;
+decoding_error:
+    set_exception(NULL, LDAP_DECODING_ERROR);
+error:
+    Py_XDECREF(uuids);
+    Py_CLEAR(event);
+end:
+    if (ber != NULL) ber_free(ber, 1);
+    if (data != NULL) ber_bvfree(data);
+    if (retoid != NULL) ldap_memfree(retoid);
+    return event;
+}
+
+/* Create the event of the search result with its Sync Done control. */
+static PyObject *
+create_sync_done_event(LDAPConnection *self, LDAPMessage *msg) {
+    int rc = 0;
+    int err = 0;
+    BerElement *ber = NULL;
+    LDAPControl **ctrls = NULL;
+    LDAPControl *ctrl = NULL;
+    PyObject *event = NULL;
+
+    rc = ldap_parse_result(self->ld, msg, &err, NULL, NULL, NULL, &ctrls, 0);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+    if (err != LDAP_SUCCESS) {
+        /* E.g. e-syncRefreshRequired, when the cookie is too old. */
+        set_exception(self->ld, err);
+        goto end;
+    }
+
+    event = Py_BuildValue("{s:s,s:O,s:O}", "type", "done", "cookie", Py_None,
+        "refresh_deletes", Py_False);
+    if (event == NULL) goto end;
+
+    ctrl = ldap_control_find(LDAP_CONTROL_SYNC_DONE, ctrls, NULL);
+    if (ctrl != NULL) {
+        ber = ber_init(&(ctrl->ldctl_value));
+        if (ber == NULL) {
+            Py_CLEAR(event);
+            PyErr_NoMemory();
+            goto end;
+        }
+        if (ber_scanf(ber, "{") == LBER_ERROR
+                || scan_sync_cookie_flag(ber, event, "refresh_deletes", 0) != 0) {
+            Py_CLEAR(event);
+            set_exception(NULL, LDAP_DECODING_ERROR);
+        }
+    }
+end:
+    if (ber != NULL) ber_free(ber, 1);
+    if (ctrls != NULL) ldap_controls_free(ctrls);
+    return event;
+}
+
+/* Create the event of a search entry of a change notification with the
+   data of its Entry Change Notification control, if there's any. */
+static PyObject *
+create_notify_entry_event(LDAPConnection *self, LDAPMessage *msg,
+        PyObject *dn_table) {
+    int rc = 0;
+    ber_int_t change_type = 0;
+    ber_int_t change_number = 0;
+    ber_tag_t tag;
+    ber_len_t len;
+    struct berval prev_dn = {0, NULL};
+    BerElement *ber = NULL;
+    LDAPControl **ctrls = NULL;
+    LDAPControl *ctrl = NULL;
+    LDAPEntry *entryobj = NULL;
+    PyObject *event = NULL;
+    PyObject *value = NULL;
+
+    rc = ldap_get_entry_controls(self->ld, msg, &ctrls);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+
+    entryobj = LDAPEntry_FromLDAPMessage(msg, self, dn_table, 0);
+    if (entryobj == NULL) goto end;
+
+    event = Py_BuildValue("{s:s,s:O,s:O,s:O,s:O}", "type", "entry",
+        "entry", entryobj, "change_type", Py_None, "previous_dn", Py_None,
+        "change_number", Py_None);
+    Py_DECREF(entryobj);
+    if (event == NULL) goto end;
+
+    ctrl = ldap_control_find(LDAP_CONTROL_PERSIST_ENTRY_CHANGE_NOTICE, ctrls,
+        NULL);
+    /* The AD change notification sends the entries without any control. */
+    if (ctrl == NULL) goto end;
+
+    ber = ber_init(&(ctrl->ldctl_value));
+    if (ber == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    if (ber_scanf(ber, "{e", &change_type) == LBER_ERROR) goto decoding_error;
+    tag = ber_peek_tag(ber, &len);
+    if (tag == LBER_OCTETSTRING) {
+        if (ber_scanf(ber, "m", &prev_dn) == LBER_ERROR) goto decoding_error;
+        tag = ber_peek_tag(ber, &len);
+    }
+    if (tag == LBER_INTEGER) {
+        if (ber_scanf(ber, "i", &change_number) == LBER_ERROR) {
+            goto decoding_error;
+        }
+        value = PyLong_FromLong((long)change_number);
+        if (value == NULL) goto error;
+        rc = PyDict_SetItemString(event, "change_number", value);
+        Py_DECREF(value);
+        if (rc != 0) goto error;
+    }
+
+    value = PyLong_FromLong((long)change_type);
+    if (value == NULL) goto error;
+    rc = PyDict_SetItemString(event, "change_type", value);
+    Py_DECREF(value);
+    if (rc != 0) goto error;
+
+    if (prev_dn.bv_val != NULL) {
+        value = PyUnicode_FromStringAndSize(prev_dn.bv_val, prev_dn.bv_len);
+        if (value == NULL) goto error;
+        rc = PyDict_SetItemString(event, "previous_dn", value);
+        Py_DECREF(value);
+        if (rc != 0) goto error;
+    }
+    goto end;
+decoding_error:
+    set_exception(NULL, LDAP_DECODING_ERROR);
+error:
+    Py_CLEAR(event);
+end:
+    if (ber != NULL) ber_free(ber, 1);
+    if (ctrls != NULL) ldap_controls_free(ctrls);
+    return event;
+}
+
+/* Create the event of the search result of a change notification. */
+static PyObject *
+create_notify_done_event(LDAPConnection *self, LDAPMessage *msg) {
+    int rc = 0;
+    int err = 0;
+
+    rc = ldap_parse_result(self->ld, msg, &err, NULL, NULL, NULL, NULL, 0);
+    if (rc != LDAP_SUCCESS) {
+        set_exception(self->ld, rc);
+        return NULL;
+    }
+    if (err != LDAP_SUCCESS) {
+        set_exception(self->ld, err);
+        return NULL;
+    }
+    return Py_BuildValue("{s:s}", "type", "done");
+}
+
+/* Process the received messages of a search that streams its result: a
+   content synchronization or a change notification. Returns the list of
+   event dicts, and sets `done` if the search is finished. */
+static PyObject *
+parse_stream_result(LDAPConnection *self, LDAPMessage *res,
+        LDAPSearchIter *search_iter, int *done) {
+    LDAPMessage *msg = NULL;
+    PyObject *events = NULL;
+    PyObject *event = NULL;
+    PyObject *dn_table = NULL;
+    char notify = (search_iter->notify_mode != 0);
+
+    DEBUG("parse_stream_result (self:%p, res:%p, search_iter:%p)",
+        self, res, search_iter);
+
+    dn_table = get_dn_table(self, search_iter);
+    if (dn_table == NULL && PyErr_Occurred()) goto end;
+
+    events = PyList_New(0);
+    if (events == NULL) goto end;
+
+    for (msg = ldap_first_message(self->ld, res); msg != NULL;
+            msg = ldap_next_message(self->ld, msg)) {
+        switch (ldap_msgtype(msg)) {
+        case LDAP_RES_SEARCH_ENTRY:
+            if (notify) {
+                event = create_notify_entry_event(self, msg, dn_table);
+            } else {
+                event = create_sync_entry_event(self, msg, dn_table);
+            }
+            break;
+        case LDAP_RES_INTERMEDIATE:
+            if (notify) continue;
+            event = create_sync_info_event(self, msg);
+            break;
+        case LDAP_RES_SEARCH_RESULT:
+            *done = 1;
+            if (notify) {
+                event = create_notify_done_event(self, msg);
+            } else {
+                event = create_sync_done_event(self, msg);
+            }
+            break;
+        default:
+            /* Search references are ignored. */
+            continue;
+        }
+        if (event == NULL) {
+            Py_CLEAR(events);
+            goto end;
+        }
+        if (event != Py_None && PyList_Append(events, event) != 0) {
+            Py_DECREF(event);
+            Py_CLEAR(events);
+            goto end;
+        }
+        Py_DECREF(event);
+    }
+end:
+    Py_XDECREF(dn_table);
+    ldap_msgfree(res);
+    return events;
+}
+#endif
+
 /* Process the server response after an extended operation. */
 static PyObject *
 parse_extended_result(LDAPConnection *self, LDAPMessage *res, PyObject *oid) {
@@ -1113,17 +1960,55 @@ parse_extended_result(LDAPConnection *self, LDAPMessage *res, PyObject *oid) {
     return retval;
 }
 
+/* Abandon an ongoing operation on the server, and remove it from the
+   pending_ops. The changes of the entry are rolled back for a pending add
+   or modify operation. An operation that's already finished is ignored.
+   Returns non-zero value on error. */
+static int
+abandon_operation(LDAPConnection *self, int msgid) {
+    int rc = 0;
+    LDAPModList *mods = NULL;
+    PyObject *obj = NULL;
+
+    DEBUG("abandon_operation (self:%p, msgid:%d)", self, msgid);
+    obj = get_from_pending_ops(self->pending_ops, msgid);
+    if (obj == NULL) return 0;
+
+    rc = ldap_abandon_ext(self->ld, msgid, NULL, NULL);
+    if (rc != LDAP_SUCCESS) {
+        Py_DECREF(obj);
+        set_exception(self->ld, rc);
+        return -1;
+    }
+
+    if (PyObject_TypeCheck(obj, &LDAPModListType)) {
+        mods = (LDAPModList *)obj;
+        /* The add or modify operation is not finished, rollback the changes. */
+        if (LDAPEntry_Rollback((LDAPEntry *)mods->entry, mods) != 0) {
+            Py_DECREF(obj);
+            return -1;
+        }
+    }
+    Py_DECREF(obj);
+
+    /* Remove message id from the pending_ops. */
+    return del_from_pending_ops(self->pending_ops, msgid);
+}
+
 /* Poll and process the result of an ongoing asynchronous LDAP operation. */
 PyObject *
 LDAPConnection_Result(LDAPConnection *self, int msgid, int millisec) {
     int rc = -1;
     int err = 0;
     int ppres = 0;
+    int all = LDAP_MSG_ALL;
+    int done = 0;
     unsigned int pperr = 0;
     LDAPMessage *res;
     LDAPControl **returned_ctrls = NULL;
     LDAPModList *mods = NULL;
     LDAPEntry *entry = NULL;
+    LDAPSearchIter *stream_iter = NULL;
     struct timeval timeout;
     PyObject *obj = NULL;
     PyObject *newdn = NULL;
@@ -1173,20 +2058,51 @@ LDAPConnection_Result(LDAPConnection *self, int msgid, int millisec) {
         timeout.tv_usec = 0L;
     }
 
+    if (PyObject_TypeCheck(obj, &LDAPSearchIterType)
+            && (((LDAPSearchIter *)obj)->sync_mode != 0
+                || ((LDAPSearchIter *)obj)->notify_mode != 0)) {
+        stream_iter = (LDAPSearchIter *)obj;
+        /* The persist stage and the change notifications never finish,
+           return the changes as they are received. */
+        if (stream_iter->sync_mode == LDAP_SYNC_REFRESH_AND_PERSIST
+                || stream_iter->notify_mode != 0) {
+            all = LDAP_MSG_RECEIVED;
+        }
+    }
+
     if (self->async == 0) {
         /* The ldap_result will block, and wait for server response or timeout. */
         Py_BEGIN_ALLOW_THREADS
         if (millisec >= 0) {
-            rc = ldap_result(self->ld, msgid, LDAP_MSG_ALL, &timeout, &res);
+            rc = ldap_result(self->ld, msgid, all, &timeout, &res);
         } else {
             /* Wait until response or global timeout. */
-            rc = ldap_result(self->ld, msgid, LDAP_MSG_ALL, NULL, &res);
+            rc = ldap_result(self->ld, msgid, all, NULL, &res);
         }
         Py_END_ALLOW_THREADS
     } else {
-        rc = ldap_result(self->ld, msgid, LDAP_MSG_ALL, &timeout, &res);
+        rc = ldap_result(self->ld, msgid, all, &timeout, &res);
+        /* Without waiting, ldap_result processes only one message per call.
+           Keep reading while libldap has received but unprocessed data,
+           because it won't be signalled on the socket again. The messages
+           of the other operations are queued by libldap. */
+        while (rc == 0 && _ldap_data_ready(self->ld)) {
+            rc = ldap_result(self->ld, msgid, all, &timeout, &res);
+        }
     }
 
+#ifndef WIN32
+    if (stream_iter != NULL && rc > 0) {
+        retval = parse_stream_result(self, res, stream_iter, &done);
+        Py_DECREF(obj);
+        if (done && del_from_pending_ops(self->pending_ops, msgid) != 0) {
+            Py_XDECREF(retval);
+            return NULL;
+        }
+        return retval;
+    }
+#endif
+
     switch (rc) {
     case -1:
         /* Error occurred during the operation. */
@@ -1195,35 +2111,27 @@ LDAPConnection_Result(LDAPConnection *self, int msgid, int millisec) {
         return NULL;
     case 0:
         /* Timeout exceeded.*/
+        if (self->async == 0 && all == LDAP_MSG_RECEIVED) {
+            /* No changes are received during the persist stage or
+               by the change notification. */
+            Py_DECREF(obj);
+            Py_RETURN_NONE;
+        }
         if (self->async == 0) {
+            Py_DECREF(obj);
             /* Set TimeoutError. */
             set_exception(self->ld, -5);
             /* Abandon the operation on the server. */
-            rc = ldap_abandon_ext(self->ld, msgid, NULL, NULL);
-            if (rc != LDAP_SUCCESS) {
-                set_exception(self->ld, rc);
-            }
-            
-            if (obj != Py_None && !PyUnicode_Check(obj)) {
-                mods = (LDAPModList *)obj;
-                /* LDAP add or modify operation is failed,
-                   then rollback the changes. */
-                if (LDAPEntry_Rollback((LDAPEntry *)mods->entry, mods) != 0) {
-                    Py_DECREF(obj);
-                    return NULL;
-                }
-                Py_DECREF(obj);
-            }
-            /* Remove operations from pending_ops. */
-            del_from_pending_ops(self->pending_ops, msgid);
-
+            abandon_operation(self, msgid);
             return NULL;
         }
         break;
     case LDAP_RES_SEARCH_ENTRY:
-        /* Received one of the entries from the server. */
-        /* Only matters when ldap_result is set with LDAP_MSG_ONE. */
-        break;
+    case LDAP_RES_SEARCH_REFERENCE:
+        /* With LDAP_MSG_ALL, the complete result of a search, that is
+           already queued by libldap (while it was reading the messages of
+           another operation), is returned with the type of its first
+           message. */
     case LDAP_RES_SEARCH_RESULT:
         retval = parse_search_result(self, res, obj);
         Py_DECREF(obj);
@@ -1271,6 +2179,20 @@ LDAPConnection_Result(LDAPConnection *self, int msgid, int millisec) {
         Py_DECREF(obj);
 
         Py_RETURN_TRUE;
+    case LDAP_RES_COMPARE:
+        rc = ldap_parse_result(self->ld, res, &err, NULL, NULL, NULL, NULL, 1);
+        Py_DECREF(obj);
+        /* Remove operations from pending_ops. */
+        if (del_from_pending_ops(self->pending_ops, msgid) != 0) return NULL;
+
+        if (rc != LDAP_SUCCESS) {
+            set_exception(self->ld, rc);
+            return NULL;
+        }
+        if (err == LDAP_COMPARE_TRUE) Py_RETURN_TRUE;
+        if (err == LDAP_COMPARE_FALSE) Py_RETURN_FALSE;
+        set_exception(self->ld, err);
+        return NULL;
     default:
         rc = ldap_parse_result(self->ld, res, &err, NULL, NULL, NULL,
                 &returned_ctrls, 1);
@@ -1353,7 +2275,6 @@ ldapconnection_result(LDAPConnection *self, PyObject *args, PyObject *kwds) {
 static PyObject *
 ldapconnection_abandon(LDAPConnection *self, PyObject *args) {
     int msgid = -1;
-    int rc = 0;
 
     if (!PyArg_ParseTuple(args, "i", &msgid)) {
         return NULL;
@@ -1361,16 +2282,7 @@ ldapconnection_abandon(LDAPConnection *self, PyObject *args) {
     DEBUG("ldapconnection_abandon (self:%p, args:%p)[msgid:%d]",
         self, args, msgid);
 
-    rc = ldap_abandon_ext(self->ld, msgid, NULL, NULL);
-    if (rc != LDAP_SUCCESS) {
-        set_exception(self->ld, rc);
-        return NULL;
-    }
-
-    /* Remove message id from the pending_ops. */
-    if (del_from_pending_ops(self->pending_ops, msgid) != 0) {
-        return NULL;
-    }
+    if (abandon_operation(self, msgid) != 0) return NULL;
 
     Py_RETURN_NONE;
 }
@@ -1412,6 +2324,8 @@ static PyMethodDef ldapconnection_methods[] = {
             "Add new LDAPEntry to the LDAP server."},
     {"close", (PyCFunction)ldapconnection_close, METH_VARARGS | METH_KEYWORDS,
             "Close connection with the LDAP Server."},
+    {"compare", (PyCFunction)ldapconnection_compare, METH_VARARGS,
+            "Compare an attribute value of an entry on the server."},
     {"delete", (PyCFunction)ldapconnection_delentry, METH_VARARGS,
             "Delete an LDAPEntry with the given distinguished name."},
     {"fileno", (PyCFunction)ldapconnection_fileno, METH_NOARGS,
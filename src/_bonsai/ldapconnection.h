@@ -19,6 +19,8 @@ typedef struct {
     char managedsait;
     char ignore_referrals;
     SOCKET csock;
+    /* The write end of the init notifier (Unix). */
+    SOCKET ssock;
     PyObject *socketpair;
 } LDAPConnection;
 
@@ -157,28 +157,35 @@ binding(LDAPConnectIter *self) {
     DEBUG("binding [state:%d]", self->state);
     if (self->state == 3) {
         /* First call of bind. */
-        rc = _ldap_bind(self->conn->ld, self->info, self->conn->ppolicy,
-                NULL, &(self->message_id));
+        if (self->conn->async == 0) {
+            /* Connecting to the server might block, let other threads run. */
+            Py_BEGIN_ALLOW_THREADS
+            rc = _ldap_bind(self->conn->ld, self->info, self->conn->ppolicy,
+                    NULL, &(self->message_id));
+            Py_END_ALLOW_THREADS
+        } else {
+            rc = _ldap_bind(self->conn->ld, self->info, self->conn->ppolicy,
+                    NULL, &(self->message_id));
+        }
         if (rc != LDAP_SUCCESS && rc != LDAP_SASL_BIND_IN_PROGRESS && rc != LDAP_X_CONNECTING) {
-            close_socketpair(self->conn->socketpair);
+            close_init_notifier(&(self->conn->csock), &(self->conn->ssock));
             set_exception(self->conn->ld, rc);
             return NULL;
         }
-        if (self->conn->csock != -1) {
-            /* Dummy sockets are no longer needed. Dispose. */
-            self->conn->csock = -1;
-            close_socketpair(self->conn->socketpair);
-        }
+        /* The notifier is no longer needed. Dispose. */
+        close_init_notifier(&(self->conn->csock), &(self->conn->ssock));
         self->state = 4;
         Py_RETURN_NONE;
     } else {
         if (self->conn->async == 0) {
             /* Block until the server response. */
+            Py_BEGIN_ALLOW_THREADS
             if (self->timeout == -1) {
                 rc = ldap_result(self->conn->ld, self->message_id, LDAP_MSG_ALL, NULL, &res);
             } else {
                 rc = ldap_result(self->conn->ld, self->message_id, LDAP_MSG_ALL, &polltime, &res);
             }
+            Py_END_ALLOW_THREADS
         } else {
             /* Binding is already in progress, poll result from the server. */
             rc = ldap_result(self->conn->ld, self->message_id, LDAP_MSG_ALL, &polltime, &res);
@@ -408,6 +415,10 @@ check_tls_result(LDAP *ld, int msgid, int timeout, char async, SOCKET csock) {
 static void
 ldapconnectiter_dealloc(LDAPConnectIter* self) {
     DEBUG("ldapconnectiter_dealloc (self:%p)", self);
+#ifndef WIN32
+    /* The initialisation is not finished, drop it. */
+    _ldap_abandon_init_thread(self->init_thread_data);
+#endif
     Py_XDECREF(self->conn);
     if (self->info != NULL) dealloc_conn_info(self->info);
     Py_TYPE(self)->tp_free((PyObject*)self);
@@ -543,7 +554,9 @@ PyObject *
 LDAPConnectIter_Next(LDAPConnectIter *self, int timeout) {
     int rc = -1;
     PyObject *val = NULL;
+#ifdef WIN32
     char buff[1];
+#endif
 
     /* The connection is already binded. */
     if (self->conn->closed == 0) {
@@ -560,13 +573,21 @@ LDAPConnectIter_Next(LDAPConnectIter *self, int timeout) {
     if (self->state == 0) {
         rc = _ldap_finish_init_thread(self->conn->async, self->init_thread, &(self->timeout),
                 self->init_thread_data, &(self->conn->ld));
+#ifndef WIN32
+        /* The initialisation data is freed, unless it's still in progress. */
+        if (rc != 0) self->init_thread_data = NULL;
+#endif
         if (rc == -1) return NULL; /* Error is happened. */
         if (rc == 1) {
             /* Initialisation is finished. */
             self->state = 1;
             if (self->conn->csock != -1) {
-                /* Read and drop the data from the dummy socket. */
+                /* Read and drop the data from the notifier. */
+#ifdef WIN32
                 if (recv(self->conn->csock, buff, 1, 0) == -1) return NULL;
+#else
+                if (read_init_notifier(self->conn->csock) != 0) return NULL;
+#endif
             }
             /* Set CA cert dir, CA cert and client cert. */
             if (set_certificates(self) != 0) {
@@ -0,0 +1,460 @@
+#include "ldapdn.h"
+#include "utils.h"
+
+/* Characters that can be escaped with a backslash in an attribute value. */
+#define DN_ESCAPABLE "\"+,;<>\\ #="
+/* Characters that are always escaped in the normalized form. */
+#define DN_NORM_ESCAPE "\"+,;<>\\="
+
+#define IS_HEX(c) (((c) >= '0' && (c) <= '9') || ((c) >= 'a' && (c) <= 'f') \
+    || ((c) >= 'A' && (c) <= 'F'))
+#define IS_ALPHA(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z'))
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+typedef struct {
+    const char *str;  /* The UTF-8 string of the DN. */
+    Py_ssize_t len;
+    Py_ssize_t pos;
+    char *norm;       /* Buffer for the normalized form. */
+    Py_ssize_t nlen;
+    char *val;        /* Buffer for an unescaped attribute value. */
+    Py_ssize_t vlen;
+    Py_ssize_t vfirst; /* The significant part of the unescaped value. */
+    Py_ssize_t vlast;
+    char nonascii;
+} dnparser;
+
+typedef struct {
+    const char *ptr;
+    Py_ssize_t len;
+} dnsegment;
+
+static int
+hex_to_int(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+static int
+is_separator(dnparser *p) {
+    return (p->pos == p->len || p->str[p->pos] == ',' || p->str[p->pos] == '+');
+}
+
+/* Parse an attribute type, either a descriptor (keystring) or a numeric OID.
+   Leading spaces are permitted. Set the position of the type in the DN string
+   to `start` and `end`, and write its lower-cased form into the normalized
+   buffer. Return 0 on success, -1 if the type is malformed. */
+static int
+parse_attrtype(dnparser *p, Py_ssize_t *start, Py_ssize_t *end) {
+    const char *str = p->str;
+
+    while (p->pos < p->len && str[p->pos] == ' ') p->pos++;
+    *start = p->pos;
+    if (p->pos >= p->len) return -1;
+
+    if (IS_ALPHA(str[p->pos])) {
+        while (p->pos < p->len && (IS_ALPHA(str[p->pos])
+                || IS_DIGIT(str[p->pos]) || str[p->pos] == '-'
+                || str[p->pos] == '_')) {
+            p->pos++;
+        }
+    } else if (IS_DIGIT(str[p->pos])) {
+        while (1) {
+            if (p->pos >= p->len || !IS_DIGIT(str[p->pos])) return -1;
+            while (p->pos < p->len && IS_DIGIT(str[p->pos])) p->pos++;
+            if (p->pos < p->len && str[p->pos] == '.') p->pos++;
+            else break;
+        }
+    } else {
+        return -1;
+    }
+    *end = p->pos;
+    /* The type must be followed immediately by an equals sign. */
+    if (p->pos >= p->len || str[p->pos] != '=') return -1;
+    p->pos++;
+
+    for (Py_ssize_t i = *start; i < *end; i++) {
+        p->norm[p->nlen++] = (char)tolower((unsigned char)str[i]);
+    }
+    p->norm[p->nlen++] = '=';
+    return 0;
+}
+
+/* Parse a backslash escaped pair at the current position into the value
+   buffer. Return 0 on success, -1 if the escape sequence is invalid. */
+static int
+parse_escaped(dnparser *p) {
+    const char *str = p->str;
+
+    if (p->pos + 2 < p->len && IS_HEX(str[p->pos + 1])
+            && IS_HEX(str[p->pos + 2])) {
+        p->val[p->vlen++] = (char)(hex_to_int(str[p->pos + 1]) * 16
+            + hex_to_int(str[p->pos + 2]));
+        p->pos += 3;
+        return 0;
+    }
+    if (p->pos + 1 < p->len && str[p->pos + 1] != '\0'
+            && strchr(DN_ESCAPABLE, str[p->pos + 1]) != NULL) {
+        p->val[p->vlen++] = str[p->pos + 1];
+        p->pos += 2;
+        return 0;
+    }
+    return -1;
+}
+
+/* Write the unescaped value between `first` and `last` into the normalized
+   buffer, escaping it in a canonical way and lower-casing ASCII letters. */
+static void
+write_normalized_value(dnparser *p, Py_ssize_t first, Py_ssize_t last) {
+    static const char hexdigits[] = "0123456789abcdef";
+    unsigned char ch;
+
+    for (Py_ssize_t i = first; i < last; i++) {
+        ch = (unsigned char)p->val[i];
+        if ((ch != '\0' && strchr(DN_NORM_ESCAPE, ch) != NULL)
+                || (i == first && (ch == ' ' || ch == '#'))
+                || (i == last - 1 && ch == ' ')) {
+            p->norm[p->nlen++] = '\\';
+            p->norm[p->nlen++] = (char)ch;
+        } else if (ch < 0x20 || ch == 0x7F) {
+            p->norm[p->nlen++] = '\\';
+            p->norm[p->nlen++] = hexdigits[ch >> 4];
+            p->norm[p->nlen++] = hexdigits[ch & 0x0F];
+        } else {
+            if (ch >= 0x80) p->nonascii = 1;
+            p->norm[p->nlen++] = (char)tolower(ch);
+        }
+    }
+}
+
+/* Parse an attribute value (hex string, quoted string or string) after the
+   equals sign. Set the position of the raw value to `start` and `end`, keep
+   the unescaped value in the value buffer between `vfirst` and `vlast` (for
+   hex strings they're both -1) and write its normalized form into the
+   normalized buffer.
+   Return 0 on success, -1 if the value is malformed. */
+static int
+parse_attrvalue(dnparser *p, Py_ssize_t *start, Py_ssize_t *end) {
+    const char *str = p->str;
+    Py_ssize_t first = -1, last = 0;
+    unsigned char ch;
+
+    *start = p->pos;
+    p->vlen = 0;
+    p->vfirst = -1;
+    p->vlast = -1;
+
+    if (p->pos < p->len && str[p->pos] == '#') {
+        /* BER encoded value in hex string form. */
+        p->norm[p->nlen++] = '#';
+        p->pos++;
+        if (!(p->pos + 1 < p->len && IS_HEX(str[p->pos])
+                && IS_HEX(str[p->pos + 1]))) {
+            return -1;
+        }
+        while (p->pos + 1 < p->len && IS_HEX(str[p->pos])
+                && IS_HEX(str[p->pos + 1])) {
+            p->norm[p->nlen++] = (char)tolower((unsigned char)str[p->pos]);
+            p->norm[p->nlen++] = (char)tolower((unsigned char)str[p->pos + 1]);
+            p->pos += 2;
+        }
+        while (p->pos < p->len && str[p->pos] == ' ') p->pos++;
+        *end = p->pos;
+        return is_separator(p) ? 0 : -1;
+    }
+
+    if (p->pos < p->len && str[p->pos] == '"') {
+        /* Quoted value (RFC 2253 compatibility), every char is significant. */
+        p->pos++;
+        while (p->pos < p->len && str[p->pos] != '"') {
+            if (str[p->pos] == '\\') {
+                if (parse_escaped(p) != 0) return -1;
+            } else {
+                p->val[p->vlen++] = str[p->pos++];
+            }
+        }
+        if (p->pos >= p->len) return -1;
+        p->pos++;
+        while (p->pos < p->len && str[p->pos] == ' ') p->pos++;
+        *end = p->pos;
+        if (!is_separator(p)) return -1;
+        p->vfirst = 0;
+        p->vlast = p->vlen;
+        write_normalized_value(p, 0, p->vlen);
+        return 0;
+    }
+
+    while (!is_separator(p)) {
+        ch = (unsigned char)str[p->pos];
+        if (ch == '\\') {
+            if (parse_escaped(p) != 0) return -1;
+        } else if (ch == '"' || ch == ';' || ch == '<' || ch == '>'
+                || ch == '\0') {
+            return -1;
+        } else {
+            p->val[p->vlen++] = (char)ch;
+            p->pos++;
+            /* Unescaped leading and trailing spaces are insignificant. */
+            if (ch == ' ') continue;
+        }
+        if (first < 0) first = p->vlen - 1;
+        last = p->vlen;
+    }
+    *end = p->pos;
+    if (first < 0) first = last = 0;
+    p->vfirst = first;
+    p->vlast = last;
+    write_normalized_value(p, first, last);
+    return 0;
+}
+
+static int
+compare_segments(const void *a, const void *b) {
+    const dnsegment *sa = (const dnsegment *)a;
+    const dnsegment *sb = (const dnsegment *)b;
+    int rc = memcmp(sa->ptr, sb->ptr, sa->len < sb->len ? sa->len : sb->len);
+
+    if (rc != 0) return rc;
+    return (sa->len > sb->len) - (sa->len < sb->len);
+}
+
+/* Sort the AVAs of a multivalued RDN in the normalized buffer, starting at
+   `rdn_start`, so that their order does not affect the comparison. */
+static int
+sort_rdn_avas(dnparser *p, Py_ssize_t rdn_start, Py_ssize_t num) {
+    Py_ssize_t i, j = 0, seglen = p->nlen - rdn_start;
+    char *tmp = NULL;
+    dnsegment *segs = NULL;
+
+    tmp = (char *)malloc(seglen);
+    segs = (dnsegment *)malloc(sizeof(dnsegment) * num);
+    if (tmp == NULL || segs == NULL) {
+        free(tmp);
+        free(segs);
+        PyErr_NoMemory();
+        return -1;
+    }
+    memcpy(tmp, p->norm + rdn_start, seglen);
+
+    /* Split at the separators that are not escaped. */
+    segs[0].ptr = tmp;
+    for (i = 0; i < seglen; i++) {
+        if (tmp[i] == '\\') {
+            i++;
+        } else if (tmp[i] == '+') {
+            segs[j].len = tmp + i - segs[j].ptr;
+            segs[++j].ptr = tmp + i + 1;
+        }
+    }
+    segs[j].len = tmp + seglen - segs[j].ptr;
+    qsort(segs, num, sizeof(dnsegment), compare_segments);
+
+    p->nlen = rdn_start;
+    for (i = 0; i < num; i++) {
+        if (i > 0) p->norm[p->nlen++] = '+';
+        memcpy(p->norm + p->nlen, segs[i].ptr, segs[i].len);
+        p->nlen += segs[i].len;
+    }
+    free(tmp);
+    free(segs);
+    return 0;
+}
+
+/* Create a Python string from a part of the DN string. */
+static PyObject *
+substr(dnparser *p, Py_ssize_t start, Py_ssize_t end) {
+    return PyUnicode_DecodeUTF8(p->str + start, end - start, "strict");
+}
+
+/* Create a Python string of the last parsed attribute value. Escaped chars
+   are unescaped, but values in hex string form are kept as they are. */
+static PyObject *
+unescaped_value(dnparser *p, Py_ssize_t start, Py_ssize_t end) {
+    if (p->vfirst < 0) return substr(p, start, end);
+    return PyUnicode_DecodeUTF8(p->val + p->vfirst, p->vlast - p->vfirst,
+        "surrogateescape");
+}
+
+/* Create the Python object of the normalized form. */
+static PyObject *
+create_normalized(dnparser *p) {
+    PyObject *norm = NULL, *lower = NULL;
+
+    norm = PyUnicode_DecodeUTF8(p->norm, p->nlen, "surrogateescape");
+    if (norm == NULL || p->nonascii == 0) return norm;
+
+    /* Non-ASCII chars need Unicode aware lower-casing. */
+    lower = PyObject_CallMethod(norm, "lower", NULL);
+    Py_DECREF(norm);
+    return lower;
+}
+
+/* Parse the DN string and build its normalized form. If `rdns` and `rdnstrs`
+   are not NULL then they're set to new tuples of the parsed RDNs, and of the
+   RDNs in their original string format. */
+static PyObject *
+parse(PyObject *strdn, PyObject **rdns, PyObject **rdnstrs) {
+    dnparser p;
+    Py_ssize_t rdn_start = 0, rdn_nstart = 0, num_of_avas = 0;
+    Py_ssize_t tstart, tend, vstart, vend;
+    PyObject *rdn_list = NULL, *str_list = NULL, *avas = NULL;
+    PyObject *item = NULL, *tmp = NULL, *norm = NULL;
+    int build = (rdns != NULL && rdnstrs != NULL);
+
+    if (!PyUnicode_Check(strdn)) {
+        PyErr_SetString(PyExc_TypeError, "The DN must be a string.");
+        return NULL;
+    }
+    memset(&p, 0, sizeof(dnparser));
+    p.str = PyUnicode_AsUTF8AndSize(strdn, &p.len);
+    if (p.str == NULL) return NULL;
+
+    p.norm = (char *)malloc(p.len * 3 + 1);
+    p.val = (char *)malloc(p.len + 1);
+    if (p.norm == NULL || p.val == NULL) {
+        PyErr_NoMemory();
+        goto end;
+    }
+    if (build) {
+        rdn_list = PyList_New(0);
+        str_list = PyList_New(0);
+        if (rdn_list == NULL || str_list == NULL) goto end;
+    }
+
+    while (p.len > 0) {
+        if (num_of_avas == 0) {
+            avas = build ? PyList_New(0) : NULL;
+            if (build && avas == NULL) goto end;
+        }
+        if (parse_attrtype(&p, &tstart, &tend) != 0) goto invalid;
+        if (parse_attrvalue(&p, &vstart, &vend) != 0) goto invalid;
+        num_of_avas++;
+
+        if (build) {
+            item = Py_BuildValue("(NN)", substr(&p, tstart, tend),
+                unescaped_value(&p, vstart, vend));
+            if (item == NULL) goto end;
+            if (PyList_Append(avas, item) != 0) goto end;
+            Py_CLEAR(item);
+        }
+
+        if (p.pos < p.len && p.str[p.pos] == '+') {
+            p.norm[p.nlen++] = '+';
+            p.pos++;
+            continue;
+        }
+
+        /* End of the RDN. */
+        if (num_of_avas > 1 && sort_rdn_avas(&p, rdn_nstart, num_of_avas) != 0) {
+            goto end;
+        }
+        if (build) {
+            tmp = PyList_AsTuple(avas);
+            if (tmp == NULL) goto end;
+            if (PyList_Append(rdn_list, tmp) != 0) goto end;
+            Py_CLEAR(tmp);
+            Py_CLEAR(avas);
+            tmp = substr(&p, rdn_start, p.pos);
+            if (tmp == NULL) goto end;
+            if (PyList_Append(str_list, tmp) != 0) goto end;
+            Py_CLEAR(tmp);
+        }
+        num_of_avas = 0;
+        if (p.pos == p.len) break;
+        /* Skip the comma. */
+        p.norm[p.nlen++] = ',';
+        p.pos++;
+        rdn_start = p.pos;
+        rdn_nstart = p.nlen;
+    }
+
+    if (build) {
+        *rdns = PyList_AsTuple(rdn_list);
+        if (*rdns == NULL) goto end;
+        *rdnstrs = PyList_AsTuple(str_list);
+        if (*rdnstrs == NULL) {
+            Py_CLEAR(*rdns);
+            goto end;
+        }
+    }
+    norm = create_normalized(&p);
+    if (norm == NULL && build) {
+        Py_CLEAR(*rdns);
+        Py_CLEAR(*rdnstrs);
+    }
+    goto end;
+invalid:
+    tmp = get_error_by_code(0x22);
+    if (tmp == NULL) goto end;
+    PyErr_SetObject(tmp, strdn);
+    Py_CLEAR(tmp);
+end:
+    free(p.norm);
+    free(p.val);
+    Py_XDECREF(rdn_list);
+    Py_XDECREF(str_list);
+    Py_XDECREF(avas);
+    Py_XDECREF(item);
+    Py_XDECREF(tmp);
+    return norm;
+}
+
+/* Parse a DN string according to RFC 4514. Return a tuple of three:
+   the RDNs in their original string format, the RDNs as tuples of
+   attribute type and value pairs and the normalized form of the DN.
+   Raise InvalidDN if the string is not a valid distinguished name. */
+PyObject *
+parse_dn(PyObject *strdn) {
+    PyObject *rdns = NULL, *rdnstrs = NULL, *norm = NULL;
+
+    norm = parse(strdn, &rdns, &rdnstrs);
+    if (norm == NULL) return NULL;
+
+    return Py_BuildValue("(NNN)", rdnstrs, rdns, norm);
+}
+
+/* Return only the normalized form of a DN string. The normalized form has
+   lower-cased attribute types and values, insignificant spaces removed,
+   values escaped in a canonical way and the AVAs of multivalued RDNs sorted,
+   therefore equivalent DNs have the same normalized form. */
+PyObject *
+normalize_dn(PyObject *strdn) {
+    return parse(strdn, NULL, NULL);
+}
+
+/* Return an LDAPDN object for the `strdn` from the `table` dictionary. If
+   it's not in the table yet, then create it and store it by its string and
+   its normalized form, thus equivalent DNs share the same object. Sharing is
+   safe, because LDAPDN objects are immutable. */
+PyObject *
+get_interned_dn(PyObject *table, PyObject *strdn) {
+    PyObject *dn = NULL, *norm = NULL;
+
+    dn = PyDict_GetItemWithError(table, strdn);
+    if (dn != NULL) {
+        Py_INCREF(dn);
+        return dn;
+    }
+    if (PyErr_Occurred()) return NULL;
+
+    norm = normalize_dn(strdn);
+    if (norm == NULL) return NULL;
+
+    dn = PyDict_GetItemWithError(table, norm);
+    if (dn != NULL) {
+        Py_INCREF(dn);
+    } else {
+        if (PyErr_Occurred()) goto end;
+        dn = PyObject_CallFunctionObjArgs(LDAPDNObj, strdn, NULL);
+        if (dn == NULL) goto end;
+        if (PyDict_SetItem(table, norm, dn) != 0) {
+            Py_CLEAR(dn);
+            goto end;
+        }
+    }
+    if (PyDict_SetItem(table, strdn, dn) != 0) Py_CLEAR(dn);
+end:
+    Py_DECREF(norm);
+    return dn;
+}
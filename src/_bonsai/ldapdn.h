@@ -0,0 +1,12 @@
+#ifndef LDAPDN_H_
+#define LDAPDN_H_
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+
+PyObject *parse_dn(PyObject *strdn);
+PyObject *normalize_dn(PyObject *strdn);
+PyObject *get_interned_dn(PyObject *table, PyObject *strdn);
+
+#endif /* LDAPDN_H_ */
@@ -1,5 +1,6 @@
 #include "utils.h"
 #include "ldapentry.h"
+#include "ldapdn.h"
 
 /* Clear all object in the LDAPEntry. */
 static int
@@ -8,6 +9,7 @@ ldapentry_clear(LDAPEntry *self) {
     Py_CLEAR(self->conn);
     Py_CLEAR(self->deleted);
     Py_CLEAR(self->dn);
+    Py_CLEAR(self->ranges);
     PyDict_Type.tp_clear((PyObject*)self);
 
     return 0;
@@ -27,6 +29,7 @@ ldapentry_traverse(LDAPEntry *self, visitproc visit, void *arg) {
     Py_VISIT(self->dn);
     Py_VISIT(self->deleted);
     Py_VISIT(self->conn);
+    Py_VISIT(self->ranges);
     return 0;
 }
 
@@ -49,6 +52,7 @@ ldapentry_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
             Py_DECREF(self);
             return NULL;
         }
+        self->ranges = NULL;
     }
     DEBUG("ldapentry_new [self:%p]", self);
     return (PyObject *)self;
@@ -204,16 +208,87 @@ error:
     return NULL;
 }
 
-/*  Create a LDAPEntry from a LDAPMessage. */
+/*  Convert the `bval` value of a DN-valued attribute into a shared LDAPDN
+    object using the `dn_table`. If the value is not a valid UTF-8 string
+    or DN, then convert it as any other value. Other errors are raised. */
+static PyObject *
+dnval2PyObject(PyObject *dn_table, struct berval *bval) {
+    int invalid = 0;
+    PyObject *strdn = NULL, *dn = NULL, *error = NULL;
+    PyObject *type = NULL, *value = NULL, *traceback = NULL;
+
+    strdn = PyUnicode_DecodeUTF8(bval->bv_val, bval->bv_len, "strict");
+    if (strdn == NULL) {
+        if (!PyErr_ExceptionMatches(PyExc_UnicodeDecodeError)) return NULL;
+        PyErr_Clear();
+        return berval2PyObject(bval, 0);
+    }
+    dn = get_interned_dn(dn_table, strdn);
+    Py_DECREF(strdn);
+    if (dn != NULL) return dn;
+
+    /* Check that the error is an InvalidDN. */
+    PyErr_Fetch(&type, &value, &traceback);
+    error = get_error_by_code(0x22);
+    if (error == NULL) {
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(traceback);
+        return NULL;
+    }
+    invalid = PyErr_GivenExceptionMatches(type, error);
+    Py_DECREF(error);
+    if (!invalid) {
+        PyErr_Restore(type, value, traceback);
+        return NULL;
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    return berval2PyObject(bval, 0);
+}
+
+/*  Cut the range option (e.g. `member;range=0-1499`) off from the end of
+    an attribute's name. Returns the index of the next value to retrieve,
+    -1 for the last range, or -2 if the name has no valid range option. */
+static long
+split_range_option(char *attr) {
+    long low = 0, high = 0;
+    char *opt = NULL, *end = NULL;
+
+    opt = strstr(attr, ";range=");
+    if (opt == NULL) return -2;
+
+    low = strtol(opt + 7, &end, 10);
+    if (end == opt + 7 || *end != '-' || low < 0) return -2;
+    if (end[1] == '*' && end[2] == '\0') {
+        *opt = '\0';
+        return -1;
+    }
+    high = strtol(end + 1, &end, 10);
+    if (*end != '\0' || high < low) return -2;
+    *opt = '\0';
+    return high + 1;
+}
+
+/*  Create a LDAPEntry from a LDAPMessage. If `dn_table` is not NULL,
+    then the values of the client's DN attributes are interned in it.
+    If `auto_range` is set, the values of a ranged attribute are set by
+    the attribute's name without the range option, and the start of the
+    next range is kept in the entry's ranges. */
 LDAPEntry *
-LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn) {
-    int i;
+LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn,
+        PyObject *dn_table, int auto_range) {
+    int i, rc = 0;
     int contain = -1;
+    int isdn = 0;
+    long next_range = -2;
     char *dn;
     char *attr;
-    struct berval **values;
+    struct berval **values = NULL;
     BerElement *ber;
     PyObject *rawval_list = NULL;
+    PyObject *dnattr_list = NULL;
     PyObject *val = NULL, *attrobj = NULL;
     PyObject *args = NULL;
     PyObject *lvl = NULL, *tmp = NULL;
@@ -248,14 +323,26 @@ LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn) {
         return NULL;
     }
 
+    if (dn_table != NULL) {
+        /* Get list of attribute's names, whose values are DNs. */
+        dnattr_list = PyObject_GetAttrString(conn->client, "dn_attributes");
+        if (dnattr_list == NULL) {
+            Py_DECREF(self);
+            Py_DECREF(rawval_list);
+            return NULL;
+        }
+    }
+
     /* Iterate over the LDAP attributes. */
     for (attr = ldap_first_attribute(conn->ld, entrymsg, &ber);
         attr != NULL; attr = ldap_next_attribute(conn->ld, entrymsg, ber)) {
+        values = ldap_get_values_len(conn->ld, entrymsg, attr);
+        if (auto_range) next_range = split_range_option(attr);
         /* Create a string of attribute's name and add to the attributes list. */
         attrobj = PyUnicode_FromString(attr);
         if (attrobj == NULL) goto error;
-        values = ldap_get_values_len(conn->ld, entrymsg, attr);
         ldap_memfree(attr);
+        attr = NULL;
 
         lvl = PyObject_CallFunctionObjArgs(LDAPValueListObj, NULL);
         if (lvl == NULL) goto error;
@@ -265,28 +352,51 @@ LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn) {
             if (tmp == NULL) goto error;
             contain = PyObject_IsTrue(PyTuple_GET_ITEM(tmp, 0));
             Py_DECREF(tmp);
+            isdn = 0;
+            if (dnattr_list != NULL && contain == 0) {
+                /* Check attribute is in the DN attribute list. */
+                tmp = unique_contains(dnattr_list, attrobj);
+                if (tmp == NULL) goto error;
+                isdn = PyObject_IsTrue(PyTuple_GET_ITEM(tmp, 0));
+                Py_DECREF(tmp);
+            }
             for (i = 0; values[i] != NULL; i++) {
                 /* Convert berval to PyObject*, if it's failed skip it. */
-                val = berval2PyObject(values[i], contain);
+                if (isdn) {
+                    val = dnval2PyObject(dn_table, values[i]);
+                    if (val == NULL) goto error;
+                } else {
+                    val = berval2PyObject(values[i], contain);
+                }
                 if (val == NULL) continue;
                 /* If the attribute has more value, then append to the list. */
-                if (PyList_Append(lvl, val) != 0) {
-                    Py_DECREF(lvl);
-                    goto error;
-                }
+                rc = PyList_Append(lvl, val);
                 Py_DECREF(val);
+                if (rc != 0) goto error;
             }
+            ldap_value_free_len(values);
+            values = NULL;
         }
-        ldap_value_free_len(values);
-        if (PyDict_SetItem((PyObject *)self, attrobj, lvl) != 0) {
-            Py_DECREF(lvl);
-            goto error;
+        if (PyDict_SetItem((PyObject *)self, attrobj, lvl) != 0) goto error;
+        Py_CLEAR(lvl);
+        if (next_range >= 0) {
+            /* The values of the attribute have to be retrieved in more
+               ranges. */
+            if (self->ranges == NULL) {
+                self->ranges = PyDict_New();
+                if (self->ranges == NULL) goto error;
+            }
+            tmp = PyLong_FromLong(next_range);
+            if (tmp == NULL) goto error;
+            rc = PyDict_SetItem(self->ranges, attrobj, tmp);
+            Py_DECREF(tmp);
+            if (rc != 0) goto error;
         }
-        Py_DECREF(attrobj);
-        Py_DECREF(lvl);
+        Py_CLEAR(attrobj);
     }
     /* Cleaning the mess. */
     Py_DECREF(rawval_list);
+    Py_XDECREF(dnattr_list);
     if (ber != NULL) {
         ber_free(ber, 0);
     }
@@ -294,13 +404,17 @@ LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn) {
 
 error:
     Py_XDECREF(attrobj);
+    Py_XDECREF(lvl);
     Py_DECREF(self);
     Py_DECREF(rawval_list);
+    Py_XDECREF(dnattr_list);
+    if (values != NULL) ldap_value_free_len(values);
     ldap_memfree(attr);
     if (ber != NULL) {
         ber_free(ber, 0);
     }
-    return (LDAPEntry *)PyErr_NoMemory();
+    if (!PyErr_Occurred()) PyErr_NoMemory();
+    return NULL;
 }
 
 /* Preform a LDAP add or modify operation depend on the `mod` parameter.
@@ -528,6 +642,14 @@ ldapentry_setdeletedkeys(LDAPEntry *self, PyObject *value, void *closure) {
     return -1;
 }
 
+/* Returns the dict of the incomplete ranged attributes or None. */
+static PyObject *
+ldapentry_getranges(LDAPEntry *self, void *closure) {
+    if (self->ranges == NULL) Py_RETURN_NONE;
+    Py_INCREF(self->ranges);
+    return self->ranges;
+}
+
 /* Returns the copy of the deleted keys in the LDAPEntry. */
 static PyObject *
 ldapentry_getdeletedkeys(LDAPEntry *self, void *closure) {
@@ -588,12 +710,14 @@ ldapentry_rename(LDAPEntry *self, PyObject *args, PyObject *kwds) {
         return NULL;
     }
 
-    /* Get rdn and parent strings. */
+    /* Get rdn and parent strings from the already parsed RDNs. */
     newrdn = PySequence_GetItem(new_ldapdn, 0);
-    newparent = PySequence_GetSlice(new_ldapdn, 1, PyObject_Size(self->dn));
+    newparent = PySequence_GetSlice(new_ldapdn, 1, PY_SSIZE_T_MAX);
     if (newrdn == NULL || newparent == NULL) {
         free(olddn_str);
-        Py_DECREF(tmp);
+        Py_XDECREF(newrdn);
+        Py_XDECREF(newparent);
+        Py_DECREF(new_ldapdn);
         return NULL;
     }
 
@@ -928,6 +1052,8 @@ static PyGetSetDef ldapentry_getsetters[] = {
     {"deleted_keys", (getter)ldapentry_getdeletedkeys,
                      (setter)ldapentry_setdeletedkeys,
                      "Deleted keys", NULL},
+    {"_ranges",     (getter)ldapentry_getranges, NULL,
+                    "Incomplete ranged attributes", NULL},
     {NULL}  /* Sentinel */
 };
 
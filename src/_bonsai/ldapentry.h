@@ -13,6 +13,8 @@ typedef struct {
     PyObject *dn;
     PyObject *deleted;
     LDAPConnection *conn;
+    /* The index of the next value of the incomplete ranged attributes. */
+    PyObject *ranges;
 } LDAPEntry;
 
 extern PyTypeObject LDAPEntryType;
@@ -20,7 +22,8 @@ extern PyTypeObject LDAPEntryType;
 PyObject *LDAPEntry_AddOrModify(LDAPEntry *self, int mod);
 int LDAPEntry_Rollback(LDAPEntry *self, LDAPModList* mods);
 LDAPModList *LDAPEntry_CreateLDAPMods(LDAPEntry *self);
-LDAPEntry *LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn);
+LDAPEntry *LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPConnection *conn,
+        PyObject *dn_table, int auto_range);
 PyObject *LDAPEntry_GetItem(LDAPEntry *self, PyObject *key);
 int LDAPEntry_SetItem(LDAPEntry *self, PyObject *key, PyObject *value);
 int LDAPEntry_SetConnection(LDAPEntry *self, LDAPConnection *conn);
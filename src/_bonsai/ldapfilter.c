@@ -0,0 +1,1086 @@
+#include "ldapfilter.h"
+#include "utils.h"
+
+#define IS_HEX(c) (((c) >= '0' && (c) <= '9') || ((c) >= 'a' && (c) <= 'f') \
+    || ((c) >= 'A' && (c) <= 'F'))
+#define IS_ALPHA(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z'))
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define IS_LDH(c) (IS_ALPHA(c) || IS_DIGIT(c) || (c) == '-')
+#define IS_ATTRCHAR(c) (IS_LDH(c) || (c) == '.' || (c) == ';')
+/* The whitespaces that libldap skips between the parts of a filter. */
+#define IS_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n')
+
+enum {
+    FILTER_AND,
+    FILTER_OR,
+    FILTER_NOT,
+    FILTER_EQUALITY,
+    FILTER_APPROX,
+    FILTER_GE,
+    FILTER_LE,
+    FILTER_PRESENT,
+    FILTER_SUBSTRINGS,
+    FILTER_EXTENSIBLE
+};
+
+/* Matching rules of the extensible match, that are evaluated locally. */
+enum {
+    RULE_NONE,
+    RULE_CASE_IGNORE,
+    RULE_CASE_EXACT,
+    RULE_BIT_AND,
+    RULE_BIT_OR,
+    RULE_UNKNOWN
+};
+
+typedef struct {
+    const char *ptr;
+    Py_ssize_t len;
+} filterval;
+
+struct filterop {
+    int type;
+    Py_ssize_t size;   /* The number of operations of the node and its children. */
+    char *attr;        /* Lower-cased attribute description, or NULL. */
+    char *buffer;      /* The unescaped assertion value and substrings. */
+    filterval value;
+    filterval *subs;   /* Initial, any and final substrings, the first and the
+                          last ones are empty if they are not set. */
+    Py_ssize_t nsubs;
+    char *rule;        /* Matching rule of an extensible match. */
+    int rule_type;
+    char dnattrs;
+};
+
+typedef struct {
+    const char *str;
+    Py_ssize_t len;
+    Py_ssize_t pos;
+    filterop *ops;
+    Py_ssize_t nops;
+    Py_ssize_t cap;
+} filterparser;
+
+static int parse_filter(filterparser *p);
+
+static int
+hex_to_int(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+static void
+free_ops(filterop *ops, Py_ssize_t nops) {
+    if (ops == NULL) return;
+    for (Py_ssize_t i = 0; i < nops; i++) {
+        free(ops[i].attr);
+        free(ops[i].buffer);
+        free(ops[i].subs);
+        free(ops[i].rule);
+    }
+    free(ops);
+}
+
+static void
+set_filter_error(const char *filter, Py_ssize_t pos) {
+    PyObject *error = NULL;
+
+    if (PyErr_Occurred()) return;
+    error = get_error_by_code(LDAP_FILTER_ERROR);
+    if (error == NULL) return;
+    PyErr_Format(error, "Invalid search filter at position %zd: \"%s\".",
+        pos, filter);
+    Py_DECREF(error);
+}
+
+static void
+skip_spaces(filterparser *p) {
+    while (p->pos < p->len && IS_SPACE(p->str[p->pos])) p->pos++;
+}
+
+/* Check that the string is a descriptor or a numeric OID, like libldap. */
+static int
+is_oid(const char *str, Py_ssize_t len) {
+    int dot = 0;
+
+    if (len == 0) return 0;
+    if (IS_ALPHA(str[0])) {
+        for (Py_ssize_t i = 1; i < len; i++) {
+            if (!IS_LDH(str[i])) return 0;
+        }
+        return 1;
+    }
+    if (!IS_DIGIT(str[0])) return 0;
+    for (Py_ssize_t i = 1; i < len; i++) {
+        if (IS_DIGIT(str[i])) {
+            dot = 0;
+        } else if (str[i] == '.' && dot == 0) {
+            dot = 1;
+        } else {
+            return 0;
+        }
+    }
+    return !dot;
+}
+
+/* Check that the string is an attribute description: an OID followed by
+   options separated by semicolons, like libldap. */
+static int
+is_desc(const char *str, Py_ssize_t len) {
+    Py_ssize_t end = 0;
+
+    while (end < len && str[end] != ';') end++;
+    if (!is_oid(str, end)) return 0;
+    while (end < len) {
+        /* Skip the semicolon, an option is a non-empty list of LDH chars. */
+        str += end + 1;
+        len -= end + 1;
+        for (end = 0; end < len && str[end] != ';'; end++) {
+            if (!IS_LDH(str[end])) return 0;
+        }
+        if (end == 0) return 0;
+    }
+    return 1;
+}
+
+/* Append a new operation, and return its index or -1 on failure. */
+static Py_ssize_t
+add_op(filterparser *p, int type) {
+    filterop *ops = NULL;
+
+    if (p->nops == p->cap) {
+        p->cap = (p->cap == 0) ? 8 : p->cap * 2;
+        ops = (filterop *)realloc(p->ops, sizeof(filterop) * p->cap);
+        if (ops == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->ops = ops;
+    }
+    memset(&p->ops[p->nops], 0, sizeof(filterop));
+    p->ops[p->nops].type = type;
+    p->ops[p->nops].size = 1;
+    return p->nops++;
+}
+
+static char *
+copy_lowercase(const char *str, Py_ssize_t len) {
+    char *copy = (char *)malloc(len + 1);
+
+    if (copy == NULL) return NULL;
+    for (Py_ssize_t i = 0; i < len; i++) {
+        copy[i] = (char)tolower((unsigned char)str[i]);
+    }
+    copy[len] = '\0';
+    return copy;
+}
+
+/* Parse an assertion value until the closing parenthesis or the end of the
+   string, and unescape it into the buffer of the operation. If `allow_star`
+   is set, the asterisks split the value into substrings. */
+static int
+parse_value(filterparser *p, filterop *op, int allow_star) {
+    const char *str = p->str;
+    Py_ssize_t nlen = 0;
+    Py_ssize_t start = 0;
+    Py_ssize_t nsubs = 0;
+    Py_ssize_t end = p->pos;
+    char *buffer = NULL;
+    char c;
+
+    /* Count the substrings to allocate them at once. */
+    while (end < p->len && str[end] != ')') {
+        if (str[end] == '*') nsubs++;
+        if (str[end] == '\\' && end + 1 < p->len) end++;
+        end++;
+    }
+
+    buffer = (char *)malloc(end - p->pos + 1);
+    if (buffer == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    op->buffer = buffer;
+    if (allow_star && nsubs > 0) {
+        op->subs = (filterval *)calloc(nsubs + 1, sizeof(filterval));
+        if (op->subs == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    while (p->pos < end) {
+        c = str[p->pos];
+        if (c == '(' || c == '\0') {
+            return -1;
+        } else if (c == '*') {
+            if (op->subs == NULL) return -1;
+            op->subs[op->nsubs].ptr = buffer + start;
+            op->subs[op->nsubs].len = nlen - start;
+            op->nsubs++;
+            start = nlen;
+            p->pos++;
+        } else if (c == '\\') {
+            if (p->pos + 1 >= end) return -1;
+            c = str[p->pos + 1];
+            if (IS_HEX(c)) {
+                if (p->pos + 2 >= end || !IS_HEX(str[p->pos + 2])) return -1;
+                buffer[nlen++] = (char)(hex_to_int(c) * 16
+                    + hex_to_int(str[p->pos + 2]));
+                p->pos += 3;
+            } else if (c == '(' || c == ')' || c == '*' || c == '\\') {
+                /* LDAPv2 style escaping, that libldap also accepts. */
+                buffer[nlen++] = c;
+                p->pos += 2;
+            } else {
+                return -1;
+            }
+        } else {
+            buffer[nlen++] = c;
+            p->pos++;
+        }
+    }
+    buffer[nlen] = '\0';
+    if (op->subs != NULL) {
+        op->subs[op->nsubs].ptr = buffer + start;
+        op->subs[op->nsubs].len = nlen - start;
+        op->nsubs++;
+    }
+    op->value.ptr = buffer;
+    op->value.len = nlen;
+    return 0;
+}
+
+static int
+get_rule_type(const char *rule) {
+    if (rule == NULL) return RULE_NONE;
+    if (strcmp(rule, "2.5.13.2") == 0 || strcmp(rule, "caseignorematch") == 0) {
+        return RULE_CASE_IGNORE;
+    }
+    if (strcmp(rule, "2.5.13.5") == 0 || strcmp(rule, "caseexactmatch") == 0) {
+        return RULE_CASE_EXACT;
+    }
+    if (strcmp(rule, "1.2.840.113556.1.4.803") == 0) return RULE_BIT_AND;
+    if (strcmp(rule, "1.2.840.113556.1.4.804") == 0) return RULE_BIT_OR;
+    return RULE_UNKNOWN;
+}
+
+/* Parse the dn flag and the matching rule of an extensible match in the
+   form of "attr[:dn][:rule]:=value", like libldap. The attribute is
+   required without rule, and the position is at the colon after it. */
+static int
+parse_extensible(filterparser *p, Py_ssize_t idx) {
+    const char *str = p->str;
+    Py_ssize_t start[2] = {0, 0};
+    Py_ssize_t len[2] = {0, 0};
+    Py_ssize_t rule_start = 0;
+    Py_ssize_t rule_len = 0;
+    int ncomps = 0;
+    char *rule = NULL;
+
+    /* Collect the colon separated components before the ":=". */
+    p->pos++;
+    while (p->pos >= p->len || str[p->pos] != '=') {
+        if (ncomps == 2) return -1;
+        start[ncomps] = p->pos;
+        while (p->pos < p->len && str[p->pos] != ':' && str[p->pos] != '='
+                && str[p->pos] != ')') {
+            p->pos++;
+        }
+        if (p->pos >= p->len || str[p->pos] != ':') return -1;
+        len[ncomps] = p->pos - start[ncomps];
+        ncomps++;
+        p->pos++;
+    }
+    p->pos++;
+
+    if (ncomps > 0 && len[0] == 2 && tolower((unsigned char)str[start[0]]) == 'd'
+            && tolower((unsigned char)str[start[0] + 1]) == 'n') {
+        p->ops[idx].dnattrs = 1;
+        if (ncomps == 1 && p->ops[idx].attr == NULL) return -1;
+        if (ncomps == 2) {
+            rule_start = start[1];
+            rule_len = len[1];
+        }
+    } else if (ncomps == 1) {
+        rule_start = start[0];
+        rule_len = len[0];
+    } else if (ncomps == 2) {
+        return -1;
+    }
+    if (rule_len > 0) {
+        if (!is_oid(str + rule_start, rule_len)) return -1;
+        rule = copy_lowercase(str + rule_start, rule_len);
+        if (rule == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->ops[idx].rule = rule;
+    }
+    /* A matching rule is required without attribute description. */
+    if (p->ops[idx].attr == NULL && p->ops[idx].rule == NULL) return -1;
+    p->ops[idx].rule_type = get_rule_type(p->ops[idx].rule);
+    return parse_value(p, &p->ops[idx], 0);
+}
+
+/* Parse a simple, presence, substrings or extensible item. */
+static int
+parse_item(filterparser *p) {
+    const char *str = p->str;
+    Py_ssize_t idx = 0;
+    Py_ssize_t start = p->pos;
+    char *attr = NULL;
+    int type = FILTER_EQUALITY;
+
+    while (p->pos < p->len && IS_ATTRCHAR(str[p->pos])) p->pos++;
+    if (p->pos > start) {
+        if (!is_desc(str + start, p->pos - start)) goto error;
+        attr = copy_lowercase(str + start, p->pos - start);
+        if (attr == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    if (p->pos >= p->len) goto error;
+
+    switch (str[p->pos]) {
+    case ':':
+        idx = add_op(p, FILTER_EXTENSIBLE);
+        if (idx < 0) goto error;
+        p->ops[idx].attr = attr;
+        return parse_extensible(p, idx);
+    case '~':
+        type = FILTER_APPROX;
+        break;
+    case '>':
+        type = FILTER_GE;
+        break;
+    case '<':
+        type = FILTER_LE;
+        break;
+    case '=':
+        break;
+    default:
+        goto error;
+    }
+    if (attr == NULL) goto error;
+    if (type != FILTER_EQUALITY) {
+        p->pos++;
+        if (p->pos >= p->len || str[p->pos] != '=') goto error;
+    }
+    p->pos++;
+
+    if (type == FILTER_EQUALITY && p->pos < p->len && str[p->pos] == '*'
+            && (p->pos + 1 == p->len || str[p->pos + 1] == ')')) {
+        idx = add_op(p, FILTER_PRESENT);
+        if (idx < 0) goto error;
+        p->ops[idx].attr = attr;
+        p->pos++;
+        return 0;
+    }
+
+    idx = add_op(p, type);
+    if (idx < 0) goto error;
+    p->ops[idx].attr = attr;
+    if (parse_value(p, &p->ops[idx], type == FILTER_EQUALITY) != 0) return -1;
+    if (p->ops[idx].subs != NULL) p->ops[idx].type = FILTER_SUBSTRINGS;
+    return 0;
+error:
+    free(attr);
+    return -1;
+}
+
+/* Parse a filter list of an AND or OR filter. */
+static int
+parse_list(filterparser *p, int type) {
+    Py_ssize_t idx = add_op(p, type);
+
+    if (idx < 0) return -1;
+    p->pos++;
+    skip_spaces(p);
+    while (p->pos < p->len && p->str[p->pos] == '(') {
+        if (parse_filter(p) != 0) return -1;
+        skip_spaces(p);
+    }
+    p->ops[idx].size = p->nops - idx;
+    return 0;
+}
+
+static int
+parse_filter(filterparser *p) {
+    Py_ssize_t idx = 0;
+    int rc = 0;
+
+    skip_spaces(p);
+    if (p->pos >= p->len || p->str[p->pos] != '(') return -1;
+    p->pos++;
+    skip_spaces(p);
+    if (p->pos >= p->len) return -1;
+
+    switch (p->str[p->pos]) {
+    case '&':
+        rc = parse_list(p, FILTER_AND);
+        break;
+    case '|':
+        rc = parse_list(p, FILTER_OR);
+        break;
+    case '!':
+        idx = add_op(p, FILTER_NOT);
+        if (idx < 0) return -1;
+        p->pos++;
+        rc = parse_filter(p);
+        p->ops[idx].size = p->nops - idx;
+        break;
+    default:
+        rc = parse_item(p);
+    }
+    if (rc != 0) return -1;
+
+    skip_spaces(p);
+    if (p->pos >= p->len || p->str[p->pos] != ')') return -1;
+    p->pos++;
+    return 0;
+}
+
+/* Compile the filter string into the parser's operations.
+   Return 0 on success, -1 and set FilterError on failure. */
+static int
+compile_filter(filterparser *p, const char *str, Py_ssize_t len) {
+    int rc = 0;
+
+    memset(p, 0, sizeof(filterparser));
+    p->str = str;
+    p->len = len;
+
+    skip_spaces(p);
+    if (p->pos < p->len && str[p->pos] == '(') {
+        rc = parse_filter(p);
+    } else {
+        /* libldap accepts a single item without parentheses. */
+        rc = parse_item(p);
+    }
+    if (rc == 0) {
+        skip_spaces(p);
+        if (p->pos != p->len) rc = -1;
+    }
+    if (rc != 0) {
+        set_filter_error(str, p->pos);
+        free_ops(p->ops, p->nops);
+        p->ops = NULL;
+        p->nops = 0;
+        return -1;
+    }
+    return 0;
+}
+
+/* Check the syntax of a search filter before sending it to the server.
+   Return 0 if the filter is valid, -1 and set FilterError otherwise. */
+int
+validate_filter(const char *filter) {
+    filterparser parser;
+
+    if (filter == NULL || filter[0] == '\0') return 0;
+    if (compile_filter(&parser, filter, (Py_ssize_t)strlen(filter)) != 0) {
+        return -1;
+    }
+    free_ops(parser.ops, parser.nops);
+    return 0;
+}
+
+/* Compile a ValuesReturnFilter: a single simple item, or a list of them in
+   parentheses, e.g. "((cn=a*)(sn=b))". The AND, OR and NOT filters and the
+   dnAttributes of an extensible match are not allowed (see RFC 3876).
+   Return 0 on success, -1 and set FilterError on failure. */
+static int
+compile_vr_filter(filterparser *p, const char *str, Py_ssize_t len) {
+    int rc = 0;
+    Py_ssize_t start = 0;
+
+    memset(p, 0, sizeof(filterparser));
+    p->str = str;
+    p->len = len;
+
+    skip_spaces(p);
+    start = p->pos;
+    if (p->pos < p->len && str[p->pos] == '(') {
+        p->pos++;
+        skip_spaces(p);
+    }
+    if (p->pos < p->len && p->pos > start && str[p->pos] == '(') {
+        while (rc == 0 && p->pos < p->len && str[p->pos] == '(') {
+            rc = parse_filter(p);
+            skip_spaces(p);
+        }
+        if (rc == 0 && (p->pos >= p->len || str[p->pos] != ')')) rc = -1;
+        if (rc == 0) p->pos++;
+    } else {
+        p->pos = start;
+        rc = parse_filter(p);
+    }
+    if (rc == 0) {
+        skip_spaces(p);
+        if (p->pos != p->len) rc = -1;
+    }
+    for (Py_ssize_t i = 0; rc == 0 && i < p->nops; i++) {
+        if (p->ops[i].type == FILTER_AND || p->ops[i].type == FILTER_OR
+                || p->ops[i].type == FILTER_NOT
+                || (p->ops[i].type == FILTER_EXTENSIBLE
+                    && ((p->ops[i].attr == NULL && p->ops[i].rule == NULL)
+                        || p->ops[i].dnattrs))) {
+            p->pos = 0;
+            rc = -1;
+        }
+    }
+    if (rc != 0) {
+        set_filter_error(str, p->pos);
+        free_ops(p->ops, p->nops);
+        p->ops = NULL;
+        p->nops = 0;
+        return -1;
+    }
+    return 0;
+}
+
+/* Encode a simple filter item with the tags of RFC 4511. */
+static int
+encode_filter_item(BerElement *ber, filterop *op) {
+    int rc = 0;
+    filterval *sub = NULL;
+
+    switch (op->type) {
+    case FILTER_EQUALITY:
+    case FILTER_APPROX:
+    case FILTER_GE:
+    case FILTER_LE:
+        rc = ber_printf(ber, "t{oo}", (ber_tag_t)(op->type == FILTER_EQUALITY
+            ? 0xa3 : op->type == FILTER_APPROX ? 0xa8
+            : op->type == FILTER_GE ? 0xa5 : 0xa6), op->attr,
+            (ber_len_t)strlen(op->attr), op->value.ptr, (ber_len_t)op->value.len);
+        break;
+    case FILTER_PRESENT:
+        rc = ber_printf(ber, "to", (ber_tag_t)0x87, op->attr,
+            (ber_len_t)strlen(op->attr));
+        break;
+    case FILTER_SUBSTRINGS:
+        rc = ber_printf(ber, "t{o{", (ber_tag_t)0xa4, op->attr,
+            (ber_len_t)strlen(op->attr));
+        for (Py_ssize_t i = 0; rc != -1 && i < op->nsubs; i++) {
+            sub = &op->subs[i];
+            if (sub->len == 0) continue;
+            /* Initial [0], any [1] and final [2] substrings. */
+            rc = ber_printf(ber, "to", (ber_tag_t)(i == 0 ? 0x80
+                : i == op->nsubs - 1 ? 0x82 : 0x81), sub->ptr,
+                (ber_len_t)sub->len);
+        }
+        if (rc != -1) rc = ber_printf(ber, "}}");
+        break;
+    case FILTER_EXTENSIBLE:
+        /* SimpleMatchingAssertion of RFC 3876, without dnAttributes. */
+        rc = ber_printf(ber, "t{", (ber_tag_t)0xa9);
+        if (rc != -1 && op->rule != NULL) {
+            rc = ber_printf(ber, "to", (ber_tag_t)0x81, op->rule,
+                (ber_len_t)strlen(op->rule));
+        }
+        if (rc != -1 && op->attr != NULL) {
+            rc = ber_printf(ber, "to", (ber_tag_t)0x82, op->attr,
+                (ber_len_t)strlen(op->attr));
+        }
+        if (rc != -1) {
+            rc = ber_printf(ber, "to", (ber_tag_t)0x83, op->value.ptr,
+                (ber_len_t)op->value.len);
+        }
+        if (rc != -1) rc = ber_printf(ber, "}");
+        break;
+    default:
+        rc = -1;
+    }
+    return rc == -1 ? -1 : 0;
+}
+
+/* Encode the ValuesReturnFilter of the matched values control (RFC 3876).
+   The caller has to free the `value` with ber_bvfree. Return 0 on success,
+   -1 and set an exception on failure. */
+int
+encode_values_return_filter(const char *filter, struct berval **value) {
+    int rc = 0;
+    filterparser parser;
+    BerElement *ber = NULL;
+    PyObject *error = NULL;
+
+    if (compile_vr_filter(&parser, filter, (Py_ssize_t)strlen(filter)) != 0) {
+        return -1;
+    }
+
+    ber = ber_alloc_t(LBER_USE_DER);
+    if (ber == NULL) {
+        free_ops(parser.ops, parser.nops);
+        PyErr_NoMemory();
+        return -1;
+    }
+    rc = ber_printf(ber, "{");
+    for (Py_ssize_t i = 0; rc != -1 && i < parser.nops; i++) {
+        rc = encode_filter_item(ber, &parser.ops[i]);
+    }
+    if (rc != -1) rc = ber_printf(ber, "}");
+    if (rc != -1) rc = ber_flatten(ber, value);
+    ber_free(ber, 1);
+    free_ops(parser.ops, parser.nops);
+    if (rc != 0) {
+        error = get_error_by_code(LDAP_ENCODING_ERROR);
+        if (error == NULL) return -1;
+        PyErr_SetString(error, "Failed to encode the values return filter.");
+        Py_DECREF(error);
+        return -1;
+    }
+    return 0;
+}
+
+/* Compare two strings in a case-insensitive manner, like memcmp. */
+static int
+ci_compare(const char *str1, Py_ssize_t len1, const char *str2, Py_ssize_t len2) {
+    int diff = 0;
+    Py_ssize_t len = (len1 < len2) ? len1 : len2;
+
+    for (Py_ssize_t i = 0; i < len; i++) {
+        diff = tolower((unsigned char)str1[i]) - tolower((unsigned char)str2[i]);
+        if (diff != 0) return diff;
+    }
+    if (len1 == len2) return 0;
+    return (len1 < len2) ? -1 : 1;
+}
+
+static Py_ssize_t
+ci_find(const char *str, Py_ssize_t len, Py_ssize_t start, filterval *sub) {
+    for (Py_ssize_t i = start; i + sub->len <= len; i++) {
+        if (ci_compare(str + i, sub->len, sub->ptr, sub->len) == 0) return i;
+    }
+    return -1;
+}
+
+static int
+parse_integer(const char *str, Py_ssize_t len, long long *result) {
+    Py_ssize_t i = 0;
+    long long value = 0;
+    int neg = 0;
+
+    if (len > 0 && str[0] == '-') {
+        neg = 1;
+        i++;
+    }
+    if (i == len || len - i > 18) return -1;
+    for (; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') return -1;
+        value = value * 10 + (str[i] - '0');
+    }
+    *result = neg ? -value : value;
+    return 0;
+}
+
+/* Get the string representation of an attribute value as it is sent to
+   the server. A temporary object might be created for the buffer. */
+static int
+get_value_buffer(PyObject *obj, const char **ptr, Py_ssize_t *len,
+        PyObject **tmp) {
+    char *buf = NULL;
+
+    *tmp = NULL;
+    if (PyBool_Check(obj)) {
+        /* Python boolean converting to TRUE or FALSE (see RFC4517 3.3.3). */
+        *ptr = (obj == Py_True) ? "TRUE" : "FALSE";
+        *len = (obj == Py_True) ? 4 : 5;
+        return 0;
+    }
+    if (PyBytes_Check(obj)) {
+        if (PyBytes_AsStringAndSize(obj, &buf, len) != 0) return -1;
+        *ptr = buf;
+        return 0;
+    }
+    if (!PyUnicode_Check(obj)) {
+        *tmp = PyObject_Str(obj);
+        if (*tmp == NULL) return -1;
+        obj = *tmp;
+    }
+    *ptr = PyUnicode_AsUTF8AndSize(obj, len);
+    if (*ptr == NULL) {
+        Py_CLEAR(*tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+match_substrings(filterop *op, const char *str, Py_ssize_t len) {
+    Py_ssize_t pos = 0;
+    filterval *initial = &op->subs[0];
+    filterval *final = &op->subs[op->nsubs - 1];
+
+    if (initial->len + final->len > len) return 0;
+    if (ci_compare(str, initial->len, initial->ptr, initial->len) != 0) return 0;
+    if (ci_compare(str + len - final->len, final->len, final->ptr,
+            final->len) != 0) {
+        return 0;
+    }
+    pos = initial->len;
+    len -= final->len;
+    for (Py_ssize_t i = 1; i < op->nsubs - 1; i++) {
+        if (op->subs[i].len == 0) continue;
+        pos = ci_find(str, len, pos, &op->subs[i]);
+        if (pos < 0) return 0;
+        pos += op->subs[i].len;
+    }
+    return 1;
+}
+
+/* Match an attribute value against the assertion of the operation.
+   Return 1 if it's matched, 0 if it's not, and -1 on error. */
+static int
+match_value(filterop *op, PyObject *obj) {
+    int rc = 0;
+    int cmp = 0;
+    const char *str = NULL;
+    Py_ssize_t len = 0;
+    long long val = 0;
+    long long asrt = 0;
+    PyObject *tmp = NULL;
+
+    if (get_value_buffer(obj, &str, &len, &tmp) != 0) return -1;
+
+    switch (op->type) {
+    case FILTER_EQUALITY:
+    case FILTER_APPROX:
+        rc = (ci_compare(str, len, op->value.ptr, op->value.len) == 0);
+        break;
+    case FILTER_GE:
+    case FILTER_LE:
+        if (parse_integer(str, len, &val) == 0
+                && parse_integer(op->value.ptr, op->value.len, &asrt) == 0) {
+            cmp = (val > asrt) - (val < asrt);
+        } else {
+            cmp = ci_compare(str, len, op->value.ptr, op->value.len);
+        }
+        rc = (op->type == FILTER_GE) ? (cmp >= 0) : (cmp <= 0);
+        break;
+    case FILTER_SUBSTRINGS:
+        rc = match_substrings(op, str, len);
+        break;
+    case FILTER_EXTENSIBLE:
+        switch (op->rule_type) {
+        case RULE_CASE_EXACT:
+            rc = (len == op->value.len && memcmp(str, op->value.ptr, len) == 0);
+            break;
+        case RULE_BIT_AND:
+        case RULE_BIT_OR:
+            if (parse_integer(str, len, &val) != 0
+                    || parse_integer(op->value.ptr, op->value.len, &asrt) != 0) {
+                rc = 0;
+            } else if (op->rule_type == RULE_BIT_AND) {
+                rc = ((val & asrt) == asrt);
+            } else {
+                rc = ((val & asrt) != 0);
+            }
+            break;
+        default:
+            rc = (ci_compare(str, len, op->value.ptr, op->value.len) == 0);
+        }
+        break;
+    }
+    Py_XDECREF(tmp);
+    return rc;
+}
+
+/* Check that the key of the entry is the attribute of the operation. If the
+   filter's attribute has no options, the key's options are ignored. */
+static int
+match_attribute(filterop *op, PyObject *key) {
+    const char *str = NULL;
+    Py_ssize_t len = 0;
+    Py_ssize_t attrlen = 0;
+
+    if (!PyUnicode_Check(key)) return 0;
+    str = PyUnicode_AsUTF8AndSize(key, &len);
+    if (str == NULL) return -1;
+    if (len == 2 && ci_compare(str, len, "dn", 2) == 0) return 0;
+    if (op->attr == NULL) return 1;
+    attrlen = (Py_ssize_t)strlen(op->attr);
+    if (strchr(op->attr, ';') == NULL) {
+        for (Py_ssize_t i = 0; i < len; i++) {
+            if (str[i] == ';') {
+                len = i;
+                break;
+            }
+        }
+    }
+    return (ci_compare(str, len, op->attr, attrlen) == 0);
+}
+
+/* Match the values of the entry's attributes against the operation. */
+static int
+match_attributes(filterop *op, PyObject *entry) {
+    int rc = 0;
+    Py_ssize_t pos = 0;
+    PyObject *key = NULL;
+    PyObject *values = NULL;
+    PyObject *seq = NULL;
+
+    while (PyDict_Next(entry, &pos, &key, &values)) {
+        rc = match_attribute(op, key);
+        if (rc != 1) {
+            if (rc < 0) return -1;
+            continue;
+        }
+        if (op->type == FILTER_PRESENT) return 1;
+        if (PyList_Check(values) || PyTuple_Check(values)) {
+            seq = PySequence_Fast(values, "");
+            if (seq == NULL) return -1;
+            for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+                rc = match_value(op, PySequence_Fast_GET_ITEM(seq, i));
+                if (rc != 0) break;
+            }
+            Py_DECREF(seq);
+        } else {
+            rc = match_value(op, values);
+        }
+        if (rc != 0) return rc;
+    }
+    return 0;
+}
+
+/* Evaluate the operation at `idx` on the entry.
+   Return 1 if it's matched, 0 if it's not, and -1 on error. */
+static int
+evaluate(filterop *ops, Py_ssize_t idx, PyObject *entry) {
+    int rc = 0;
+    Py_ssize_t child = 0;
+    filterop *op = &ops[idx];
+
+    switch (op->type) {
+    case FILTER_AND:
+    case FILTER_OR:
+        for (child = idx + 1; child < idx + op->size; child += ops[child].size) {
+            rc = evaluate(ops, child, entry);
+            if (rc < 0) return -1;
+            if (op->type == FILTER_AND && rc == 0) return 0;
+            if (op->type == FILTER_OR && rc == 1) return 1;
+        }
+        /* Absolute true and false filters of RFC 4526 without children. */
+        return (op->type == FILTER_AND);
+    case FILTER_NOT:
+        rc = evaluate(ops, idx + 1, entry);
+        return (rc < 0) ? -1 : !rc;
+    case FILTER_PRESENT:
+        /* Every entry has an objectClass. */
+        if (strcmp(op->attr, "objectclass") == 0) return 1;
+        return match_attributes(op, entry);
+    case FILTER_EXTENSIBLE:
+        if (op->rule_type == RULE_UNKNOWN) {
+            PyErr_Format(PyExc_ValueError,
+                "The %s matching rule can't be evaluated locally.", op->rule);
+            return -1;
+        }
+        return match_attributes(op, entry);
+    default:
+        return match_attributes(op, entry);
+    }
+}
+
+static PyObject *
+create_value_bytes(filterval *val) {
+    return PyBytes_FromStringAndSize(val->ptr, val->len);
+}
+
+/* Build the nested tuple representation of the node at `idx`. */
+static PyObject *
+build_tree(filterop *ops, Py_ssize_t idx) {
+    PyObject *children = NULL;
+    PyObject *child = NULL;
+    PyObject *tree = NULL;
+    filterop *op = &ops[idx];
+    static const char *names[] = {"&", "|", "!", "=", "~=", ">=", "<=", "=*",
+        "*", ":="};
+
+    switch (op->type) {
+    case FILTER_AND:
+    case FILTER_OR:
+        children = PyList_New(0);
+        if (children == NULL) return NULL;
+        for (Py_ssize_t i = idx + 1; i < idx + op->size; i += ops[i].size) {
+            child = build_tree(ops, i);
+            if (child == NULL || PyList_Append(children, child) != 0) {
+                Py_XDECREF(child);
+                Py_DECREF(children);
+                return NULL;
+            }
+            Py_DECREF(child);
+        }
+        tree = Py_BuildValue("(sN)", names[op->type], children);
+        break;
+    case FILTER_NOT:
+        child = build_tree(ops, idx + 1);
+        if (child == NULL) return NULL;
+        tree = Py_BuildValue("(sN)", names[op->type], child);
+        break;
+    case FILTER_PRESENT:
+        tree = Py_BuildValue("(ss)", names[op->type], op->attr);
+        break;
+    case FILTER_SUBSTRINGS:
+        children = PyList_New(0);
+        if (children == NULL) return NULL;
+        for (Py_ssize_t i = 1; i < op->nsubs - 1; i++) {
+            if (op->subs[i].len == 0) continue;
+            child = create_value_bytes(&op->subs[i]);
+            if (child == NULL || PyList_Append(children, child) != 0) {
+                Py_XDECREF(child);
+                Py_DECREF(children);
+                return NULL;
+            }
+            Py_DECREF(child);
+        }
+        tree = Py_BuildValue("(ssy#Ny#)", names[op->type], op->attr,
+            op->subs[0].len ? op->subs[0].ptr : NULL, op->subs[0].len,
+            children, op->subs[op->nsubs - 1].len ? op->subs[op->nsubs - 1].ptr
+            : NULL, op->subs[op->nsubs - 1].len);
+        break;
+    case FILTER_EXTENSIBLE:
+        tree = Py_BuildValue("(szzOy#)", names[op->type], op->attr, op->rule,
+            op->dnattrs ? Py_True : Py_False, op->value.ptr, op->value.len);
+        break;
+    default:
+        tree = Py_BuildValue("(ssy#)", names[op->type], op->attr,
+            op->value.ptr, op->value.len);
+    }
+    return tree;
+}
+
+/* Dealloc the LDAPFilter object. */
+static void
+ldapfilter_dealloc(LDAPFilter *self) {
+    Py_XDECREF(self->strfilter);
+    free_ops(self->ops, self->nops);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/* Create a new LDAPFilter object. */
+static PyObject *
+ldapfilter_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    LDAPFilter *self = NULL;
+
+    self = (LDAPFilter *)type->tp_alloc(type, 0);
+    if (self != NULL) {
+        self->strfilter = NULL;
+        self->ops = NULL;
+        self->nops = 0;
+    }
+    return (PyObject *)self;
+}
+
+/* Compile the filter string of the LDAPFilter object. */
+static int
+ldapfilter_init(LDAPFilter *self, PyObject *args, PyObject *kwds) {
+    PyObject *strfilter = NULL;
+    const char *str = NULL;
+    Py_ssize_t len = 0;
+    filterparser parser;
+    static char *kwlist[] = {"filter_exp", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "U", kwlist, &strfilter)) {
+        return -1;
+    }
+
+    str = PyUnicode_AsUTF8AndSize(strfilter, &len);
+    if (str == NULL) return -1;
+    if (compile_filter(&parser, str, len) != 0) return -1;
+
+    free_ops(self->ops, self->nops);
+    self->ops = parser.ops;
+    self->nops = parser.nops;
+    Py_INCREF(strfilter);
+    Py_XSETREF(self->strfilter, strfilter);
+    return 0;
+}
+
+/* Check that the entry matches the filter. */
+static PyObject *
+ldapfilter_match(LDAPFilter *self, PyObject *entry) {
+    int rc = 0;
+
+    if (!PyDict_Check(entry)) {
+        PyErr_SetString(PyExc_TypeError,
+            "The entry must be an LDAPEntry or a dict.");
+        return NULL;
+    }
+    if (self->ops == NULL) {
+        PyErr_SetString(PyExc_ValueError, "The filter is not compiled.");
+        return NULL;
+    }
+    rc = evaluate(self->ops, 0, entry);
+    if (rc < 0) return NULL;
+    return PyBool_FromLong(rc);
+}
+
+/* Return the compiled filter as nested tuples. */
+static PyObject *
+ldapfilter_tree(LDAPFilter *self) {
+    if (self->ops == NULL) {
+        PyErr_SetString(PyExc_ValueError, "The filter is not compiled.");
+        return NULL;
+    }
+    return build_tree(self->ops, 0);
+}
+
+static PyObject *
+ldapfilter_str(LDAPFilter *self) {
+    if (self->strfilter == NULL) return PyUnicode_FromString("");
+    Py_INCREF(self->strfilter);
+    return self->strfilter;
+}
+
+static PyMethodDef ldapfilter_methods[] = {
+    {"match", (PyCFunction)ldapfilter_match, METH_O,
+        "Check that the entry matches the filter."},
+    {"_tree", (PyCFunction)ldapfilter_tree, METH_NOARGS,
+        "Return the compiled filter as nested tuples."},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject LDAPFilterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_bonsai.ldapfilter",      /* tp_name */
+    sizeof(LDAPFilter),        /* tp_basicsize */
+    0,                         /* tp_itemsize */
+    (destructor)ldapfilter_dealloc, /* tp_dealloc */
+    0,                         /* tp_print */
+    0,                         /* tp_getattr */
+    0,                         /* tp_setattr */
+    0,                         /* tp_reserved */
+    0,                         /* tp_repr */
+    0,                         /* tp_as_number */
+    0,                         /* tp_as_sequence */
+    0,                         /* tp_as_mapping */
+    0,                         /* tp_hash  */
+    0,                         /* tp_call */
+    (reprfunc)ldapfilter_str,  /* tp_str */
+    0,                         /* tp_getattro */
+    0,                         /* tp_setattro */
+    0,                         /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT |
+        Py_TPFLAGS_BASETYPE,   /* tp_flags */
+    "ldapfilter object",       /* tp_doc */
+    0,                         /* tp_traverse */
+    0,                         /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,                         /* tp_weaklistoffset */
+    0,                         /* tp_iter */
+    0,                         /* tp_iternext */
+    ldapfilter_methods,        /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)ldapfilter_init, /* tp_init */
+    0,                         /* tp_alloc */
+    ldapfilter_new,            /* tp_new */
+};
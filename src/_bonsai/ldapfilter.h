@@ -0,0 +1,24 @@
+#ifndef LDAPFILTER_H_
+#define LDAPFILTER_H_
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+
+typedef struct filterop filterop;
+struct berval;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *strfilter;
+    /* The compiled filter: the operations of the nodes in prefix order. */
+    filterop *ops;
+    Py_ssize_t nops;
+} LDAPFilter;
+
+extern PyTypeObject LDAPFilterType;
+
+int validate_filter(const char *filter);
+int encode_values_return_filter(const char *filter, struct berval **value);
+
+#endif /* LDAPFILTER_H_ */
@@ -1,12 +1,27 @@
 #include "ldapsearchiter.h"
 #include "ldapconnection.h"
 
+/* Release the server-side state of a paged search, that is dropped before
+   its last page is acquired, by abandoning its last page request. Nothing
+   is sent on a closed connection. */
+static void
+release_paged_search(LDAPSearchIter *self) {
+    if (self->conn == NULL || self->conn->closed || self->conn->ld == NULL) return;
+    if (self->page_size <= 0 || self->msgid <= 0 || self->cookie == NULL
+            || self->cookie->bv_val == NULL || self->cookie->bv_len == 0) return;
+
+    DEBUG("release_paged_search (self:%p) msgid:%d", self, self->msgid);
+    ldap_abandon_ext(self->conn->ld, self->msgid, NULL, NULL);
+}
+
 /* Dealloc the LDAPSearchIter object. */
 static void
 ldapsearchiter_dealloc(LDAPSearchIter* self) {
     DEBUG("ldapsearchiter_dealloc (self:%p)", self);
+    release_paged_search(self);
     Py_XDECREF(self->buffer);
     Py_XDECREF(self->conn);
+    Py_XDECREF(self->dn_table);
 
     free_search_params(self->params);
 
@@ -16,8 +31,20 @@ ldapsearchiter_dealloc(LDAPSearchIter* self) {
             free(self->vlv_info->ldvlv_attrvalue->bv_val);
             free(self->vlv_info->ldvlv_attrvalue);
         }
+        if (self->vlv_info->ldvlv_context != NULL) {
+            free(self->vlv_info->ldvlv_context->bv_val);
+            free(self->vlv_info->ldvlv_context);
+        }
         free(self->vlv_info);
     }
+    if (self->sync_cookie != NULL) {
+        free(self->sync_cookie->bv_val);
+        free(self->sync_cookie);
+    }
+    if (self->dirsync_cookie != NULL) {
+        free(self->dirsync_cookie->bv_val);
+        free(self->dirsync_cookie);
+    }
     free(self->cookie);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
@@ -33,9 +60,21 @@ ldapsearchiter_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
         self->buffer = NULL;
         self->cookie = NULL;
         self->page_size = 0;
+        self->msgid = 0;
         self->params = NULL;
         self->vlv_info = NULL;
+        self->dn_table = NULL;
         self->auto_acquire = 0;
+        self->sync_mode = 0;
+        self->sync_cookie = NULL;
+        self->sync_reload_hint = 0;
+        self->dirsync = 0;
+        self->dirsync_flags = 0;
+        self->dirsync_max_bytes = 0;
+        self->dirsync_cookie = NULL;
+        self->notify_mode = 0;
+        self->psearch_types = 0;
+        self->psearch_changes_only = 0;
     }
 
     DEBUG("ldapsearchiter_new [self:%p]", self);
@@ -145,21 +184,19 @@ ldapsearchiter_len(LDAPSearchIter *self) {
     return PyObject_Size(self->buffer);
 }
 
+/* Return with the asynchronous iterator of the connection,
+   that prefetches the pages of the search. */
 static PyObject *
-ldapsearchiter_anext(LDAPSearchIter *self) {
-    PyObject *res = NULL;
-
-    DEBUG("ldapsearchiter_anext (self:%p)", self);
-    res = PyObject_CallMethod((PyObject *)self->conn, "_search_iter_anext",
+ldapsearchiter_aiter(LDAPSearchIter *self) {
+    DEBUG("ldapsearchiter_aiter (self:%p)", self);
+    return PyObject_CallMethod((PyObject *)self->conn, "_search_iter_aiter",
                         "(O)", (PyObject *)self);
-
-    return res;
 }
 
 static PyAsyncMethods ldapsearchiter_async = {
     0,                         /* am_await */
-    (unaryfunc)ldapsearchiter_getiter,  /* am_aiter */
-    (unaryfunc)ldapsearchiter_anext  /* am_anext */
+    (unaryfunc)ldapsearchiter_aiter,  /* am_aiter */
+    0                          /* am_anext */
 };
 
 static PySequenceMethods ldapsearchiter_sequence = {
@@ -14,8 +14,24 @@ typedef struct {
     ldapsearchparams *params;
     struct berval *cookie;
     int page_size;
+    /* Message ID of the last search request, 0 if there's none. */
+    int msgid;
     LDAPVLVInfo *vlv_info;
+    PyObject *dn_table;
     char auto_acquire;
+    /* Mode, cookie and reload hint of the content synchronization. */
+    int sync_mode;
+    struct berval *sync_cookie;
+    char sync_reload_hint;
+    /* Flags, size limit and cookie of the Active Directory DirSync. */
+    char dirsync;
+    unsigned int dirsync_flags;
+    int dirsync_max_bytes;
+    struct berval *dirsync_cookie;
+    /* Change notification mode, and the settings of a persistent search. */
+    int notify_mode;
+    int psearch_types;
+    char psearch_changes_only;
 } LDAPSearchIter;
 
 extern PyTypeObject LDAPSearchIterType;
@@ -529,7 +529,7 @@ close_socketpair(PyObject *tup) {
 int
 set_search_params(ldapsearchparams *params, char **attrs, int attrsonly,
         char *base, char *filter, int len, int scope, int sizelimit, double timeout, 
-        LDAPSortKey **sort_list) {
+        LDAPSortKey **sort_list, char *asq_attr, struct berval *vr_filter) {
 
     params->attrs = attrs;
     params->attrsonly = attrsonly;
@@ -551,6 +551,18 @@ set_search_params(ldapsearchparams *params, char **attrs, int attrsonly,
     params->timeout = timeout;
 
     params->sort_list = sort_list;
+    params->vr_filter = vr_filter;
+
+    if (asq_attr == NULL) {
+        params->asq_attr = NULL;
+    } else {
+        params->asq_attr = (char *)malloc(sizeof(char) * (strlen(asq_attr)+1));
+        if (params->asq_attr == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        strcpy(params->asq_attr, asq_attr);
+    }
 
     return 0;
 }
@@ -563,6 +575,8 @@ free_search_params(ldapsearchparams *params) {
     if (params != NULL) {
         free(params->base);
         free(params->filter);
+        free(params->asq_attr);
+        if (params->vr_filter != NULL) ber_bvfree(params->vr_filter);
         if (params->attrs != NULL) {
             for (i = 0; params->attrs[i] != NULL; i++) {
                 free(params->attrs[i]);
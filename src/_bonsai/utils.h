@@ -16,6 +16,10 @@ typedef struct {
     int attrsonly;
     int sizelimit;
     LDAPSortKey **sort_list;
+    /* Source attribute of an attribute scoped query or NULL. */
+    char *asq_attr;
+    /* Encoded ValuesReturnFilter of the matched values control or NULL. */
+    struct berval *vr_filter;
 } ldapsearchparams;
 
 extern PyObject *LDAPDNObj;
@@ -49,7 +53,7 @@ int get_socketpair(PyObject **tup, SOCKET *csock, SOCKET *ssock);
 void close_socketpair(PyObject *tup);
 int set_search_params(ldapsearchparams *params, char **attrs, int attrsonly,
         char *base, char *filter, int len, int scope, int sizelimit, double timeout,
-        LDAPSortKey **sort_list);
+        LDAPSortKey **sort_list, char *asq_attr, struct berval *vr_filter);
 void free_search_params(ldapsearchparams *params);
 int create_ppolicy_control(LDAP *ld, LDAPControl **returned_ctrls,
         PyObject **ctrl_obj,  unsigned int *pperr);
@@ -377,6 +377,31 @@ end:
     return rc;
 }
 
+int
+ldap_compare_extU(LDAP *ld, char *dn, char *attr, struct berval *bvalue, LDAPControlA **sctrls, LDAPControlA **cctrls, int *msgidp) {
+    int rc = 0;
+    wchar_t *wdn = NULL;
+    wchar_t *wattr = NULL;
+    LDAPControlW **wsctrls = NULL;
+    LDAPControlW **wcctrls = NULL;
+
+    if (rc = convert_to_wcs(dn, &wdn) != LDAP_SUCCESS) goto end;
+    if (rc = convert_to_wcs(attr, &wattr) != LDAP_SUCCESS) goto end;
+    if (rc = convert_ctrl_list(sctrls, &wsctrls) != LDAP_SUCCESS) goto end;
+    if (rc = convert_ctrl_list(cctrls, &wcctrls) != LDAP_SUCCESS) goto end;
+
+    /* The value is passed as binary data, the string value is ignored. */
+    rc = ldap_compare_extW(ld, wdn, wattr, NULL, bvalue, wsctrls, wcctrls, msgidp);
+
+end:
+    free(wdn);
+    free(wattr);
+    free_list((void **)wsctrls, (void *)free_ctrl);
+    free_list((void **)wcctrls, (void *)free_ctrl);
+
+    return rc;
+}
+
 char *
 ldap_first_attributeU(LDAP *ld, LDAPMessage *entry, BerElement **ber) {
     char *attr = NULL;
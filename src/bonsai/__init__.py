@@ -4,9 +4,12 @@ from .ldapconnection import LDAPConnection
 from .ldapconnection import LDAPSearchScope
 from .ldapentry import LDAPEntry
 from .ldapentry import LDAPModOp
+from .ldapfilter import LDAPFilter
 from .ldapclient import LDAPClient
 from .ldapreference import LDAPReference
 from .ldapvaluelist import LDAPValueList
+from .vlvcursor import VLVCursor
+from .searchcache import SearchCache
 from .ldif import LDIFError, LDIFReader, LDIFWriter
 from .errors import *
 from .utils import *
@@ -18,11 +21,14 @@ __all__ = [
     "LDAPConnection",
     "LDAPDN",
     "LDAPEntry",
+    "LDAPFilter",
     "LDAPModOp",
     "LDAPReference",
     "LDAPSearchScope",
     "LDAPURL",
     "LDAPValueList",
+    "VLVCursor",
+    "SearchCache",
     "LDIFError",
     "LDIFReader",
     "LDIFWriter",
@@ -42,7 +48,9 @@ __all__ = [
     "UnwillingToPerform",
     "NoSuchObjectError",
     "AffectsMultipleDSA",
+    "FilterError",
     "SizeLimitError",
+    "SyncRefreshRequired",
     "NotAllowedOnNonleaf",
     "NoSuchAttribute",
     "TypeOrValueExists",
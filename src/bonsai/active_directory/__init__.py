@@ -4,6 +4,7 @@ from typing import Dict, Optional, Union
 
 from .sid import SID
 from .acl import ACL, ACLRevision, ACE, ACEFlag, ACERight, ACEType
+from .dirsync import DirSync, DirSyncChange, DirSyncFlag
 
 
 class SecurityDescriptor:
@@ -357,6 +358,9 @@ __all__ = [
     "ACEType",
     "ACL",
     "ACLRevision",
+    "DirSync",
+    "DirSyncChange",
+    "DirSyncFlag",
     "SecurityDescriptor",
     "SID",
     "UserAccountControl",
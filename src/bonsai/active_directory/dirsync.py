@@ -0,0 +1,178 @@
+from enum import IntFlag
+from typing import Any, AsyncIterator, Dict, Iterator, List, NamedTuple, Optional, Union
+
+from ..ldapdn import LDAPDN
+from ..ldapentry import LDAPEntry
+from ..utils import _read_cookie, _write_cookie
+
+MYPY = False
+
+if MYPY:
+    from ..ldapconnection import BaseLDAPConnection
+
+
+class DirSyncFlag(IntFlag):
+    """ The flags of the DirSync control. """
+
+    #: Return only the objects and attributes that are accessible to the
+    #: user, without requiring the replicating directory changes right.
+    OBJECT_SECURITY = 0x00000001
+    #: Return the parent objects before their children.
+    ANCESTORS_FIRST_ORDER = 0x00000800
+    #: Do not return the private data in the search results.
+    PUBLIC_DATA_ONLY = 0x00002000
+    #: Return only the changed values of the linked multi-valued
+    #: attributes (e.g. member) instead of every value.
+    INCREMENTAL_VALUES = 0x80000000
+
+
+class DirSyncChange(NamedTuple):
+    """
+    A changed object. The `entry` has the changed attributes with their
+    current values, the changes of the linked attributes are listed in
+    the `added` and `removed` dicts by the attribute names, if the
+    incremental values are requested.
+    """
+
+    entry: LDAPEntry
+    deleted: bool
+    added: Dict[str, List[Any]]
+    removed: Dict[str, List[Any]]
+
+
+class DirSync:
+    """
+    Incremental change tracking with the Active Directory DirSync control.
+    The first request returns every object under the `base`, the later
+    ones only the objects and attributes that have changed since the
+    previous request. The cookie of the last received state is passed on
+    between the requests, and if `cookie_path` is set, it is also loaded
+    from and saved to that file.
+
+    The `base` has to be the root of a naming context, and the search
+    requires the replicating directory changes right, unless the
+    :attr:`DirSyncFlag.OBJECT_SECURITY` flag is set.
+
+    :param conn: the connection.
+    :param str|LDAPDN base: the root of the naming context.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param int flags: the :class:`DirSyncFlag` flags of the control.
+    :param int max_bytes: the maximal size of a response in bytes.
+    :param bytes cookie: the cookie of a previous request.
+    :param str cookie_path: path of the file that keeps the cookie.
+    """
+
+    def __init__(
+        self,
+        conn: "BaseLDAPConnection",
+        base: Optional[Union[str, LDAPDN]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        flags: int = DirSyncFlag.INCREMENTAL_VALUES,
+        max_bytes: int = 0x100000,
+        cookie: Optional[bytes] = None,
+        cookie_path: Optional[str] = None,
+    ) -> None:
+        self.__conn = conn
+        self.__base = base
+        self.__filter_exp = filter_exp
+        self.__attrlist = attrlist
+        self.__flags = int(flags)
+        self.__max_bytes = max_bytes
+        self.__cookie_path = cookie_path
+        if cookie is None and cookie_path is not None:
+            cookie = _read_cookie(cookie_path)
+        self.__cookie = cookie
+
+    @property
+    def cookie(self) -> Optional[bytes]:
+        """ The cookie of the last received state. """
+        return self.__cookie
+
+    def changes(self, timeout: Optional[float] = None) -> Iterator[DirSyncChange]:
+        """
+        Get the changes since the last request. The server splits the
+        changes into several responses, that are requested one after the
+        other. The cookie is updated after every change of a response is
+        yielded, thus an interrupted iteration is continued from the
+        beginning of the last response.
+
+        :param float timeout: time limit in seconds for each request.
+        :return: iterator of the changes.
+        """
+        more_results = True
+        while more_results:
+            msg_id = self.__request(timeout)
+            entries, ctrl = self.__conn._evaluate(msg_id, timeout)
+            for entry in entries:
+                yield self.__create_change(entry)
+            more_results = self.__update(ctrl)
+
+    async def changes_async(
+        self, timeout: Optional[float] = None
+    ) -> AsyncIterator[DirSyncChange]:
+        """
+        The same as :meth:`changes` for asynchronous connections.
+
+        :param float timeout: time limit in seconds for each request.
+        :return: asynchronous iterator of the changes.
+        """
+        more_results = True
+        while more_results:
+            msg_id = self.__request(timeout)
+            entries, ctrl = await self.__conn._evaluate(msg_id, timeout)
+            for entry in entries:
+                yield self.__create_change(entry)
+            more_results = self.__update(ctrl)
+
+    def __request(self, timeout: Optional[float]) -> int:
+        return self.__conn._search_request(
+            self.__base,
+            2,
+            self.__filter_exp,
+            self.__attrlist,
+            timeout,
+            dirsync_flags=self.__flags,
+            dirsync_max_bytes=self.__max_bytes,
+            dirsync_cookie=self.__cookie,
+        )
+
+    def __update(self, ctrl: Dict[str, Any]) -> bool:
+        cookie = ctrl["cookie"]
+        if cookie is not None and cookie != self.__cookie:
+            self.__cookie = cookie
+            if self.__cookie_path is not None:
+                _write_cookie(self.__cookie_path, cookie)
+        return ctrl["more_results"]
+
+    @staticmethod
+    def __create_change(entry: LDAPEntry) -> DirSyncChange:
+        changed = LDAPEntry(entry.dn)
+        added: Dict[str, List[Any]] = {}
+        removed: Dict[str, List[Any]] = {}
+        for key, values in entry.items():
+            if key == "dn":
+                continue
+            # The changes of the linked values are returned with a range
+            # option: 1-1 for the added, 0-0 for the removed values.
+            attr, sep, rng = key.rpartition(";range=")
+            if sep and rng == "1-1":
+                added[attr] = list(values)
+            elif sep and rng == "0-0":
+                removed[attr] = list(values)
+            else:
+                changed[key] = list(values)
+                # Same state as the entries of a search result.
+                changed[key].status = 0
+                changed[key].added.clear()
+        # The boolean value is converted, unless it's set as raw.
+        deleted = any(
+            val in (True, "TRUE", b"TRUE") for val in entry.get("isDeleted", [])
+        )
+        return DirSyncChange(changed, deleted, added, removed)
+
+
+__all__ = ["DirSync", "DirSyncChange", "DirSyncFlag"]
@@ -52,10 +52,12 @@ class AIOLDAPConnection(BaseLDAPConnection):
         self._loop.add_writer(self.fileno(), self._ready, msg_id, fut)
         try:
             return await asyncio.wait_for(fut, timeout)
-        except Exception as exc:
+        except BaseException as exc:
             if self.fileno() > -1:
                 self._loop.remove_reader(self.fileno())
                 self._loop.remove_writer(self.fileno())
+            if isinstance(exc, (asyncio.CancelledError, asyncio.TimeoutError)):
+                self._abandon_unwaited(msg_id)
             raise exc
 
     def _evaluate(self, msg_id, timeout=None):
@@ -79,15 +81,5 @@ class AIOLDAPConnection(BaseLDAPConnection):
             else:
                 raise exc
 
-    async def _search_iter_anext(self, search_iter):
-        try:
-            return next(search_iter)
-        except StopIteration:
-            msgid = search_iter.acquire_next_page()
-            if msgid is None:
-                raise StopAsyncIteration from None
-            search_iter = await self._evaluate(msgid)
-            return next(search_iter)
-
     async def get_result(self, msg_id, timeout=None):
         return await self._evaluate(msg_id, timeout)
@@ -1,6 +1,6 @@
 import asyncio
 from contextlib import asynccontextmanager
-from typing import Any, AsyncGenerator, Optional
+from typing import Any, AsyncGenerator, List, Optional
 
 from ..pool import ConnectionPool, ClosedPool, EmptyPool
 
@@ -22,10 +22,12 @@ class AIOConnectionPool(ConnectionPool[AIOLDAPConnection]):
     :param int minconn: the minimum number of connections that's created
                 after the pool is opened.
     :param int maxconn: the maximum number of connections in the pool.
+    :param int warmup_limit: the maximum number of connections that are
+                opened concurrently when the pool is opened.
     :param \\*\\*kwargs: additional keyword arguments that are passed to
                 the :meth:`bonsai.LDAPClient.connect` method.
-    :raises ValueError: when the minconn is negative or the maxconn is less
-        than the minconn.
+    :raises ValueError: when the minconn is negative, the maxconn is less
+        than the minconn or the warmup_limit is less than 1.
     """
 
     def __init__(
@@ -34,9 +36,10 @@ class AIOConnectionPool(ConnectionPool[AIOLDAPConnection]):
         minconn: int = 1,
         maxconn: int = 10,
         loop: Optional[asyncio.AbstractEventLoop] = None,
+        warmup_limit: int = 8,
         **kwargs: Any
     ):
-        super().__init__(client, minconn, maxconn, **kwargs)
+        super().__init__(client, minconn, maxconn, warmup_limit, **kwargs)
         self._loop = loop
         try:
             # The loop parameter is deprecated since 3.8, removed in 3.10
@@ -47,14 +50,48 @@ class AIOConnectionPool(ConnectionPool[AIOLDAPConnection]):
 
     async def open(self) -> None:
         async with self._lock:
-            for _ in range(
-                self._minconn - self.idle_connection - self.shared_connection
-            ):
-                conn = await self._client.connect(
-                    is_async=True, loop=self._loop, **self._kwargs
-                )
-                self._idles.add(conn)
-            self._closed = False
+            num = self._minconn - self.idle_connection - self.shared_connection
+            semaphore = asyncio.Semaphore(self._warmup_limit)
+
+            async def connect() -> AIOLDAPConnection:
+                async with semaphore:
+                    return await self._client.connect(
+                        is_async=True, loop=self._loop, **self._kwargs
+                    )
+
+            tasks = [asyncio.ensure_future(connect()) for _ in range(max(num, 0))]
+            try:
+                if tasks:
+                    await asyncio.wait(tasks)
+            except BaseException:
+                # Cancelled while warming up: stop the pending attempts and
+                # do not leak the connections that are already opened.
+                for task in tasks:
+                    task.cancel()
+                await asyncio.wait(tasks)
+                for task in tasks:
+                    if not task.cancelled() and task.exception() is None:
+                        task.result().close()
+                raise
+            conns: List[AIOLDAPConnection] = []
+            errors: List[Exception] = []
+            fatal: Optional[BaseException] = None
+            for task in tasks:
+                if task.cancelled():
+                    fatal = fatal or asyncio.CancelledError()
+                    continue
+                exc = task.exception()
+                if exc is None:
+                    conns.append(task.result())
+                elif isinstance(exc, Exception):
+                    errors.append(exc)
+                else:
+                    fatal = fatal or exc
+            if fatal is not None:
+                for conn in conns:
+                    conn.close()
+                raise fatal
+            self._finish_warmup(conns, errors)
 
     async def get(self) -> AIOLDAPConnection:
         async with self._lock:
@@ -63,7 +100,7 @@ class AIOConnectionPool(ConnectionPool[AIOLDAPConnection]):
             await self._lock.wait_for(lambda: not self.empty or self._closed)
             try:
                 conn = self._idles.pop()
-            except KeyError:
+            except IndexError:
                 if len(self._used) < self._maxconn:
                     conn = await self._client.connect(
                         is_async=True, loop=self._loop, **self._kwargs
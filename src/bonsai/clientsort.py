@@ -0,0 +1,177 @@
+import heapq
+import pickle
+import tempfile
+from typing import Any, BinaryIO, Iterable, Iterator, List, Optional, Tuple
+
+from .ldapentry import LDAPEntry
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import BaseLDAPConnection
+
+
+def _value_key(value: Any) -> Tuple[int, Any]:
+    """
+    Comparable key of an attribute value. Strings are compared case
+    insensitively, and values of different types are ordered by type.
+    """
+    if isinstance(value, bool):
+        return (0, int(value))
+    if isinstance(value, int):
+        return (0, value)
+    if isinstance(value, bytes):
+        return (2, value)
+    return (1, str(value).casefold())
+
+
+class SortKey:
+    """
+    Sort key of an entry for the given sort order. As RFC 2891 describes,
+    the smallest value of a multivalued attribute is used for ascending
+    and the largest one for descending order, and entries without the
+    attribute are sorted as if their value were larger than any other.
+
+    :param LDAPEntry entry: the entry.
+    :param list sort_order: list of (attribute name, reverse) pairs.
+    """
+
+    __slots__ = ("keys", "reverses")
+
+    def __init__(self, entry: LDAPEntry, sort_order: List[Tuple[str, bool]]) -> None:
+        keys = []
+        for attr, reverse in sort_order:
+            values = entry.get(attr)
+            if not values:
+                keys.append((1,))
+                continue
+            value_keys = [_value_key(val) for val in values]
+            keys.append((0, max(value_keys) if reverse else min(value_keys)))
+        self.keys = keys
+        self.reverses = [reverse for _, reverse in sort_order]
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, SortKey):
+            return NotImplemented
+        return self.keys == other.keys
+
+    def __lt__(self, other: "SortKey") -> bool:
+        for key, other_key, reverse in zip(self.keys, other.keys, self.reverses):
+            if key == other_key:
+                continue
+            return other_key < key if reverse else key < other_key
+        return False
+
+
+class ExternalSorter:
+    """
+    Sort entries by the given sort order with bounded memory. At most
+    `buffer_size` entries are kept in memory, the sorted runs above that
+    are written to temporary files and merged while the entries are
+    read back.
+
+    :param list sort_order: list of attribute's names, start name with \
+    '-' for descending order.
+    :param int buffer_size: the maximal number of entries kept in memory.
+    :param conn: the connection of the entries that are read back from \
+    the temporary files.
+    :raises ValueError: if the `sort_order` is empty or the `buffer_size` \
+    is less than 1.
+    """
+
+    def __init__(
+        self,
+        sort_order: List[str],
+        buffer_size: int = 10000,
+        conn: Optional["BaseLDAPConnection"] = None,
+    ) -> None:
+        if not sort_order:
+            raise ValueError("The sort_order must not be empty.")
+        if buffer_size < 1:
+            raise ValueError("The buffer_size must be positive.")
+        self.__sort_order = [
+            (attr[1:], True) if attr.startswith("-") else (attr, False)
+            for attr in sort_order
+        ]
+        self.__buffer_size = buffer_size
+        self.__conn = conn
+        self.__buffer: List[Tuple[SortKey, LDAPEntry]] = []
+        self.__runs: List[BinaryIO] = []
+
+    @property
+    def spilled_runs(self) -> int:
+        """ The number of sorted runs written to temporary files. """
+        return len(self.__runs)
+
+    def add(self, entry: LDAPEntry) -> None:
+        """
+        Add an entry to the sorter.
+
+        :param LDAPEntry entry: the entry.
+        """
+        self.__buffer.append((SortKey(entry, self.__sort_order), entry))
+        if len(self.__buffer) >= self.__buffer_size:
+            self.__spill()
+
+    def extend(self, entries: Iterable[LDAPEntry]) -> None:
+        """
+        Add multiple entries to the sorter.
+
+        :param entries: the entries.
+        """
+        for entry in entries:
+            self.add(entry)
+
+    def close(self) -> None:
+        """ Drop the buffered entries and remove the temporary files. """
+        self.__buffer.clear()
+        for run in self.__runs:
+            run.close()
+        self.__runs.clear()
+
+    def __iter__(self) -> Iterator[LDAPEntry]:
+        """ Yield the added entries in sorted order. """
+        self.__buffer.sort(key=lambda item: item[0])
+        try:
+            if not self.__runs:
+                for _, entry in self.__buffer:
+                    yield entry
+                return
+            for run in self.__runs:
+                run.seek(0)
+            sources = [self.__read_run(run) for run in self.__runs]
+            sources.append(iter(self.__buffer))
+            for _, entry in heapq.merge(*sources, key=lambda item: item[0]):
+                yield entry
+        finally:
+            self.close()
+
+    def __spill(self) -> None:
+        self.__buffer.sort(key=lambda item: item[0])
+        run = tempfile.TemporaryFile()
+        try:
+            for _, entry in self.__buffer:
+                dname = entry.extended_dn or str(entry.dn)
+                attrs = [
+                    (attr, list(values)) for attr, values in entry.items(exclude_dn=True)
+                ]
+                pickle.dump((dname, attrs), run, pickle.HIGHEST_PROTOCOL)
+        except Exception:
+            run.close()
+            raise
+        self.__runs.append(run)
+        self.__buffer.clear()
+
+    def __read_run(self, run: BinaryIO) -> Iterator[Tuple[SortKey, LDAPEntry]]:
+        while True:
+            try:
+                dname, attrs = pickle.load(run)
+            except EOFError:
+                return
+            entry = LDAPEntry(dname, self.__conn)
+            for attr, values in attrs:
+                entry[attr] = values
+                # Same state as the entries of a search result.
+                entry[attr].status = 0
+                entry[attr].added.clear()
+            yield SortKey(entry, self.__sort_order), entry
@@ -128,6 +128,21 @@ class NotAllowedOnNonleaf(LDAPError):
     code = 0x42
 
 
+class FilterError(LDAPError):
+    """Raised, when the search filter is malformed."""
+
+    code = -7
+
+
+class SyncRefreshRequired(LDAPError):
+    """
+    Raised, when the server can't continue the content synchronization
+    from the given cookie, and the content has to be reloaded.
+    """
+
+    code = 0x1000
+
+
 class NoSuchAttribute(LDAPError):
     """Raised, when the given attribute of an entry does not exist."""
 
@@ -278,6 +293,11 @@ def _get_error(code: int) -> type:
         return AlreadyExists
     elif code == 0x47:
         return AffectsMultipleDSA
+    elif code == -7 or code == 0x57:
+        # WinLDAP returns 0x57 for Filter Error.
+        return FilterError
+    elif code == 0x1000:
+        return SyncRefreshRequired
     elif code == -5 or code == 0x55:
         return TimeoutError.create(code)
     elif code == -100:
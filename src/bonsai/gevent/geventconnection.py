@@ -1,9 +1,12 @@
-from typing import Any, Optional, Union
-from gevent.socket import wait_readwrite
+from typing import Any, Dict, Iterable, List, Optional, Tuple, Union
+
+import gevent
+from gevent.event import AsyncResult
+from gevent.socket import wait_readwrite, timeout as socket_timeout
 
 from ..ldapconnection import BaseLDAPConnection, LDAPSearchScope
 from ..ldapdn import LDAPDN
-from ..errors import NotAllowedOnNonleaf
+from ..errors import ClosedConnection, NotAllowedOnNonleaf
 
 MYPY = False
 
@@ -19,18 +22,117 @@ class GeventLDAPConnection(BaseLDAPConnection):
     """
 
     def __init__(self, client: 'LDAPClient') -> None:
+        # Results of the greenlets that wait on an operation, by message ID.
+        self.__waiters: Dict[int, AsyncResult] = {}
+        self.__reader: Optional[gevent.Greenlet] = None
+        self.__watcher: Any = None
         super().__init__(client, is_async=True)
 
-    def _poll(self, msg_id: int, timeout: Optional[float] = None) -> Any:
+    def close(self) -> None:
+        reader = self.__reader
+        if reader is not None:
+            self.__reader = None
+            if self.__watcher is not None:
+                # Do not watch the descriptor after it's closed.
+                self.__watcher.stop()
+            reader.kill(block=False)
+        for result in self.__waiters.values():
+            result.set_exception(ClosedConnection("The connection is closed."))
+        self.__waiters.clear()
+        super().close()
+
+    def __poll_open(self, msg_id: int, timeout: Optional[float] = None) -> Any:
         while True:
             res = self.get_result(msg_id)
             if res is not None:
                 return res
             wait_readwrite(self.fileno(), timeout=timeout)
 
+    def __dispatch(self) -> None:
+        """
+        Check every waiting operation, and set the finished ones. Reading
+        a result can queue other operations' responses in libldap, that
+        won't make the socket readable again, so the waiting operations
+        are checked until a full pass finds no finished one.
+        """
+        woken = True
+        while woken and self.__waiters:
+            woken = False
+            for msg_id, result in list(self.__waiters.items()):
+                try:
+                    res = self.get_result(msg_id)
+                except Exception as exc:
+                    del self.__waiters[msg_id]
+                    result.set_exception(exc)
+                    woken = True
+                    continue
+                if res is not None:
+                    del self.__waiters[msg_id]
+                    result.set(res)
+                    woken = True
+
+    def __read(self) -> None:
+        """
+        Reader greenlet of the connection. Waits on the descriptor to be
+        readable as long as there are waiting operations, and dispatches
+        the results.
+        """
+        hub = gevent.get_hub()
+        watcher = hub.loop.io(self.fileno(), 1)
+        self.__watcher = watcher
+        try:
+            while self.__waiters:
+                hub.wait(watcher)
+                self.__dispatch()
+        except Exception as exc:
+            for result in self.__waiters.values():
+                result.set_exception(exc)
+            self.__waiters.clear()
+        finally:
+            watcher.close()
+            if self.__reader is gevent.getcurrent():
+                self.__reader = None
+                self.__watcher = None
+
+    def _poll(self, msg_id: int, timeout: Optional[float] = None) -> Any:
+        if self.closed:
+            # The connection is still being opened.
+            return self.__poll_open(msg_id, timeout)
+        res = self.get_result(msg_id)
+        # The read might have queued the responses of the waiting operations.
+        self.__dispatch()
+        if res is not None:
+            return res
+        result = AsyncResult()
+        self.__waiters[msg_id] = result
+        if self.__reader is None:
+            self.__reader = gevent.spawn(self.__read)
+        try:
+            return result.get(timeout=timeout)
+        except gevent.Timeout:
+            raise socket_timeout("timed out") from None
+        finally:
+            if self.__waiters.pop(msg_id, None) is not None:
+                # Timed out or killed, stop the operation on the server.
+                self._abandon_unwaited(msg_id)
+                if not self.__waiters:
+                    # Nobody else is waiting, stop the reader.
+                    reader = self.__reader
+                    self.__reader = None
+                    if reader is not None:
+                        reader.kill(block=False)
+
     def _evaluate(self, msg_id: int, timeout: Optional[float] = None) -> Any:
         return self._poll(msg_id, timeout)
 
+    def compare_many(self, assertions: Iterable[Tuple[Union[str, LDAPDN], str, Any]],
+                     timeout: Optional[float] = None,
+                     pipeline_depth: int = 64) -> List[bool]:
+        if pipeline_depth < 1:
+            raise ValueError("The pipeline_depth must be positive.")
+        # The greenlet waits for the results, they are not awaited.
+        return self._compare_pipelined(iter(assertions), timeout, pipeline_depth)
+
     def delete(self, dname: Union[str, LDAPDN], timeout: Optional[float] = None,
                recursive: bool = False) -> bool:
         try:
@@ -10,6 +10,7 @@ from .ldapurl import LDAPURL
 from .ldapconnection import BaseLDAPConnection, LDAPConnection
 from .ldapconnection import LDAPSearchScope
 from .ldapentry import LDAPEntry
+from .searchcache import SearchCache
 from .asyncio import AIOLDAPConnection
 
 
@@ -29,6 +30,7 @@ class LDAPClient:
         self.set_url(url)
         self.__credentials: Optional[Dict[str, Optional[str]]] = None
         self.__raw_list: List[str] = []
+        self.__dn_list: List[str] = []
         self.__mechanism = "SIMPLE"
         self.__cert_policy = -1
         self.__ca_cert: Optional[str] = ""
@@ -40,10 +42,12 @@ class LDAPClient:
         self.__ext_dn: Optional[int] = None
         self.__sd_flags: Optional[int] = None
         self.__auto_acquire = True
+        self.__auto_range_acquire = True
         self.__chase_referrals = False
         self.__ignore_referrals = True
         self.__managedsait_ctrl = False
         self.__sasl_sec_props: Optional[str] = None
+        self.__search_cache: Optional[SearchCache] = None
 
     def set_raw_attributes(self, raw_list: List[str]) -> None:
         """
@@ -66,6 +70,29 @@ class LDAPClient:
             raise ValueError("Attribute names must be different from each other.")
         self.__raw_list = raw_list
 
+    def set_dn_attributes(self, dn_list: List[str]) -> None:
+        """
+        Set the names of the DN-valued LDAP attributes (e.g. `member`,
+        `uniqueMember`, `memberOf`). The values of these attributes will be
+        converted to :class:`LDAPDN` objects during the searches. The
+        equivalent DNs are represented by the same immutable object across
+        the entries of a search (and the pages of a paged search).
+
+        :param list dn_list: a list of LDAP attribute's names. \
+        The elements must be string and unique.
+
+        :raises TypeError: if any of the list's element is not a \
+        string.
+        :raises ValueError: if the item in the lit is not a unique \
+        element.
+        """
+        for elem in dn_list:
+            if not isinstance(elem, str):
+                raise TypeError("All element of dn_list must be string.")
+        if len(dn_list) > len(set(map(str.lower, dn_list))):
+            raise ValueError("Attribute names must be different from each other.")
+        self.__dn_list = dn_list
+
     def set_credentials(
         self,
         mechanism: str,
@@ -315,6 +342,25 @@ class LDAPClient:
             raise TypeError("Parameter's type must be bool.")
         self.__auto_acquire = val
 
+    def set_auto_range_acquire(self, val: bool) -> None:
+        """
+        Turn on or off the automatic retrieval of ranged attributes.
+        Active Directory returns the values of a large multi-valued
+        attribute in slices, e.g. as `member;range=0-1499`. By turning
+        automatic range acquiring on, the remaining slices are requested
+        with several base searches in parallel, and every value is set
+        by the attribute's name without the range option in the entries
+        of :meth:`LDAPConnection.search` and
+        :meth:`LDAPConnection.virtual_list_search`. The entries of the
+        other kinds of searches keep the ranged names.
+
+        :param bool val: enabling/disabling auto range acquiring.
+        :raises TypeError: If the parameter is not a bool type.
+        """
+        if not isinstance(val, bool):
+            raise TypeError("Parameter's type must be bool.")
+        self.__auto_range_acquire = val
+
     def set_ignore_referrals(self, val: bool) -> None:
         """
         Turn on or off ignoring LDAP referrals in search result. When
@@ -359,6 +405,20 @@ class LDAPClient:
             raise TypeError("Parameter's type must be bool.")
         self.__managedsait_ctrl = val
 
+    def set_search_cache(self, cache: Optional[SearchCache]) -> None:
+        """
+        Set a cache for the results of the synchronous connections'
+        :meth:`LDAPConnection.search` method. The cached results are
+        dropped, when an entry of their subtree is written through one
+        of the client's connections.
+
+        :param SearchCache|None cache: the cache, `None` disables caching.
+        :raises TypeError: if the parameter is not a SearchCache or None.
+        """
+        if cache is not None and not isinstance(cache, SearchCache):
+            raise TypeError("Parameter's type must be SearchCache or None.")
+        self.__search_cache = cache
+
     def set_url(self, url: Union[LDAPURL, str]) -> None:
         """
         Set LDAP url for the client.
@@ -535,6 +595,15 @@ class LDAPClient:
     def raw_attributes(self, value: List[str]) -> None:
         self.set_raw_attributes(value)
 
+    @property
+    def dn_attributes(self) -> List[str]:
+        """A list of DN-valued attributes that should be LDAPDN objects."""
+        return self.__dn_list
+
+    @dn_attributes.setter
+    def dn_attributes(self, value: List[str]) -> None:
+        self.set_dn_attributes(value)
+
     @property
     def password_policy(self) -> bool:
         """The status of using password policy."""
@@ -577,6 +646,18 @@ class LDAPClient:
     def auto_page_acquire(self, value: bool) -> None:
         self.set_auto_page_acquire(value)
 
+    @property
+    def auto_range_acquire(self) -> bool:
+        """
+        The status of automatic range acquiring.
+         `True` by default.
+        """
+        return self.__auto_range_acquire
+
+    @auto_range_acquire.setter
+    def auto_range_acquire(self, value: bool) -> None:
+        self.set_auto_range_acquire(value)
+
     @property
     def ignore_referrals(self) -> bool:
         """
@@ -614,6 +695,15 @@ class LDAPClient:
         """The SASL security properties."""
         return self.__sasl_sec_props
 
+    @property
+    def search_cache(self) -> Optional[SearchCache]:
+        """The cache of the search results."""
+        return self.__search_cache
+
+    @search_cache.setter
+    def search_cache(self, value: Optional[SearchCache]) -> None:
+        self.set_search_cache(value)
+
     def get_rootDSE(self) -> Optional[LDAPEntry]:
         """
         Returns the server's root DSE entry. The root DSE may contain
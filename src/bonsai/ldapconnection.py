@@ -1,16 +1,22 @@
 from abc import ABCMeta, abstractmethod
+from collections import deque
 from enum import IntEnum
-from typing import Union, Any, List, Tuple, Optional
+from inspect import isawaitable
+from typing import Union, Any, Deque, Dict, Iterable, Iterator, List, Tuple, Optional
 
 from bonsai._bonsai import ldapconnection, ldapsearchiter
 from .ldapdn import LDAPDN
 from .ldapentry import LDAPEntry
-from .errors import UnwillingToPerform, NotAllowedOnNonleaf
+from .ldapfilter import LDAPFilter
+from .errors import LDAPError, UnwillingToPerform, NotAllowedOnNonleaf
+from .vlvcursor import VLVCursor
+from .clientsort import ExternalSorter
 
 MYPY = False
 
 if MYPY:
     from .ldapclient import LDAPClient
+    from .searchcache import SearchCache
 
 
 class LDAPSearchScope(IntEnum):
@@ -23,10 +29,120 @@ class LDAPSearchScope(IntEnum):
     SUB = SUBTREE  #: Alias for :attr:`LDAPSearchScope.SUBTREE`.
 
 
+class PrefetchingSearchIter:
+    """
+    Asynchronous iterator over the entries of a paged search. The request
+    for the next page is sent as soon as the previous page is received, so
+    the server is already working on it while the entries of the current
+    page are consumed. At most one page of entries is buffered.
+
+    :param BaseLDAPConnection conn: an asynchronous connection.
+    :param ldapsearchiter search_iter: the paged search result.
+    """
+
+    def __init__(self, conn: "BaseLDAPConnection", search_iter: ldapsearchiter) -> None:
+        self.__conn = conn
+        self.__search_iter = search_iter
+        self.__entries: Deque[Any] = deque()
+        self.__msg_id: Optional[int] = None
+        self.__take_page()
+
+    def __del__(self) -> None:
+        if self.__msg_id is not None:
+            # The iteration is stopped before the last page.
+            self.__conn._abandon_unwaited(self.__msg_id)
+
+    def __take_page(self) -> None:
+        """
+        Move the received entries to the buffer, and request the next page.
+        """
+        self.__entries.extend(self.__search_iter)
+        self.__msg_id = self.__search_iter.acquire_next_page()
+
+    def __aiter__(self) -> "PrefetchingSearchIter":
+        return self
+
+    async def __anext__(self) -> Any:
+        while not self.__entries:
+            if self.__msg_id is None:
+                raise StopAsyncIteration
+            msg_id = self.__msg_id
+            await self.__conn._evaluate(msg_id)
+            self.__take_page()
+        return self.__entries.popleft()
+
+
+class _RangedAttribute:
+    """
+    The remaining values of an attribute, that the server returns in
+    ranges (e.g. `member;range=1500-2999`). Several ranges are requested
+    ahead, guessing their bounds from the size of the previous one, and
+    the received slices are joined in order. A slice that does not start
+    where the previous one ended is requested again.
+
+    :param LDAPEntry entry: the entry with the first range of the values.
+    :param str attr: the attribute's name without the range option.
+    :param int start: the index of the first missing value.
+    """
+
+    def __init__(self, entry: LDAPEntry, attr: str, start: int) -> None:
+        self.entry = entry
+        self.attr = attr
+        self.start = start
+        self.step = max(start, 1)
+        self.done = False
+        self.values: List[Any] = []
+        # The received slices by their lower bound: (next index, values).
+        self.__slices: Dict[int, Tuple[int, List[Any]]] = {}
+
+    def next_ranges(self, depth: int) -> List[int]:
+        """ Get the lower bounds of the next ranges to request. """
+        lows = (self.start + num * self.step for num in range(depth))
+        return [low for low in lows if low not in self.__slices]
+
+    def add(self, low: int, result: List[Any]) -> None:
+        """ Add the search result of the range starting at `low`. """
+        values: List[Any] = []
+        next_low = -1
+        name = self.attr.lower()
+        for ent in result:
+            if not isinstance(ent, LDAPEntry):
+                continue
+            values = list(ent.get(self.attr, []))
+            ranges = ent._ranges or {}
+            for key, value in ranges.items():
+                if key.lower() == name:
+                    next_low = value
+        self.__slices[low] = (next_low, values)
+        while not self.done and self.start in self.__slices:
+            low = self.start
+            next_low, values = self.__slices.pop(low)
+            self.values.extend(values)
+            if next_low <= low:
+                self.done = True
+            else:
+                self.start = next_low
+                self.step = next_low - low
+
+    def merge(self) -> None:
+        """ Append the retrieved values to the entry's attribute. """
+        vals = self.entry[self.attr]
+        for val in self.values:
+            # Same state as the values of a search result.
+            vals._append_unchecked(val)
+        del self.entry._ranges[self.attr]
+
+
 class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
     def __init__(self, client: "LDAPClient", is_async: bool = False) -> None:
         self.__client = client
         super().__init__(client, is_async)
+        # The identity that the connection binds with, it's part of the
+        # search cache keys, because the results depend on the access rights.
+        self.__identity = (
+            client.mechanism,
+            tuple(sorted((client.credentials or {}).items())),
+        )
 
     def __enter__(self) -> "BaseLDAPConnection":
         """ Context manager entry point. """
@@ -37,7 +153,7 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
         self.close()
 
     def add(self, entry: LDAPEntry, timeout: Optional[float] = None) -> Any:
-        return self._evaluate(super().add(entry), timeout)
+        return self._evaluate_write(super().add(entry), [entry.dn], timeout)
 
     def delete(
         self,
@@ -47,7 +163,91 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
     ) -> Any:
         if isinstance(dname, LDAPDN):
             dname = str(dname)
-        return self._evaluate(super().delete(dname, recursive), timeout)
+        return self._evaluate_write(super().delete(dname, recursive), [dname], timeout)
+
+    def compare(
+        self,
+        dname: Union[str, LDAPDN],
+        attr: str,
+        value: Any,
+        timeout: Optional[float] = None,
+    ) -> Any:
+        if isinstance(dname, LDAPDN):
+            dname = str(dname)
+        return self._evaluate(super().compare(dname, attr, value), timeout)
+
+    def compare_many(
+        self,
+        assertions: Iterable[Tuple[Union[str, LDAPDN], str, Any]],
+        timeout: Optional[float] = None,
+        pipeline_depth: int = 64,
+    ) -> Any:
+        if pipeline_depth < 1:
+            raise ValueError("The pipeline_depth must be positive.")
+        if self.is_async:
+            return self.__compare_many_async(iter(assertions), timeout, pipeline_depth)
+        return self._compare_pipelined(iter(assertions), timeout, pipeline_depth)
+
+    def _compare_pipelined(
+        self,
+        todo: Iterator[Tuple[Union[str, LDAPDN], str, Any]],
+        timeout: Optional[float],
+        pipeline_depth: int,
+    ) -> List[bool]:
+        """
+        Compare the values with pipelined requests, waiting for their
+        results synchronously. The message ID of a request is kept in the
+        `pending` queue until its result is received, thus it's abandoned
+        along with the rest, if it's failed or timed out.
+        """
+        pending: Deque[int] = deque()
+        results: List[bool] = []
+        try:
+            self.__request_compares(todo, pending, pipeline_depth)
+            while pending:
+                results.append(self._evaluate(pending[0], timeout))
+                pending.popleft()
+                self.__request_compares(todo, pending, pipeline_depth)
+        except BaseException:
+            for msg_id in pending:
+                self._abandon_unwaited(msg_id)
+            raise
+        return results
+
+    def __request_compares(
+        self,
+        todo: Iterator[Tuple[Union[str, LDAPDN], str, Any]],
+        pending: Deque[int],
+        pipeline_depth: int,
+    ) -> None:
+        """ Send compare requests until `pipeline_depth` of them are outstanding. """
+        while len(pending) < pipeline_depth:
+            try:
+                dname, attr, value = next(todo)
+            except StopIteration:
+                return
+            pending.append(super().compare(str(dname), attr, value))
+
+    async def __compare_many_async(
+        self,
+        todo: Iterator[Tuple[Union[str, LDAPDN], str, Any]],
+        timeout: Optional[float],
+        pipeline_depth: int,
+    ) -> List[bool]:
+        """ The same as :meth:`_compare_pipelined` for async connections. """
+        pending: Deque[int] = deque()
+        results: List[bool] = []
+        try:
+            self.__request_compares(todo, pending, pipeline_depth)
+            while pending:
+                results.append(await self._evaluate(pending[0], timeout))
+                pending.popleft()
+                self.__request_compares(todo, pending, pipeline_depth)
+        except BaseException:
+            for msg_id in pending:
+                self._abandon_unwaited(msg_id)
+            raise
+        return results
 
     def open(self, timeout: Optional[float] = None) -> "BaseLDAPConnection":
         return self._evaluate(super().open(), timeout)
@@ -61,9 +261,12 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
     ) -> Any:
         if isinstance(user, LDAPDN):
             user = str(user)
-        return self._evaluate(
-            super().modify_password(user, new_password, old_password), timeout
-        )
+        msg_id = super().modify_password(user, new_password, old_password)
+        cache = self.__client.search_cache
+        if cache is not None:
+            # The user is not necessarily identified by a DN.
+            cache.clear()
+        return self._evaluate(msg_id, timeout)
 
     def __base_search(
         self,
@@ -81,10 +284,157 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
         after_count: int = 0,
         est_list_count: int = 0,
         attrvalue: Optional[str] = None,
+        context_id: Optional[bytes] = None,
+        asq_attr: Optional[str] = None,
+        values_filter: Optional[str] = None,
+    ) -> Any:
+        msg_id = self._search_request(
+            base,
+            scope,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
+            page_size,
+            offset,
+            before_count,
+            after_count,
+            est_list_count,
+            attrvalue,
+            context_id,
+            asq_attr=asq_attr,
+            values_filter=values_filter,
+        )
+        res = self._evaluate(msg_id, timeout)
+        if page_size == 0 and self.__client.auto_range_acquire:
+            if isawaitable(res):
+                return self._acquire_ranges_async(res, timeout, values_filter)
+            self._acquire_ranges(res, timeout, values_filter)
+        return res
+
+    #: The number of ranges of an attribute that are requested at once.
+    _range_depth = 4
+
+    @staticmethod
+    def __get_ranged_attrs(res: Any) -> List[_RangedAttribute]:
+        if isinstance(res, tuple):
+            # Result of a virtual list view search.
+            res = res[0]
+        if not isinstance(res, list):
+            return []
+        return [
+            _RangedAttribute(ent, attr, start)
+            for ent in res
+            if isinstance(ent, LDAPEntry) and ent._ranges
+            for attr, start in ent._ranges.items()
+        ]
+
+    def __request_ranges(
+        self,
+        ranged_attrs: List[_RangedAttribute],
+        timeout: Optional[float],
+        values_filter: Optional[str],
+    ) -> List[Tuple[_RangedAttribute, int, int]]:
+        requests = []
+        try:
+            for rattr in ranged_attrs:
+                for low in rattr.next_ranges(self._range_depth):
+                    msg_id = self._search_request(
+                        rattr.entry.dn,
+                        LDAPSearchScope.BASE,
+                        "(objectClass=*)",
+                        ["%s;range=%d-*" % (rattr.attr, low)],
+                        timeout,
+                        values_filter=values_filter,
+                    )
+                    requests.append((rattr, low, msg_id))
+        except Exception:
+            for _, _, msg_id in requests:
+                self._abandon_unwaited(msg_id)
+            raise
+        return requests
+
+    def _acquire_ranges(
+        self, res: Any, timeout: Optional[float], values_filter: Optional[str] = None
+    ) -> None:
+        """
+        Retrieve the remaining values of the ranged attributes in the
+        entries of a search result. The ranges of every attribute are
+        requested in parallel with base searches on the entry, with the
+        same `values_filter` as the original search.
+        """
+        pending = self.__get_ranged_attrs(res)
+        while pending:
+            requests = self.__request_ranges(pending, timeout, values_filter)
+            for num, (rattr, low, msg_id) in enumerate(requests):
+                try:
+                    rattr.add(low, self._evaluate(msg_id, timeout))
+                except Exception:
+                    for _, _, rest_id in requests[num + 1 :]:
+                        self._abandon_unwaited(rest_id)
+                    raise
+            for rattr in pending:
+                if rattr.done:
+                    rattr.merge()
+            pending = [rattr for rattr in pending if not rattr.done]
+
+    async def _acquire_ranges_async(
+        self, res: Any, timeout: Optional[float], values_filter: Optional[str] = None
     ) -> Any:
+        """ The same as :meth:`_acquire_ranges` for async connections. """
+        res = await res
+        pending = self.__get_ranged_attrs(res)
+        while pending:
+            requests = self.__request_ranges(pending, timeout, values_filter)
+            for num, (rattr, low, msg_id) in enumerate(requests):
+                try:
+                    rattr.add(low, await self._evaluate(msg_id, timeout))
+                except Exception:
+                    for _, _, rest_id in requests[num + 1 :]:
+                        self._abandon_unwaited(rest_id)
+                    raise
+            for rattr in pending:
+                if rattr.done:
+                    rattr.merge()
+            pending = [rattr for rattr in pending if not rattr.done]
+        return res
 
+    def _search_request(
+        self,
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union[LDAPSearchScope, int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        timeout: Optional[float] = None,
+        sizelimit: int = 0,
+        attrsonly: bool = False,
+        sort_order: Optional[List[str]] = None,
+        page_size: int = 0,
+        offset: int = 0,
+        before_count: int = 0,
+        after_count: int = 0,
+        est_list_count: int = 0,
+        attrvalue: Optional[str] = None,
+        context_id: Optional[bytes] = None,
+        sync_mode: int = 0,
+        sync_cookie: Optional[bytes] = None,
+        reload_hint: bool = False,
+        dirsync_flags: Optional[int] = None,
+        dirsync_max_bytes: int = 0,
+        dirsync_cookie: Optional[bytes] = None,
+        notify_mode: int = 0,
+        psearch_types: int = 0,
+        psearch_changes_only: bool = False,
+        asq_attr: Optional[str] = None,
+        values_filter: Optional[str] = None,
+    ) -> int:
+        """ Send a search request, and return its message ID. """
         _base = str(base) if base is not None else str(self.__client.url.basedn)
         _scope = scope if scope is not None else self.__client.url.scope_num
+        if isinstance(filter_exp, LDAPFilter):
+            filter_exp = str(filter_exp)
         _filter = filter_exp if filter_exp is not None else self.__client.url.filter_exp
         _attrlist = attrlist if attrlist is not None else self.__client.url.attributes
         _timeout = timeout if timeout is not None else 0.0
@@ -92,7 +442,7 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
             _sort_order = self.__create_sort_list(sort_order)
         else:
             _sort_order = []
-        msg_id = super().search(
+        return super().search(
             _base,
             _scope,
             _filter,
@@ -107,8 +457,19 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
             after_count,
             est_list_count,
             attrvalue,
+            context_id,
+            sync_mode,
+            sync_cookie,
+            reload_hint,
+            dirsync_flags,
+            dirsync_max_bytes,
+            dirsync_cookie,
+            notify_mode,
+            psearch_types,
+            psearch_changes_only,
+            asq_attr,
+            values_filter,
         )
-        return self._evaluate(msg_id, timeout)
 
     @staticmethod
     def __create_sort_list(sort_list: List[str]) -> List[Tuple[str, bool]]:
@@ -146,11 +507,91 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
         sizelimit: int = 0,
         attrsonly: bool = False,
         sort_order: Optional[List[str]] = None,
+        values_filter: Optional[str] = None,
     ) -> Any:
         return self.__base_search(
-            base, scope, filter_exp, attrlist, timeout, sizelimit, attrsonly, sort_order
+            base,
+            scope,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
+            values_filter=values_filter,
         )
 
+    def _cached_search(
+        self,
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union[LDAPSearchScope, int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        timeout: Optional[float] = None,
+        sizelimit: int = 0,
+        attrsonly: bool = False,
+        sort_order: Optional[List[str]] = None,
+        values_filter: Optional[str] = None,
+    ) -> Any:
+        """
+        Search by using the client's search cache. Returns a copy of the
+        cached result, or searches and stores the result.
+        """
+        client = self.__client
+        cache = client.search_cache
+        if cache is None:
+            return self.__base_search(
+                base,
+                scope,
+                filter_exp,
+                attrlist,
+                timeout,
+                sizelimit,
+                attrsonly,
+                sort_order,
+                values_filter=values_filter,
+            )
+        _base = LDAPDN(str(base)) if base is not None else client.url.basedn
+        if isinstance(filter_exp, LDAPFilter):
+            filter_exp = str(filter_exp)
+        key = (
+            _base,
+            scope if scope is not None else client.url.scope_num,
+            str(filter_exp) if filter_exp is not None else client.url.filter_exp,
+            tuple(attrlist if attrlist is not None else client.url.attributes),
+            sizelimit,
+            attrsonly,
+            tuple(sort_order or ()),
+            values_filter,
+            self.__identity,
+            # The client's settings that change the received entries.
+            tuple(client.raw_attributes),
+            tuple(client.dn_attributes),
+            client.extended_dn_format,
+            client.sd_flags,
+            client.managedsait,
+            client.ignore_referrals,
+            client.server_chase_referrals,
+            client.auto_range_acquire,
+        )
+        res = cache.get(key, self)
+        if res is not None:
+            return res
+        generation = cache.generation
+        res = self.__base_search(
+            base,
+            scope,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
+            values_filter=values_filter,
+        )
+        cache.put(key, _base, res, generation)
+        return res
+
     def paged_search(
         self,
         base: Optional[Union[str, LDAPDN]] = None,
@@ -162,6 +603,7 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
         attrsonly: bool = False,
         sort_order: Optional[List[str]] = None,
         page_size: int = 1,
+        values_filter: Optional[str] = None,
     ) -> Any:
         chase_referrals = self.__client.server_chase_referrals
         try:
@@ -176,10 +618,36 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
                 attrsonly,
                 sort_order,
                 page_size,
+                values_filter=values_filter,
             )
         finally:
             self.__client.set_server_chase_referrals(chase_referrals)
 
+    def attribute_scoped_search(
+        self,
+        base: Union[str, LDAPDN],
+        attr: str,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        timeout: Optional[float] = None,
+        sizelimit: int = 0,
+        attrsonly: bool = False,
+        sort_order: Optional[List[str]] = None,
+        page_size: int = 0,
+    ) -> Any:
+        return self.__base_search(
+            base,
+            LDAPSearchScope.BASE,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
+            page_size,
+            asq_attr=attr,
+        )
+
     def virtual_list_search(
         self,
         base: Optional[Union[str, LDAPDN]] = None,
@@ -195,6 +663,7 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
         after_count: int = 0,
         est_list_count: int = 0,
         attrvalue: Optional[str] = None,
+        context_id: Optional[bytes] = None,
     ) -> Any:
         if sort_order is None and (offset != 0 or attrvalue is not None):
             raise UnwillingToPerform(
@@ -215,15 +684,69 @@ class BaseLDAPConnection(ldapconnection, metaclass=ABCMeta):
             after_count,
             est_list_count,
             attrvalue,
+            context_id,
         )
 
     def whoami(self, timeout: Optional[float] = None) -> Any:
         return self._evaluate(super().whoami(), timeout)
 
+    def _search_iter_aiter(self, search_iter: ldapsearchiter) -> PrefetchingSearchIter:
+        return PrefetchingSearchIter(self, search_iter)
+
+    def _abandon_unwaited(self, msg_id: int) -> None:
+        """
+        Abandon an operation whose result is no longer waited for
+        (because of a timeout or cancellation), so that the server
+        stops working on it.
+        """
+        if self.closed:
+            return
+        try:
+            self.abandon(msg_id)
+        except LDAPError:
+            pass
+
     @abstractmethod
     def _evaluate(self, msg_id: int, timeout: Optional[float] = None) -> Any:
         pass
 
+    def _evaluate_write(
+        self,
+        msg_id: int,
+        dnames: List[Union[str, LDAPDN]],
+        timeout: Optional[float] = None,
+    ) -> Any:
+        """
+        Evaluate a write operation, and drop the cached search results
+        that are affected by the written entries.
+        """
+        cache = self.__client.search_cache
+        if cache is None:
+            return self._evaluate(msg_id, timeout)
+        for dname in dnames:
+            cache.invalidate(dname)
+        res = self._evaluate(msg_id, timeout)
+        if isawaitable(res):
+            return self.__invalidate_after(res, cache, dnames)
+        # Drop the results that are cached while the operation was running.
+        for dname in dnames:
+            cache.invalidate(dname)
+        return res
+
+    @staticmethod
+    async def __invalidate_after(
+        res: Any, cache: "SearchCache", dnames: List[Union[str, LDAPDN]]
+    ) -> Any:
+        """
+        Wait for the asynchronous write operation, and drop the results
+        that are cached while the operation was running.
+        """
+        try:
+            return await res
+        finally:
+            for dname in dnames:
+                cache.invalidate(dname)
+
 
 class LDAPConnection(BaseLDAPConnection):
     """
@@ -286,6 +809,52 @@ class LDAPConnection(BaseLDAPConnection):
             else:
                 raise exc
 
+    def compare(
+        self,
+        dname: Union[str, LDAPDN],
+        attr: str,
+        value: Any,
+        timeout: Optional[float] = None,
+    ) -> bool:
+        """
+        Compare the value of an entry's attribute on the directory server.
+        The server only tells whether the entry has the value, that is
+        cheaper than searching and returning the entry.
+
+        :param str|LDAPDN dname: the string or LDAPDN format of the \
+        entry's DN.
+        :param str attr: the name of the attribute.
+        :param value: the asserted value.
+        :param float timeout: time limit in seconds for the operation.
+        :return: True, if the attribute has the value, False otherwise.
+        :rtype: bool
+        """
+        return super().compare(dname, attr, value, timeout)
+
+    def compare_many(
+        self,
+        assertions: Iterable[Tuple[Union[str, LDAPDN], str, Any]],
+        timeout: Optional[float] = None,
+        pipeline_depth: int = 64,
+    ) -> List[bool]:
+        """
+        Compare the values of many entries. The compare requests are
+        pipelined on the connection: the next requests are sent without
+        waiting for the results of the previous ones, keeping at most
+        `pipeline_depth` of them outstanding. If an operation fails, the
+        remaining outstanding requests are abandoned.
+
+        :param list assertions: the (DN, attribute, value) tuples.
+        :param float timeout: time limit in seconds for each operation.
+        :param int pipeline_depth: the maximal number of outstanding \
+        requests.
+        :return: the results of the comparisons in the order of the \
+        assertions.
+        :rtype: list
+        :raises ValueError: if the `pipeline_depth` is not positive.
+        """
+        return super().compare_many(assertions, timeout, pipeline_depth)
+
     def open(self, timeout: Optional[float] = None) -> "LDAPConnection":
         """
         Open the LDAP connection.
@@ -306,12 +875,21 @@ class LDAPConnection(BaseLDAPConnection):
         sizelimit: int = 0,
         attrsonly: bool = False,
         sort_order: Optional[List[str]] = None,
+        values_filter: Optional[str] = None,
     ) -> List[LDAPEntry]:
         # Documentation in the docs/api.rst with detailed examples.
         # Load values from the LDAPURL, if it is not presented on the
         # parameter list.
-        return super().search(
-            base, scope, filter_exp, attrlist, timeout, sizelimit, attrsonly, sort_order
+        return self._cached_search(
+            base,
+            scope,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
+            values_filter,
         )
 
     def paged_search(
@@ -324,8 +902,30 @@ class LDAPConnection(BaseLDAPConnection):
         sizelimit: int = 0,
         attrsonly: bool = False,
         sort_order: Optional[List[str]] = None,
-        page_size: int = 1,
-    ) -> ldapsearchiter:
+        page_size: Optional[int] = None,
+        client_sort: bool = False,
+        sort_buffer_size: int = 10000,
+        values_filter: Optional[str] = None,
+    ) -> Union[ldapsearchiter, Iterator[LDAPEntry]]:
+        if client_sort:
+            if not sort_order:
+                raise ValueError("The sort_order is required for client_sort.")
+            if page_size is None:
+                # Every page is collected anyway, don't request them one by one.
+                page_size = min(sort_buffer_size, 1000)
+            return self.__client_sorted_search(
+                base,
+                scope,
+                filter_exp,
+                attrlist,
+                timeout,
+                sizelimit,
+                attrsonly,
+                sort_order,
+                page_size,
+                sort_buffer_size,
+                values_filter,
+            )
         return super().paged_search(
             base,
             scope,
@@ -335,6 +935,76 @@ class LDAPConnection(BaseLDAPConnection):
             sizelimit,
             attrsonly,
             sort_order,
+            page_size if page_size is not None else 1,
+            values_filter,
+        )
+
+    def __client_sorted_search(
+        self,
+        base: Optional[Union[str, LDAPDN]],
+        scope: Optional[Union[LDAPSearchScope, int]],
+        filter_exp: Optional[str],
+        attrlist: Optional[List[str]],
+        timeout: Optional[float],
+        sizelimit: int,
+        attrsonly: bool,
+        sort_order: List[str],
+        page_size: int,
+        sort_buffer_size: int,
+        values_filter: Optional[str],
+    ) -> Iterator[LDAPEntry]:
+        """
+        Collect every page of the search without server side sorting, and
+        return an iterator over the entries sorted on the client.
+        """
+        sorter = ExternalSorter(sort_order, sort_buffer_size, self)
+        try:
+            result = super().paged_search(
+                base,
+                scope,
+                filter_exp,
+                attrlist,
+                timeout,
+                sizelimit,
+                attrsonly,
+                None,
+                page_size,
+                values_filter,
+            )
+            while True:
+                # Consume the page without the automatic page acquiring.
+                for _ in range(len(result)):
+                    sorter.add(next(result))
+                msg_id = result.acquire_next_page()
+                if msg_id is None:
+                    break
+                result = self._evaluate(msg_id, timeout)
+        except BaseException:
+            sorter.close()
+            raise
+        return iter(sorter)
+
+    def attribute_scoped_search(
+        self,
+        base: Union[str, LDAPDN],
+        attr: str,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        timeout: Optional[float] = None,
+        sizelimit: int = 0,
+        attrsonly: bool = False,
+        sort_order: Optional[List[str]] = None,
+        page_size: int = 0,
+    ) -> Union[List[LDAPEntry], ldapsearchiter]:
+        return super().attribute_scoped_search(
+            base,
+            attr,
+            filter_exp,
+            attrlist,
+            timeout,
+            sizelimit,
+            attrsonly,
+            sort_order,
             page_size,
         )
 
@@ -353,6 +1023,7 @@ class LDAPConnection(BaseLDAPConnection):
         after_count: int = 0,
         est_list_count: int = 0,
         attrvalue: Optional[str] = None,
+        context_id: Optional[bytes] = None,
     ) -> Tuple[List[LDAPEntry], dict]:
         return super().virtual_list_search(
             base,
@@ -368,6 +1039,53 @@ class LDAPConnection(BaseLDAPConnection):
             after_count,
             est_list_count,
             attrvalue,
+            context_id,
+        )
+
+    def virtual_list_cursor(
+        self,
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union[LDAPSearchScope, int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        sort_order: Optional[List[str]] = None,
+        window_size: int = 100,
+        cache_size: int = 16,
+        prefetch: bool = True,
+        timeout: Optional[float] = None,
+    ) -> "VLVCursor":
+        """
+        Create a cursor that provides random access to a server-side
+        sorted search result with virtual list view requests. See
+        :class:`bonsai.VLVCursor` for details.
+
+        :param str|LDAPDN base: the base DN of the search.
+        :param int scope: the scope of the search.
+        :param str filter_exp: string to filter the search in LDAP search \
+        filter syntax.
+        :param list attrlist: list of attribute's names to receive only those \
+        attributes from the directory server.
+        :param list sort_order: list of attribute's names to use for \
+        server-side ordering, start name with '-' for descending order.
+        :param int window_size: the number of entries requested at once.
+        :param int cache_size: the maximal number of windows kept in the cache.
+        :param bool prefetch: request the next window in the direction of \
+        the scrolling in advance.
+        :param float timeout: time limit in seconds for each request.
+        :return: the cursor of the search result.
+        :rtype: VLVCursor
+        """
+        return VLVCursor(
+            self,
+            base,
+            scope,
+            filter_exp,
+            attrlist,
+            sort_order,
+            window_size,
+            cache_size,
+            prefetch,
+            timeout,
         )
 
     def modify_password(
@@ -73,7 +73,7 @@ class LDAPEntry(ldapentry):
         :return: True, if the operation is finished.
         :rtype: bool
         """
-        return self.connection._evaluate(super().modify(), timeout)
+        return self.connection._evaluate_write(super().modify(), [self.dn], timeout)
 
     def rename(
         self,
@@ -92,7 +92,10 @@ class LDAPEntry(ldapentry):
         """
         if isinstance(newdn, LDAPDN):
             newdn = str(newdn)
-        return self.connection._evaluate(super().rename(newdn, delete_old_rdn), timeout)
+        olddn = self.dn
+        return self.connection._evaluate_write(
+            super().rename(newdn, delete_old_rdn), [olddn, newdn], timeout
+        )
 
     def update(self, *args: Tuple, **kwds: Dict[str, Any]) -> None:
         """
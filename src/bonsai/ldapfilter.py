@@ -0,0 +1,51 @@
+from typing import Any, Dict, Iterable, Iterator, TypeVar
+
+from bonsai._bonsai import ldapfilter
+
+_Entry = TypeVar("_Entry", bound=Dict[str, Any])
+
+
+class LDAPFilter(ldapfilter):
+    """
+    A compiled LDAP search filter of RFC 4515. The filter string is parsed
+    once, and the compiled filter is evaluated on the client against
+    :class:`LDAPEntry` objects or dicts of attribute values, e.g. to filter
+    cached results or the entries of an LDIF file.
+
+    The equality, approximate, ordering and substring matches compare the
+    values in a case-insensitive manner, like the :class:`LDAPValueList`,
+    and the ordering of integers is numeric. The extensible match supports
+    the caseIgnoreMatch, caseExactMatch and the Active Directory bitwise
+    AND and OR matching rules, the `dn` flag is ignored.
+
+    :param str filter_exp: string of the filter in LDAP search filter \
+    syntax.
+    :raises FilterError: if the filter is malformed.
+    """
+
+    def __init__(self, filter_exp: str) -> None:
+        super().__init__(filter_exp)
+
+    def __repr__(self) -> str:
+        return "<LDAPFilter {0}>".format(str(self))
+
+    def match(self, entry: Dict[str, Any]) -> bool:
+        """
+        Check that the entry matches the filter.
+
+        :param LDAPEntry|dict entry: the entry.
+        :return: True, if the entry matches the filter.
+        :raises ValueError: if the filter has an extensible match with \
+        an unsupported matching rule.
+        """
+        return super().match(entry)
+
+    def filter(self, entries: Iterable[_Entry]) -> Iterator[_Entry]:
+        """
+        Filter entries lazily.
+
+        :param entries: an iterable of LDAPEntry objects or dicts.
+        :return: iterator of the matching entries.
+        """
+        match = super().match
+        return (entry for entry in entries if match(entry))
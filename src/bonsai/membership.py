@@ -0,0 +1,354 @@
+import threading
+import time
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from typing import (
+    Dict,
+    FrozenSet,
+    Hashable,
+    Iterable,
+    List,
+    Optional,
+    Set,
+    Tuple,
+    Union,
+)
+
+from .errors import InvalidDN, NoSuchObjectError
+from .ldapconnection import LDAPConnection, LDAPSearchScope
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+from .utils import escape_filter_exp
+
+MYPY = False
+
+if MYPY:
+    from .pool import ThreadedConnectionPool
+
+#: The OID of the Active Directory matching rule, that follows the chain of
+#: the linked attributes to the root.
+LDAP_MATCHING_RULE_IN_CHAIN = "1.2.840.113556.1.4.1941"
+
+# The capabilities of the Active Directory and the AD LDS servers.
+_AD_CAPABILITIES = ("1.2.840.113556.1.4.800", "1.2.840.113556.1.4.1851")
+
+_UP = "up"
+_DOWN = "down"
+
+
+class _MembershipCache:
+    """
+    Thread-safe memo of the looked up DNs by the direction of the lookup,
+    the values expire after `ttl` seconds. The least recently used values
+    are dropped when the memo holds more than `maxsize` values.
+    """
+
+    def __init__(self, ttl: float, maxsize: int) -> None:
+        self.__ttl = ttl
+        self.__maxsize = maxsize
+        # The values in least recently used order.
+        self.__values: Dict[Hashable, Tuple[float, FrozenSet[LDAPDN]]] = OrderedDict()
+        self.__lock = threading.Lock()
+
+    def get(self, key: Hashable) -> Optional[FrozenSet[LDAPDN]]:
+        with self.__lock:
+            item = self.__values.get(key)
+            if item is None:
+                return None
+            if item[0] < time.monotonic():
+                del self.__values[key]
+                return None
+            self.__values.move_to_end(key)  # type: ignore
+            return item[1]
+
+    def put(self, key: Hashable, value: FrozenSet[LDAPDN]) -> None:
+        with self.__lock:
+            self.__values.pop(key, None)
+            self.__values[key] = (time.monotonic() + self.__ttl, value)
+            while len(self.__values) > self.__maxsize:
+                del self.__values[next(iter(self.__values))]
+
+    def clear(self) -> None:
+        with self.__lock:
+            self.__values.clear()
+
+
+class MembershipResolver:
+    """
+    Resolver of the transitive (nested) group memberships of many
+    principals at once. :meth:`groups_of` collects every group that a
+    principal is a member of directly or through other groups,
+    :meth:`members_of` collects every member of a group and of its
+    nested groups.
+
+    With Active Directory, every principal is resolved by a single search
+    with the :data:`LDAP_MATCHING_RULE_IN_CHAIN` matching rule. Otherwise
+    the membership graph is walked in breadth-first order: the direct
+    groups or members of every DN of a level are looked up together, the
+    requests are pipelined on the connections of the `pool`, and the
+    visited DNs are skipped, thus the cycles of the graph end the walk.
+
+    The results of the lookups are memoized for `ttl` seconds, and they
+    are shared between the calls and the threads that use the resolver.
+    Every call returns new sets, but their :class:`LDAPDN` objects are
+    the memoized ones, which is safe as LDAPDN objects are immutable.
+
+    The members of the large groups are read with the automatic range
+    acquiring of the client (see :attr:`LDAPClient.auto_range_acquire`),
+    thus it has to be enabled.
+
+    :param ThreadedConnectionPool pool: the connection pool.
+    :param str|LDAPDN base: the base DN of the searches for the groups \
+    (and for the members with the in chain matching rule).
+    :param str group_filter: the LDAP filter of the groups.
+    :param str member_attr: the attribute of the groups that lists \
+    their members.
+    :param str memberof_attr: the attribute of the entries that lists \
+    the groups of the entry (e.g. the memberOf of Active Directory or of \
+    the OpenLDAP memberof overlay). If it's set, the groups of the \
+    entries are read from this attribute instead of searching for them.
+    :param bool use_in_chain: use the in chain matching rule. If it's \
+    None, the rule is used with Active Directory servers.
+    :param int pipeline_depth: the maximal number of outstanding requests \
+    on a connection.
+    :param int max_workers: the maximal number of parallel connections, \
+    the default is the pool's maximal number of connections.
+    :param float ttl: the time to live of the memoized results in seconds.
+    :param float timeout: time limit in seconds for each request.
+    :param int maxsize: the maximal number of memoized lookups, the least \
+    recently used ones are dropped above that.
+    :raises ValueError: if the `pipeline_depth`, the `max_workers`, the \
+    `ttl` or the `maxsize` is not positive, or the automatic range \
+    acquiring of the client is disabled.
+    """
+
+    def __init__(
+        self,
+        pool: "ThreadedConnectionPool",
+        base: Optional[Union[str, LDAPDN]] = None,
+        group_filter: str = "(|(objectClass=group)(objectClass=groupOfNames))",
+        member_attr: str = "member",
+        memberof_attr: Optional[str] = None,
+        use_in_chain: Optional[bool] = None,
+        pipeline_depth: int = 16,
+        max_workers: Optional[int] = None,
+        ttl: float = 300.0,
+        timeout: Optional[float] = None,
+        maxsize: int = 100000,
+    ) -> None:
+        if pipeline_depth < 1:
+            raise ValueError("The pipeline_depth must be positive.")
+        if max_workers is not None and max_workers < 1:
+            raise ValueError("The max_workers must be positive.")
+        if ttl <= 0:
+            raise ValueError("The ttl must be positive.")
+        if maxsize < 1:
+            raise ValueError("The maxsize must be positive.")
+        if not pool.client.auto_range_acquire:
+            raise ValueError("The auto_range_acquire of the client must be enabled.")
+        self.__pool = pool
+        self.__base = LDAPDN(str(base if base is not None else pool.client.url.basedn))
+        if not group_filter.startswith("("):
+            group_filter = "({0})".format(group_filter)
+        self.__group_filter = group_filter
+        self.__member_attr = member_attr
+        self.__memberof_attr = memberof_attr
+        self.__use_in_chain = use_in_chain
+        self.__pipeline_depth = pipeline_depth
+        self.__max_workers = max_workers
+        self.__timeout = timeout
+        self.__cache = _MembershipCache(ttl, maxsize)
+
+    @property
+    def use_in_chain(self) -> bool:
+        """
+        Whether the in chain matching rule is used. It's checked on the
+        server's root DSE at the first access, if it's not set.
+        """
+        if self.__use_in_chain is None:
+            with self.__pool.spawn() as conn:
+                root_dse = conn.search(
+                    "",
+                    LDAPSearchScope.BASE,
+                    "(objectClass=*)",
+                    ["supportedCapabilities"],
+                    self.__timeout,
+                )
+            caps = root_dse[0].get("supportedCapabilities", []) if root_dse else []
+            self.__use_in_chain = any(cap in caps for cap in _AD_CAPABILITIES)
+        return self.__use_in_chain
+
+    def groups_of(
+        self, principals: Iterable[Union[str, LDAPDN]]
+    ) -> Dict[LDAPDN, Set[LDAPDN]]:
+        """
+        Get the groups of the principals, including the groups of their
+        groups.
+
+        :param list principals: the DNs of the users, groups or other \
+        entries.
+        :return: the set of the group DNs by the principal DNs.
+        :rtype: dict
+        """
+        return self.__resolve(principals, _UP)
+
+    def members_of(
+        self, groups: Iterable[Union[str, LDAPDN]]
+    ) -> Dict[LDAPDN, Set[LDAPDN]]:
+        """
+        Get the members of the groups, including the members of their
+        nested groups. The nested groups are members too.
+
+        :param list groups: the DNs of the groups.
+        :return: the set of the member DNs by the group DNs.
+        :rtype: dict
+        """
+        return self.__resolve(groups, _DOWN)
+
+    def clear_cache(self) -> None:
+        """ Drop every memoized result. """
+        self.__cache.clear()
+
+    def __resolve(
+        self, dnames: Iterable[Union[str, LDAPDN]], direction: str
+    ) -> Dict[LDAPDN, Set[LDAPDN]]:
+        starts = [LDAPDN(str(dname)) for dname in dnames]
+        if self.use_in_chain:
+            closures = self.__lookup(starts, direction + "*")
+            return {dname: set(closures[dname]) for dname in starts}
+        # Walk the graph level by level, looking up the DNs of a level
+        # together. The edges of the visited DNs are not followed again.
+        edges: Dict[LDAPDN, FrozenSet[LDAPDN]] = {}
+        level = set(starts)
+        while level:
+            edges.update(self.__lookup(list(level), direction))
+            level = {
+                target
+                for dname in level
+                for target in edges[dname]
+                if target not in edges
+            }
+        result = {}
+        for start in starts:
+            reached: Set[LDAPDN] = set()
+            stack = list(edges[start])
+            while stack:
+                dname = stack.pop()
+                if dname not in reached:
+                    reached.add(dname)
+                    stack.extend(edges[dname])
+            reached.discard(start)
+            result[start] = reached
+        return result
+
+    def __lookup(
+        self, dnames: List[LDAPDN], kind: str
+    ) -> Dict[LDAPDN, FrozenSet[LDAPDN]]:
+        """
+        Get the memoized results of the DNs, and look up the rest on the
+        connections of the pool in parallel.
+        """
+        result: Dict[LDAPDN, FrozenSet[LDAPDN]] = {}
+        missing = []
+        for dname in dnames:
+            value = self.__cache.get((kind, dname))
+            if value is None:
+                missing.append(dname)
+            else:
+                result[dname] = value
+        if not missing:
+            return result
+        workers = min(self.__max_workers or self.__pool.max_connection, len(missing))
+        chunks = [missing[num::workers] for num in range(workers)]
+        if workers == 1:
+            found = [self.__lookup_on_conn(chunks[0], kind)]
+        else:
+            with ThreadPoolExecutor(max_workers=workers) as executor:
+                found = list(
+                    executor.map(
+                        lambda chunk: self.__lookup_on_conn(chunk, kind), chunks
+                    )
+                )
+        for part in found:
+            for dname, value in part.items():
+                self.__cache.put((kind, dname), value)
+                result[dname] = value
+        return result
+
+    def __lookup_on_conn(
+        self, dnames: List[LDAPDN], kind: str
+    ) -> Dict[LDAPDN, FrozenSet[LDAPDN]]:
+        """
+        Send the requests of the DNs on a single connection, keeping at
+        most `pipeline_depth` of them outstanding.
+        """
+        result: Dict[LDAPDN, FrozenSet[LDAPDN]] = {}
+        with self.__pool.spawn() as conn:
+            pending: List[Tuple[LDAPDN, int]] = []
+            todo = iter(dnames)
+            try:
+                for dname in todo:
+                    pending.append((dname, self.__request(conn, dname, kind)))
+                    if len(pending) >= self.__pipeline_depth:
+                        dname, msg_id = pending.pop(0)
+                        result[dname] = self.__receive(conn, msg_id, kind)
+                while pending:
+                    dname, msg_id = pending.pop(0)
+                    result[dname] = self.__receive(conn, msg_id, kind)
+            except BaseException:
+                for _, msg_id in pending:
+                    conn._abandon_unwaited(msg_id)
+                raise
+        return result
+
+    def __request(self, conn: LDAPConnection, dname: LDAPDN, kind: str) -> int:
+        value = escape_filter_exp(str(dname))
+        if kind == _UP + "*":
+            filter_exp = "(&{0}({1}:{2}:={3}))".format(
+                self.__group_filter,
+                self.__member_attr,
+                LDAP_MATCHING_RULE_IN_CHAIN,
+                value,
+            )
+        elif kind == _DOWN + "*":
+            filter_exp = "({0}:{1}:={2})".format(
+                self.__memberof_attr or "memberOf", LDAP_MATCHING_RULE_IN_CHAIN, value
+            )
+        elif kind == _UP and self.__memberof_attr is None:
+            filter_exp = "(&{0}({1}={2}))".format(
+                self.__group_filter, self.__member_attr, value
+            )
+        else:
+            # Read the attribute that links the entry to the next level.
+            attr = self.__member_attr if kind == _DOWN else self.__memberof_attr
+            return conn._search_request(
+                dname, LDAPSearchScope.BASE, "(objectClass=*)", [attr], self.__timeout
+            )
+        return conn._search_request(
+            self.__base, LDAPSearchScope.SUBTREE, filter_exp, ["1.1"], self.__timeout
+        )
+
+    def __receive(
+        self, conn: LDAPConnection, msg_id: int, kind: str
+    ) -> FrozenSet[LDAPDN]:
+        try:
+            res = conn._evaluate(msg_id, self.__timeout)
+        except NoSuchObjectError:
+            # A dangling reference to a deleted entry.
+            return frozenset()
+        entries = [ent for ent in res if isinstance(ent, LDAPEntry)]
+        if kind.endswith("*") or (kind == _UP and self.__memberof_attr is None):
+            return frozenset(ent.dn for ent in entries)
+        conn._acquire_ranges(entries, self.__timeout)
+        attr = self.__member_attr if kind == _DOWN else self.__memberof_attr
+        targets = set()
+        for ent in entries:
+            for value in ent.get(attr, []):
+                try:
+                    targets.add(LDAPDN(str(value)))
+                except InvalidDN:
+                    continue
+        return frozenset(targets)
+
+
+__all__ = ["LDAP_MATCHING_RULE_IN_CHAIN", "MembershipResolver"]
@@ -0,0 +1,204 @@
+from enum import IntFlag
+from typing import Any, AsyncIterator, Dict, Iterator, List, NamedTuple, Optional, Union
+
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+from .searchcache import SearchCache
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import BaseLDAPConnection, LDAPSearchScope
+
+AD_NOTIFICATION = 1
+PERSISTENT_SEARCH = 2
+
+
+class ChangeType(IntFlag):
+    """ The types of changes of a persistent search. """
+
+    ADD = 1
+    DELETE = 2
+    MODIFY = 4
+    MODDN = 8
+    ALL = 15
+
+
+class ChangeEvent(NamedTuple):
+    """
+    A changed entry. The `change_type`, the `previous_dn` of a renamed
+    entry and the `change_number` are set from the entry change
+    notification of a persistent search, the Active Directory change
+    notification only sends the entry.
+    """
+
+    entry: LDAPEntry
+    change_type: Optional[ChangeType]
+    previous_dn: Optional[LDAPDN]
+    change_number: Optional[int]
+
+
+class ChangeNotifier:
+    """
+    Client of the long-running searches, that return the entries as they
+    are changed: the Active Directory change notification and the
+    persistent search of OpenLDAP and 389 Directory Server. The search is
+    kept open by the :meth:`listen` and :meth:`listen_async` methods,
+    until the notifier is closed or the server ends the search.
+
+    Active Directory accepts only the `(objectClass=*)` filter with base
+    or one level scope for the change notification, and it returns the
+    whole changed entry without the type of the change.
+
+    If `search_cache` is set, the results of the changed entries are
+    dropped from it as the changes are received.
+
+    :param conn: the connection.
+    :param str|LDAPDN base: the base DN of the search.
+    :param int scope: the scope of the search.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param int mode: :data:`PERSISTENT_SEARCH` or :data:`AD_NOTIFICATION`.
+    :param ChangeType change_types: the types of the changes to receive \
+    with a persistent search.
+    :param bool changes_only: if False, the persistent search returns the \
+    matching entries first.
+    :param SearchCache search_cache: the cache to invalidate.
+    :raises ValueError: if the mode is invalid.
+    """
+
+    def __init__(
+        self,
+        conn: "BaseLDAPConnection",
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union["LDAPSearchScope", int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        mode: int = PERSISTENT_SEARCH,
+        change_types: ChangeType = ChangeType.ALL,
+        changes_only: bool = True,
+        search_cache: Optional[SearchCache] = None,
+    ) -> None:
+        if mode not in (AD_NOTIFICATION, PERSISTENT_SEARCH):
+            raise ValueError("The mode must be PERSISTENT_SEARCH or AD_NOTIFICATION.")
+        self.__conn = conn
+        self.__base = base
+        self.__scope = scope
+        self.__filter_exp = filter_exp
+        self.__attrlist = attrlist
+        self.__mode = mode
+        self.__change_types = int(change_types)
+        self.__changes_only = changes_only
+        self.__search_cache = search_cache
+        # The message ID of the open search.
+        self.__msg_id: Optional[int] = None
+
+    def __enter__(self) -> "ChangeNotifier":
+        return self
+
+    def __exit__(self, type, value, traceback) -> None:
+        self.close()
+
+    @property
+    def search_cache(self) -> Optional[SearchCache]:
+        """ The cache, that is invalidated by the received changes. """
+        return self.__search_cache
+
+    def listen(self, timeout: Optional[float] = None) -> Iterator[ChangeEvent]:
+        """
+        Start the search, if it's not open yet, and yield the changed
+        entries as the server sends them. The iteration stops when the
+        server ends the search, or when no change is received in
+        `timeout` seconds. In the latter case the search is kept open and
+        calling this method again continues it.
+
+        :param float timeout: time limit in seconds to wait for a change.
+        :return: iterator of the changes.
+        """
+        if self.__msg_id is None:
+            self.__msg_id = self.__request()
+        while self.__msg_id is not None:
+            events = self.__receive(self.__msg_id, timeout)
+            if events is None:
+                return
+            yield from self.__process(events)
+
+    async def listen_async(self) -> AsyncIterator[ChangeEvent]:
+        """
+        The same as :meth:`listen` for asynchronous connections, without
+        a timeout. Cancelling the consuming task abandons the search.
+
+        :return: asynchronous iterator of the changes.
+        """
+        if self.__msg_id is None:
+            self.__msg_id = self.__request()
+        while self.__msg_id is not None:
+            msg_id = self.__msg_id
+            received = False
+            try:
+                events = await self.__conn._evaluate(msg_id)
+                received = True
+            finally:
+                if not received:
+                    self.__drop(msg_id)
+            for event in self.__process(events):
+                yield event
+
+    def close(self) -> None:
+        """ Abandon the open search. """
+        if self.__msg_id is not None:
+            msg_id = self.__msg_id
+            self.__msg_id = None
+            self.__conn._abandon_unwaited(msg_id)
+
+    def __request(self) -> int:
+        return self.__conn._search_request(
+            self.__base,
+            self.__scope,
+            self.__filter_exp,
+            self.__attrlist,
+            notify_mode=self.__mode,
+            psearch_types=self.__change_types,
+            psearch_changes_only=self.__changes_only,
+        )
+
+    def __receive(
+        self, msg_id: int, timeout: Optional[float]
+    ) -> Optional[List[Dict[str, Any]]]:
+        received = False
+        try:
+            events = self.__conn._evaluate(msg_id, timeout)
+            received = True
+        finally:
+            if not received:
+                self.__drop(msg_id)
+        return events
+
+    def __drop(self, msg_id: int) -> None:
+        # The result of the search is failed or no longer waited for.
+        if msg_id == self.__msg_id:
+            self.close()
+
+    def __process(self, events: List[Dict[str, Any]]) -> List[ChangeEvent]:
+        changes = []
+        for event in events:
+            if event["type"] == "done":
+                self.__msg_id = None
+                continue
+            entry = event["entry"]
+            change_type = event["change_type"]
+            prev_dn = event["previous_dn"]
+            change = ChangeEvent(
+                entry,
+                ChangeType(change_type) if change_type is not None else None,
+                LDAPDN(prev_dn) if prev_dn is not None else None,
+                event["change_number"],
+            )
+            if self.__search_cache is not None:
+                self.__search_cache.invalidate(entry.dn)
+                if change.previous_dn is not None:
+                    self.__search_cache.invalidate(change.previous_dn)
+            changes.append(change)
+        return changes
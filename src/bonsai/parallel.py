@@ -0,0 +1,477 @@
+import queue
+import string
+import threading
+from concurrent.futures import FIRST_COMPLETED, Future, ThreadPoolExecutor, wait
+from typing import (
+    Any,
+    Dict,
+    FrozenSet,
+    Iterator,
+    List,
+    NamedTuple,
+    Optional,
+    Sequence,
+    Set,
+    Tuple,
+    Union,
+)
+
+from .errors import SizeLimitError
+from .ldapconnection import LDAPConnection, LDAPSearchScope
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+from .utils import escape_filter_exp
+
+MYPY = False
+
+if MYPY:
+    from .pool import ThreadedConnectionPool
+
+# The first characters of the values that the prefix partitioning splits by.
+_PREFIX_CHARS = string.ascii_lowercase + string.digits
+
+
+class _Piece(NamedTuple):
+    """ A part of a split search. """
+
+    base: LDAPDN
+    scope: LDAPSearchScope
+    # Additional filter components of the piece.
+    conds: Tuple[str, ...] = ()
+    # The index of the attribute in the split attributes that the piece
+    # is partitioned by.
+    attr_idx: int = 0
+    # The value prefix of the split attribute, None if it's not partitioned.
+    prefix: Optional[str] = None
+    # Matches the values with the prefix that none of the longer prefixes
+    # match, it can't be split any further.
+    complement: bool = False
+
+
+class _SplitSearch:
+    def __init__(
+        self,
+        pool: "ThreadedConnectionPool",
+        filter_exp: str,
+        attrlist: Optional[List[str]],
+        timeout: Optional[float],
+        sizelimit: int,
+        attrsonly: bool,
+        split_attrs: Sequence[str],
+        max_depth: int,
+    ) -> None:
+        self.pool = pool
+        self.filter_exp = filter_exp
+        self.attrlist = attrlist
+        self.timeout = timeout
+        self.sizelimit = sizelimit
+        self.attrsonly = attrsonly
+        self.split_attrs = split_attrs
+        self.max_depth = max_depth
+
+    def get_filter(self, piece: _Piece) -> str:
+        parts = [self.filter_exp]
+        parts.extend(piece.conds)
+        if piece.prefix is not None:
+            attr = self.split_attrs[piece.attr_idx]
+            prefix = escape_filter_exp(piece.prefix)
+            parts.append("({0}={1}*)".format(attr, prefix))
+            if piece.complement:
+                parts.append(
+                    "(!(|{0}))".format(
+                        "".join(
+                            "({0}={1}{2}*)".format(attr, prefix, char)
+                            for char in _PREFIX_CHARS
+                        )
+                    )
+                )
+        if len(parts) == 1:
+            return parts[0]
+        return "(&{0})".format("".join(parts))
+
+    def run(self, piece: _Piece) -> Tuple[List[LDAPEntry], List[_Piece]]:
+        """
+        Search the piece, and return the entries, or the smaller pieces
+        if the piece exceeds the size limit.
+        """
+        with self.pool.spawn() as conn:
+            try:
+                return (
+                    conn.search(
+                        piece.base,
+                        piece.scope,
+                        self.get_filter(piece),
+                        self.attrlist,
+                        self.timeout,
+                        self.sizelimit,
+                        self.attrsonly,
+                    ),
+                    [],
+                )
+            except SizeLimitError:
+                pieces = self.split(conn, piece)
+                if not pieces:
+                    raise
+                return [], pieces
+
+    def split(self, conn: LDAPConnection, piece: _Piece) -> List[_Piece]:
+        if piece.scope == LDAPSearchScope.BASE or piece.complement:
+            return []
+        if piece.scope == LDAPSearchScope.SUBTREE and piece == _Piece(
+            piece.base, piece.scope
+        ):
+            try:
+                children = conn.search(
+                    piece.base,
+                    LDAPSearchScope.ONELEVEL,
+                    attrlist=["1.1"],
+                    timeout=self.timeout,
+                    sizelimit=self.sizelimit,
+                )
+                return [_Piece(piece.base, LDAPSearchScope.BASE)] + [
+                    _Piece(child.dn, LDAPSearchScope.SUBTREE) for child in children
+                ]
+            except SizeLimitError:
+                # Too many children to list, partition by values instead.
+                pass
+        if piece.attr_idx >= len(self.split_attrs):
+            return []
+        prefix = piece.prefix or ""
+        if len(prefix) >= self.max_depth:
+            return []
+        pieces = [piece._replace(prefix=prefix + char) for char in _PREFIX_CHARS]
+        pieces.append(piece._replace(prefix=prefix, complement=True))
+        if piece.prefix is None:
+            # The entries without the attribute are partitioned by the next one.
+            attr = self.split_attrs[piece.attr_idx]
+            pieces.append(
+                piece._replace(
+                    conds=piece.conds + ("(!({0}=*))".format(attr),),
+                    attr_idx=piece.attr_idx + 1,
+                )
+            )
+        return pieces
+
+
+def split_search(
+    pool: "ThreadedConnectionPool",
+    base: Optional[Union[str, LDAPDN]] = None,
+    scope: Union[LDAPSearchScope, int] = LDAPSearchScope.SUBTREE,
+    filter_exp: Optional[str] = None,
+    attrlist: Optional[List[str]] = None,
+    timeout: Optional[float] = None,
+    sizelimit: int = 0,
+    attrsonly: bool = False,
+    split_attrs: Sequence[str] = ("cn", "uid", "ou"),
+    max_depth: int = 3,
+    max_workers: Optional[int] = None,
+) -> List[LDAPEntry]:
+    """
+    Search the directory, and split the search into smaller ones when
+    it exceeds the size limit (either the client's `sizelimit` or the
+    server's administrative limit). A subtree search is split into the
+    search of the base entry and the searches of the subtrees of its
+    children. If the children can't be listed, or the scope is one level,
+    the filter is partitioned by the first characters of the values of
+    the first attribute in `split_attrs`, and each partition that still
+    exceeds the limit is split further by longer prefixes, up to
+    `max_depth` characters. The entries without the attribute are
+    partitioned by the next one in the list. The parts run in parallel on
+    the connections of the `pool`, and the results are merged and
+    deduplicated by DN.
+
+    :param ThreadedConnectionPool pool: the connection pool.
+    :param str|LDAPDN base: the base DN of the search.
+    :param int scope: the scope of the search.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param float timeout: time limit in seconds for each search.
+    :param int sizelimit: the size limit of each search.
+    :param bool attrsonly: if it's set True, search only the attribute's \
+    names without values.
+    :param list split_attrs: the attributes for the prefix partitioning.
+    :param int max_depth: the maximal length of the prefixes.
+    :param int max_workers: the maximal number of parallel searches, \
+    the default is the pool's maximal number of connections.
+    :return: the list of the found entries.
+    :rtype: list
+    :raises SizeLimitError: if a part of the search can't be split any \
+    further, but it still exceeds the size limit.
+    """
+    if base is None:
+        base = pool.client.url.basedn
+    if not filter_exp:
+        filter_exp = "(objectClass=*)"
+    elif not filter_exp.startswith("("):
+        filter_exp = "({0})".format(filter_exp)
+    search = _SplitSearch(
+        pool, filter_exp, attrlist, timeout, sizelimit, attrsonly, split_attrs, max_depth
+    )
+    results: Dict[LDAPDN, LDAPEntry] = {}
+    with ThreadPoolExecutor(max_workers=max_workers or pool.max_connection) as executor:
+        pending: Set[Future] = {
+            executor.submit(
+                search.run, _Piece(LDAPDN(str(base)), LDAPSearchScope(scope))
+            )
+        }
+        try:
+            while pending:
+                done, pending = wait(pending, return_when=FIRST_COMPLETED)
+                for future in done:
+                    entries, pieces = future.result()
+                    for entry in entries:
+                        results.setdefault(entry.dn, entry)
+                    for piece in pieces:
+                        pending.add(executor.submit(search.run, piece))
+        except BaseException:
+            for future in pending:
+                future.cancel()
+            raise
+    return list(results.values())
+
+
+class _Subtree(NamedTuple):
+    """ A part of a parallel search. """
+
+    base: LDAPDN
+    scope: LDAPSearchScope
+    # The already returned entries of the part, when it's split from
+    # an abandoned search.
+    skip: FrozenSet[LDAPDN] = frozenset()
+
+
+class _FanOut:
+    def __init__(
+        self,
+        pool: "ThreadedConnectionPool",
+        filter_exp: Optional[str],
+        attrlist: Optional[List[str]],
+        timeout: Optional[float],
+        attrsonly: bool,
+        page_size: int,
+        split_threshold: int,
+        parallelism: int,
+    ) -> None:
+        self.pool = pool
+        self.filter_exp = filter_exp
+        self.attrlist = attrlist
+        self.timeout = timeout
+        self.attrsonly = attrsonly
+        self.page_size = page_size
+        self.split_threshold = split_threshold
+        self.parallelism = parallelism
+        # The pages, the finished and the failed parts from the workers.
+        self.output: "queue.Queue[Tuple[str, Any]]" = queue.Queue(
+            maxsize=parallelism * 2
+        )
+        self.stopped = threading.Event()
+        self.__active = 0
+        self.__lock = threading.Lock()
+
+    def submitted(self, num: int) -> None:
+        with self.__lock:
+            self.__active += num
+
+    def has_idle_worker(self) -> bool:
+        with self.__lock:
+            return self.__active < self.parallelism
+
+    def run(self, part: _Subtree) -> None:
+        try:
+            parts = self.search(part)
+        except BaseException as exc:
+            with self.__lock:
+                self.__active -= 1
+            self.output.put(("error", exc))
+        else:
+            with self.__lock:
+                self.__active -= 1
+            self.output.put(("done", parts))
+
+    def emit(self, part: _Subtree, entries: List[LDAPEntry]) -> List[LDAPEntry]:
+        if part.skip:
+            entries = [entry for entry in entries if entry.dn not in part.skip]
+        if entries:
+            self.output.put(("page", entries))
+        return entries
+
+    def search(self, part: _Subtree) -> List[_Subtree]:
+        """
+        Search the part page by page, and return the smaller parts, if the
+        part turns out to be large while other workers are idle.
+        """
+        with self.pool.spawn() as conn:
+            if part.scope == LDAPSearchScope.BASE:
+                self.emit(
+                    part,
+                    conn.search(
+                        part.base,
+                        part.scope,
+                        self.filter_exp,
+                        self.attrlist,
+                        self.timeout,
+                        attrsonly=self.attrsonly,
+                    ),
+                )
+                return []
+            result = conn.paged_search(
+                part.base,
+                part.scope,
+                self.filter_exp,
+                self.attrlist,
+                self.timeout,
+                attrsonly=self.attrsonly,
+                page_size=self.page_size,
+            )
+            returned = 0
+            # The DNs of the emitted entries, to skip them if the part is split.
+            emitted: Set[LDAPDN] = set()
+            msg_id = None
+            try:
+                while not self.stopped.is_set():
+                    page = [next(result) for _ in range(len(result))]
+                    emitted.update(entry.dn for entry in self.emit(part, page))
+                    returned += len(page)
+                    msg_id = result.acquire_next_page()
+                    if msg_id is None:
+                        break
+                    if returned >= self.split_threshold and self.has_idle_worker():
+                        conn._abandon_unwaited(msg_id)
+                        msg_id = None
+                        return split_subtree(
+                            conn, part.base, self.timeout, part.skip | emitted
+                        )
+                    result = conn._evaluate(msg_id, self.timeout)
+                    msg_id = None
+            finally:
+                if msg_id is not None:
+                    # The requested page is not waited for any more.
+                    conn._abandon_unwaited(msg_id)
+            return []
+
+
+def split_subtree(
+    conn: LDAPConnection,
+    base: LDAPDN,
+    timeout: Optional[float],
+    skip: FrozenSet[LDAPDN] = frozenset(),
+) -> List[_Subtree]:
+    """
+    Split the subtree to the base entry and the subtrees of its children,
+    that skip the entries in `skip`.
+    """
+    children = conn.search(
+        base, LDAPSearchScope.ONELEVEL, attrlist=["1.1"], timeout=timeout
+    )
+    return [_Subtree(base, LDAPSearchScope.BASE, skip)] + [
+        _Subtree(child.dn, LDAPSearchScope.SUBTREE, skip) for child in children
+    ]
+
+
+def parallel_search(
+    pool: "ThreadedConnectionPool",
+    base: Optional[Union[str, LDAPDN]] = None,
+    filter_exp: Optional[str] = None,
+    attrlist: Optional[List[str]] = None,
+    parallelism: Optional[int] = None,
+    timeout: Optional[float] = None,
+    attrsonly: bool = False,
+    page_size: int = 100,
+    split_threshold: int = 1000,
+) -> Iterator[LDAPEntry]:
+    """
+    Search the subtree of the `base` by running paged searches on the
+    subtrees of its children concurrently, on the connections of the
+    `pool`, and yield the entries of the received pages as they arrive.
+    When a subtree search returns more than `split_threshold` entries
+    while some of the workers are idle, the search is abandoned and the
+    subtree is split further by its children. The entries that are
+    returned again by the searches of the split parts are skipped.
+
+    The order of the entries is not defined.
+
+    :param ThreadedConnectionPool pool: the connection pool.
+    :param str|LDAPDN base: the base DN of the search.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param int parallelism: the number of concurrent searches, the \
+    default is the pool's maximal number of connections.
+    :param float timeout: time limit in seconds for each operation.
+    :param bool attrsonly: if it's set True, search only the attribute's \
+    names without values.
+    :param int page_size: the page size of the subtree searches.
+    :param int split_threshold: the number of entries of a subtree search \
+    above that the subtree is split, when some workers are idle.
+    :return: iterator of the found entries.
+    :raises ValueError: if the `parallelism`, the `page_size` or the \
+    `split_threshold` is less than 1.
+    """
+    if parallelism is None:
+        parallelism = pool.max_connection
+    if parallelism < 1:
+        raise ValueError("The parallelism must be positive.")
+    if page_size < 1:
+        raise ValueError("The page_size must be positive.")
+    if split_threshold < 1:
+        raise ValueError("The split_threshold must be positive.")
+    return _parallel_search(
+        pool,
+        LDAPDN(str(base if base is not None else pool.client.url.basedn)),
+        _FanOut(
+            pool,
+            filter_exp,
+            attrlist,
+            timeout,
+            attrsonly,
+            page_size,
+            split_threshold,
+            parallelism,
+        ),
+    )
+
+
+def _parallel_search(
+    pool: "ThreadedConnectionPool", base: LDAPDN, fanout: _FanOut
+) -> Iterator[LDAPEntry]:
+    with pool.spawn() as conn:
+        parts = split_subtree(conn, base, fanout.timeout)
+    executor = ThreadPoolExecutor(max_workers=fanout.parallelism)
+    futures: List[Future] = []
+    running = 0
+    try:
+        while True:
+            if parts:
+                fanout.submitted(len(parts))
+                running += len(parts)
+                futures = [future for future in futures if not future.done()]
+                futures.extend(executor.submit(fanout.run, part) for part in parts)
+            if not running:
+                break
+            kind, payload = fanout.output.get()
+            parts = []
+            if kind == "page":
+                yield from payload
+            elif kind == "done":
+                running -= 1
+                parts = payload
+            else:
+                raise payload
+    finally:
+        # Stop the workers after their current page.
+        fanout.stopped.set()
+        for future in futures:
+            future.cancel()
+        # Unblock the workers that wait on the full output, and wait for
+        # them to put their connections back to the pool.
+        while futures:
+            try:
+                while True:
+                    fanout.output.get_nowait()
+            except queue.Empty:
+                pass
+            futures = list(wait(futures, timeout=0.1).not_done)
+        executor.shutdown()
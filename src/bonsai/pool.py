@@ -1,7 +1,21 @@
 import logging
 import threading
+import time
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from contextlib import contextmanager
-from typing import Optional, Any, Set, Generic, TypeVar, Generator
+from typing import (
+    Optional,
+    Any,
+    Deque,
+    Dict,
+    List,
+    Set,
+    Generic,
+    Tuple,
+    TypeVar,
+    Generator,
+)
 
 from .ldapconnection import BaseLDAPConnection, LDAPConnection
 
@@ -44,35 +58,101 @@ class ConnectionPool(Generic[T]):
     :param int minconn: the minimum number of connections that's created
                 after the pool is opened.
     :param int maxconn: the maximum number of connections in the pool.
+    :param int warmup_limit: the maximum number of connections that are
+                opened concurrently when the pool is opened.
     :param \\*\\*kwargs: additional keyword arguments that are passed to
                 the :meth:`bonsai.LDAPClient.connect` method.
-    :raises ValueError: when the minconn is negative or the maxconn is less
-        than the minconn.
+    :raises ValueError: when the minconn is negative, the maxconn is less
+        than the minconn or the warmup_limit is less than 1.
     """
 
     def __init__(
-        self, client: "LDAPClient", minconn: int = 1, maxconn: int = 10, **kwargs: Any
+        self,
+        client: "LDAPClient",
+        minconn: int = 1,
+        maxconn: int = 10,
+        warmup_limit: int = 8,
+        **kwargs: Any,
     ) -> None:
         """Init method."""
         if minconn < 0:
             raise ValueError("The minconn must be positive.")
         if minconn > maxconn:
             raise ValueError("The maxconn must be greater than minconn.")
+        if warmup_limit < 1:
+            raise ValueError("The warmup_limit must be at least 1.")
         self._minconn = minconn
         self._maxconn = maxconn
+        self._warmup_limit = warmup_limit
         self._client = client
         self._kwargs = kwargs
         self._closed = True
-        self._idles: Set[T] = set()
+        # Idle connections are reused in LIFO order.
+        self._idles: Deque[T] = deque()
         self._used: Set[T] = set()
+        self._warmup_errors: List[Exception] = []
 
     def open(self) -> None:
         """
         Open the connection pool by initialising the minimal number of
-        connections.
+        connections. At most `warmup_limit` connections are opened
+        concurrently, each in a separate thread.
+
+        If some of the connections fail to open, the pool is opened with
+        the successful ones, and the errors are available in the
+        :attr:`warmup_errors` list. If all of them fail, the first
+        error is raised.
+        """
+        num = self._minconn - self.idle_connection - self.shared_connection
+        conns, errors = self._open_connections(num)
+        self._finish_warmup(conns, errors)
+
+    def _open_connections(self, num: int) -> Tuple[List[T], List[Exception]]:
+        """
+        Open `num` new connections, at most `warmup_limit` concurrently,
+        and return the opened connections and the errors.
+        """
+        conns: List[T] = []
+        errors: List[Exception] = []
+        if num == 1 or (num > 1 and self._warmup_limit == 1):
+            for _ in range(num):
+                try:
+                    conns.append(self._client.connect(**self._kwargs))
+                except Exception as exc:
+                    errors.append(exc)
+                    if not conns:
+                        # Fail fast, the rest would most likely fail too.
+                        break
+        elif num > 1:
+            with ThreadPoolExecutor(min(num, self._warmup_limit)) as executor:
+                futures = [
+                    executor.submit(self._client.connect, **self._kwargs)
+                    for _ in range(num)
+                ]
+                for fut in as_completed(futures):
+                    if fut.cancelled():
+                        continue
+                    try:
+                        conns.append(fut.result())
+                    except Exception as exc:
+                        errors.append(exc)
+                        if not conns:
+                            # Fail fast, cancel the connections not started yet.
+                            for pending in futures:
+                                pending.cancel()
+        return conns, errors
+
+    def _finish_warmup(self, conns: List[T], errors: List[Exception]) -> None:
+        """
+        Add the newly opened connections to the idles and set the pool
+        opened, or raise the first error if none of them is opened.
         """
-        for _ in range(self._minconn - self.idle_connection - self.shared_connection):
-            self._idles.add(self._client.connect(**self._kwargs))
+        self._idles.extend(conns)
+        self._warmup_errors = errors
+        if errors and not conns:
+            raise errors[0]
+        for exc in errors:
+            logger.warning(f"Failed to open connection during warm-up: {exc}")
         self._closed = False
 
     def get(self) -> T:
@@ -87,7 +167,7 @@ class ConnectionPool(Generic[T]):
             raise ClosedPool("The pool is closed.")
         try:
             conn = self._idles.pop()
-        except KeyError:
+        except IndexError:
             if len(self._used) < self._maxconn:
                 conn = self._client.connect(**self._kwargs)
             else:
@@ -112,7 +192,7 @@ class ConnectionPool(Generic[T]):
         try:
             self._used.remove(conn)
             if not conn.closed:
-                self._idles.add(conn)
+                self._idles.append(conn)
         except KeyError:
             raise PoolError("The %r is not managed by this pool." % conn) from None
 
@@ -133,7 +213,7 @@ class ConnectionPool(Generic[T]):
                     f"Exception is raised during closing used connection: {exc}"
                 )
         self._closed = True
-        self._idles = set()
+        self._idles = deque()
         self._used = set()
 
     @contextmanager
@@ -174,6 +254,19 @@ class ConnectionPool(Generic[T]):
         """
         return self._closed
 
+    @property
+    def client(self) -> "LDAPClient":
+        """The client that's used to create the connections of the pool."""
+        return self._client
+
+    @property
+    def warmup_errors(self) -> List[Exception]:
+        """
+        The list of errors raised by the connections that failed to open
+        during the last call of :meth:`open`.
+        """
+        return self._warmup_errors
+
     @property
     def shared_connection(self) -> int:
         """The number of shared connections."""
@@ -197,11 +290,27 @@ class ConnectionPool(Generic[T]):
         self._maxconn = val
 
 
+class _Waiter:
+    """A thread waiting in the queue of a ThreadedConnectionPool."""
+
+    __slots__ = ("event", "conn", "create", "closed")
+
+    def __init__(self) -> None:
+        self.event = threading.Event()
+        self.conn: Optional[LDAPConnection] = None
+        self.create = False
+        self.closed = False
+
+
 class ThreadedConnectionPool(ConnectionPool[LDAPConnection]):
     """
     A connection pool that can be shared between threads. It's inherited from
     :class:`bonsai.pool.ConnectionPool`.
 
+    The threads that are blocked in :meth:`get` are served in FIFO order,
+    and the idle connections are reused in LIFO order. Connections are
+    opened and closed without holding the pool's lock.
+
     :param LDAPClient client: the :class:`bonsai.LDAPClient` that's used to create
                 connections.
     :param int minconn: the minimum number of connections that's created
@@ -209,10 +318,23 @@ class ThreadedConnectionPool(ConnectionPool[LDAPConnection]):
     :param int maxconn: the maximum number of connections in the pool.
     :param bool block: when it's True, the get method will block when no
                 connection is available in the pool.
+    :param int warmup_limit: the maximum number of connections that are
+                opened concurrently when the pool is opened.
+    :param float idle_timeout: the number of seconds after an idle connection
+                is closed, while the pool has more than `minconn` connections.
+    :param float max_lifetime: the number of seconds after a connection is
+                closed and replaced, instead of being reused.
+    :param float maintenance_interval: when it's set, a background thread
+                checks the pool in every `maintenance_interval` seconds,
+                closes the expired connections and refills the pool to
+                `minconn` connections. Without it, the expired and timed
+                out idle connections are closed only when :meth:`get` or
+                :meth:`put` is called.
     :param \\*\\*kwargs: additional keyword arguments that are passed to
                 the :meth:`bonsai.LDAPClient.connect` method.
-    :raises ValueError: when the minconn is negative or the maxconn is less
-        than the minconn.
+    :raises ValueError: when the minconn is negative, the maxconn is less
+        than the minconn, the warmup_limit is less than 1 or any of the
+        timeout parameters is not positive.
     """
 
     def __init__(
@@ -221,39 +343,318 @@ class ThreadedConnectionPool(ConnectionPool[LDAPConnection]):
         minconn: int = 1,
         maxconn: int = 10,
         block: bool = True,
+        warmup_limit: int = 8,
+        idle_timeout: Optional[float] = None,
+        max_lifetime: Optional[float] = None,
+        maintenance_interval: Optional[float] = None,
         **kwargs: Any,
     ) -> None:
         """Init method."""
-        super().__init__(client, minconn, maxconn, **kwargs)
+        super().__init__(client, minconn, maxconn, warmup_limit, **kwargs)
+        for name, val in (
+            ("idle_timeout", idle_timeout),
+            ("max_lifetime", max_lifetime),
+            ("maintenance_interval", maintenance_interval),
+        ):
+            if val is not None and val <= 0:
+                raise ValueError(f"The {name} must be positive.")
         self._block = block
-        self._lock = threading.Condition()
+        self._idle_timeout = idle_timeout
+        self._max_lifetime = max_lifetime
+        self._maintenance_interval = maintenance_interval
+        self._lock = threading.Lock()
+        self._waiters: Deque[_Waiter] = deque()
+        # Number of connections that are being opened.
+        self._pending = 0
+        self._created: Dict[LDAPConnection, float] = {}
+        self._idle_since: Dict[LDAPConnection, float] = {}
+        self._stop_maintenance = threading.Event()
+        self._maintenance_thread: Optional[threading.Thread] = None
+
+    def _total(self) -> int:
+        return len(self._idles) + len(self._used) + self._pending
+
+    def _expired(self, conn: LDAPConnection, now: float) -> bool:
+        if conn.closed:
+            return True
+        if self._max_lifetime is None:
+            return False
+        return now - self._created.get(conn, now) >= self._max_lifetime
+
+    def _forget(self, conn: LDAPConnection) -> None:
+        self._created.pop(conn, None)
+        self._idle_since.pop(conn, None)
+
+    def _reap_idles(self, now: float, retired: List[LDAPConnection]) -> None:
+        """
+        Remove the expired idle connections, and the ones that have been
+        idle for longer than the idle_timeout, while the pool has more
+        than `minconn` connections. The removed connections are added to
+        the `retired`. The caller must hold the lock.
+        """
+        keep: Deque[LDAPConnection] = deque()
+        for conn in self._idles:
+            if self._expired(conn, now):
+                self._forget(conn)
+                retired.append(conn)
+            else:
+                keep.append(conn)
+        self._idles = keep
+        if self._idle_timeout is not None:
+            # The least recently used connections are at the left.
+            while self._idles and self._total() > self._minconn:
+                conn = self._idles[0]
+                if now - self._idle_since.get(conn, now) < self._idle_timeout:
+                    break
+                self._idles.popleft()
+                self._forget(conn)
+                retired.append(conn)
+
+    def _pop_idle(self, retired: List[LDAPConnection]) -> Optional[LDAPConnection]:
+        """
+        Pop the most recently used idle connection, after the expired and
+        timed out ones are removed from the pool and added to the `retired`.
+        """
+        self._reap_idles(time.monotonic(), retired)
+        if not self._idles:
+            return None
+        conn = self._idles.pop()
+        self._idle_since.pop(conn, None)
+        return conn
+
+    def _release(self, conn: LDAPConnection) -> None:
+        """
+        Hand over the connection to the first waiting thread, or add it
+        to the idles. The caller must hold the lock.
+        """
+        self._created.setdefault(conn, time.monotonic())
+        if self._waiters:
+            waiter = self._waiters.popleft()
+            waiter.conn = conn
+            self._used.add(conn)
+            waiter.event.set()
+        else:
+            self._idles.append(conn)
+            self._idle_since[conn] = time.monotonic()
+
+    def _wake_creators(self) -> None:
+        """
+        Let the waiting threads open new connections while there's free
+        capacity in the pool. The caller must hold the lock.
+        """
+        while self._waiters and self._total() < self._maxconn:
+            waiter = self._waiters.popleft()
+            waiter.create = True
+            self._pending += 1
+            waiter.event.set()
+
+    def _create(self) -> LDAPConnection:
+        """Open a new connection for an already reserved place in the pool."""
+        try:
+            conn = self._client.connect(**self._kwargs)
+        except BaseException:
+            with self._lock:
+                self._pending -= 1
+                self._wake_creators()
+            raise
+        with self._lock:
+            self._pending -= 1
+            if self._closed:
+                conn.close()
+                raise ClosedPool("The pool is closed.")
+            self._created[conn] = time.monotonic()
+            self._used.add(conn)
+        return conn
+
+    @staticmethod
+    def _close_all(conns: List[LDAPConnection]) -> None:
+        for conn in conns:
+            try:
+                conn.close()
+            except Exception as exc:
+                logger.warning(f"Exception is raised during closing connection: {exc}")
 
     def get(self, timeout: Optional[float] = None) -> LDAPConnection:
         """
-        Get a connection from the connection pool.
+        Get a connection from the connection pool. If the pool is empty
+        and the `block` was set, the caller is blocked until a connection
+        is put back, and the waiting callers are served in FIFO order.
 
         :param float timeout: a timeout until waiting for free connection.
         :raises EmptyPool: when the pool is empty.
         :raises ClosedPool: when the method is called on a closed pool.
         :return: an LDAP connection object.
         """
+        retired: List[LDAPConnection] = []
+        waiter = None
+        try:
+            with self._lock:
+                if self._closed:
+                    raise ClosedPool("The pool is closed.")
+                if not self._waiters:
+                    conn = self._pop_idle(retired)
+                    if conn is not None:
+                        self._used.add(conn)
+                        return conn
+                    if self._total() < self._maxconn:
+                        self._pending += 1
+                    elif self._block:
+                        waiter = _Waiter()
+                        self._waiters.append(waiter)
+                    else:
+                        raise EmptyPool("Pool is empty.")
+                elif self._block:
+                    waiter = _Waiter()
+                    self._waiters.append(waiter)
+                else:
+                    raise EmptyPool("Pool is empty.")
+        finally:
+            self._close_all(retired)
+        if waiter is None:
+            return self._create()
+        waiter.event.wait(timeout)
         with self._lock:
-            if self._block:
-                self._lock.wait_for(lambda: not self.empty or self._closed, timeout)
-            conn = super().get()
-            self._lock.notify()
-            return conn
+            if not waiter.event.is_set():
+                self._waiters.remove(waiter)
+                raise EmptyPool("Pool is empty.")
+        if waiter.closed:
+            raise ClosedPool("The pool is closed.")
+        if waiter.conn is not None:
+            return waiter.conn
+        return self._create()
 
     def put(self, conn: LDAPConnection) -> None:
+        """
+        Put back a connection to the connection pool. It's handed over to
+        the first waiting thread, if there's any. A closed connection or
+        a connection that's exceeded its max lifetime is not reused.
+
+        :param LDAPConnection conn: the connection managed by the pool.
+        :raises ClosedPool: when the method is called on a closed pool.
+        :raises PoolError: when tying to put back an object that's not managed
+                by this pool.
+        """
+        retired: List[LDAPConnection] = []
         with self._lock:
-            super().put(conn)
-            self._lock.notify()
+            if self._closed:
+                raise ClosedPool("The pool is closed.")
+            try:
+                self._used.remove(conn)
+            except KeyError:
+                raise PoolError(
+                    "The %r is not managed by this pool." % conn
+                ) from None
+            now = time.monotonic()
+            if self._expired(conn, now):
+                self._forget(conn)
+                if not conn.closed:
+                    retired.append(conn)
+                self._wake_creators()
+            else:
+                self._release(conn)
+            self._reap_idles(now, retired)
+        self._close_all(retired)
 
     def close(self) -> None:
         with self._lock:
-            super().close()
-            self._lock.notify_all()
+            conns = list(self._idles) + list(self._used)
+            self._closed = True
+            self._idles = deque()
+            self._used = set()
+            self._created.clear()
+            self._idle_since.clear()
+            while self._waiters:
+                waiter = self._waiters.popleft()
+                waiter.closed = True
+                waiter.event.set()
+            thread = self._maintenance_thread
+            self._maintenance_thread = None
+            self._stop_maintenance.set()
+        self._close_all(conns)
+        if thread is not None and thread is not threading.current_thread():
+            thread.join()
 
     def open(self) -> None:
         with self._lock:
-            super().open()
+            num = max(self._minconn - self._total(), 0)
+            self._pending += num
+        try:
+            conns, errors = self._open_connections(num)
+        finally:
+            with self._lock:
+                self._pending -= num
+        with self._lock:
+            try:
+                self._finish_warmup(conns, errors)
+            finally:
+                self._wake_creators()
+            now = time.monotonic()
+            for conn in self._idles:
+                self._created.setdefault(conn, now)
+                self._idle_since.setdefault(conn, now)
+            if (
+                self._maintenance_interval is not None
+                and self._maintenance_thread is None
+            ):
+                self._stop_maintenance = threading.Event()
+                self._maintenance_thread = threading.Thread(
+                    target=self._maintain,
+                    args=(self._stop_maintenance,),
+                    name="bonsai-pool-maintenance",
+                    daemon=True,
+                )
+                self._maintenance_thread.start()
+
+    def _maintain(self, stop: threading.Event) -> None:
+        """Body of the background maintenance thread."""
+        while not stop.wait(self._maintenance_interval):
+            try:
+                self._maintain_once()
+            except Exception as exc:
+                logger.warning(f"Exception is raised during pool maintenance: {exc}")
+
+    def _maintain_once(self) -> None:
+        """
+        Close the expired and the timed out idle connections, and open new
+        ones until the pool has `minconn` connections.
+        """
+        retired: List[LDAPConnection] = []
+        with self._lock:
+            if self._closed:
+                return
+            self._reap_idles(time.monotonic(), retired)
+            num = max(self._minconn - self._total(), 0)
+            self._pending += num
+        self._close_all(retired)
+        for _ in range(num):
+            try:
+                conn = self._client.connect(**self._kwargs)
+            except Exception as exc:
+                logger.warning(f"Failed to open connection for the pool: {exc}")
+                with self._lock:
+                    self._pending -= 1
+                    self._wake_creators()
+                continue
+            with self._lock:
+                self._pending -= 1
+                if self._closed:
+                    retired = [conn]
+                else:
+                    self._created[conn] = time.monotonic()
+                    self._release(conn)
+                    retired = []
+            self._close_all(retired)
+
+    @property
+    def max_connection(self) -> int:
+        """The maximal number of connections that the pool can have."""
+        return self._maxconn
+
+    @max_connection.setter
+    def max_connection(self, val: int) -> None:
+        """The maximal number of connections that the pool can have."""
+        with self._lock:
+            if val < self._minconn:
+                raise ValueError("The maxconn must be greater than minconn.")
+            self._maxconn = val
+            self._wake_creators()
@@ -0,0 +1,427 @@
+import threading
+from typing import (
+    Any,
+    Dict,
+    Iterable,
+    List,
+    NamedTuple,
+    Optional,
+    Set,
+    TextIO,
+    Tuple,
+    Union,
+)
+
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+from .ldapfilter import LDAPFilter
+from .ldif import LDIFReader
+from .syncrepl import SyncConsumer, SyncEvent, SyncState
+from .utils import _normalize_dn
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import BaseLDAPConnection, LDAPSearchScope
+
+
+class _Record(NamedTuple):
+    dname: str
+    normdn: str
+    parent: str
+    uuid: Optional[bytes]
+    attrs: Dict[str, Tuple[Any, ...]]
+
+
+class _State:
+    """ The entries of the replica and their indexes. """
+
+    def __init__(self, index_attrs: Iterable[str]) -> None:
+        self.records: Dict[str, _Record] = {}
+        self.uuids: Dict[bytes, str] = {}
+        self.indexes: Dict[str, Dict[bytes, Set[str]]] = {
+            attr.lower(): {} for attr in index_attrs
+        }
+
+
+def _value_key(value: Any) -> bytes:
+    """
+    Comparable key of an attribute value or an assertion value. The values
+    are matched by their ASCII lower-cased form, like in LDAPFilter.
+    """
+    if isinstance(value, bytes):
+        return value.lower()
+    if isinstance(value, bool):
+        value = "TRUE" if value else "FALSE"
+    return str(value).encode("UTF-8").lower()
+
+
+def _in_subtree(normdn: str, base: str) -> bool:
+    """ Check that the normalized DN is the `base` or its descendant. """
+    if base == "" or normdn == base:
+        return True
+    if not normdn.endswith("," + base):
+        return False
+    # The separator mustn't be an escaped comma of an attribute value.
+    idx = len(normdn) - len(base) - 2
+    escapes = 0
+    while idx >= 0 and normdn[idx] == "\\":
+        escapes += 1
+        idx -= 1
+    return escapes % 2 == 0
+
+
+class LocalReplica:
+    """
+    In-memory, read-only copy of a directory subtree, that answers
+    searches without network round trips. The entries are kept as
+    immutable snapshots with hash indexes on the normalized DN and on
+    the values of the `index_attrs` attributes, and every search returns
+    new LDAPEntry objects.
+
+    The replica can be loaded from a search or from an LDIF file, and it
+    can be kept current incrementally with the changes of a
+    :class:`bonsai.syncrepl.SyncConsumer`. Loading a new content builds
+    the indexes aside, thus the concurrent searches see either the old
+    or the new content.
+
+    The filters are evaluated with :class:`LDAPFilter`. The equality
+    filters of the indexed attributes are answered from the indexes,
+    the others by scanning the entries in the scope.
+
+    :param str|LDAPDN base: the base DN of the replicated subtree.
+    :param list index_attrs: the attributes to index by their values.
+    """
+
+    def __init__(
+        self,
+        base: Union[str, LDAPDN],
+        index_attrs: Iterable[str] = ("uid", "mail", "objectGUID", "member"),
+    ) -> None:
+        self.__base = LDAPDN(str(base))
+        self.__normbase = _normalize_dn(str(base))
+        self.__index_attrs = tuple(index_attrs)
+        self.__state = _State(self.__index_attrs)
+        self.__lock = threading.RLock()
+
+    def __len__(self) -> int:
+        return len(self.__state.records)
+
+    def __contains__(self, dname: object) -> bool:
+        return _normalize_dn(str(dname)) in self.__state.records
+
+    @property
+    def base(self) -> LDAPDN:
+        """ The base DN of the replicated subtree. """
+        return self.__base
+
+    @property
+    def index_attrs(self) -> Tuple[str, ...]:
+        """ The names of the indexed attributes. """
+        return self.__index_attrs
+
+    def load_search(
+        self,
+        conn: "BaseLDAPConnection",
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        page_size: int = 500,
+        timeout: Optional[float] = None,
+    ) -> int:
+        """
+        Replace the content of the replica with the result of a subtree
+        search of the base DN. Call it periodically to refresh the
+        replica from a full export. The paged search returns only the
+        first range of the ranged attributes (e.g. `member;range=0-1499`),
+        thus those entries are read again to acquire every value, unless
+        the client's :attr:`LDAPClient.auto_range_acquire` is disabled.
+
+        :param LDAPConnection conn: a synchronous connection.
+        :param str filter_exp: string to filter the search in LDAP search \
+        filter syntax.
+        :param list attrlist: list of attribute's names to receive only \
+        those attributes from the directory server.
+        :param int page_size: the page size of the search, 0 for a search \
+        without paging.
+        :param float timeout: time limit in seconds for each request.
+        :return: the number of loaded entries.
+        """
+        state = _State(self.__index_attrs)
+        if page_size > 0:
+            result = conn.paged_search(
+                self.__base,
+                2,
+                filter_exp,
+                attrlist,
+                timeout=timeout,
+                page_size=page_size,
+            )
+            while True:
+                # Consume the page without the automatic page acquiring.
+                page = [next(result) for _ in range(len(result))]
+                for entry in page:
+                    self.__insert(state, self.__reread(conn, entry, attrlist, timeout))
+                msg_id = result.acquire_next_page()
+                if msg_id is None:
+                    break
+                result = conn._evaluate(msg_id, timeout)
+        else:
+            for entry in conn.search(self.__base, 2, filter_exp, attrlist, timeout):
+                self.__insert(state, entry)
+        with self.__lock:
+            self.__state = state
+        return len(state.records)
+
+    @staticmethod
+    def __reread(
+        conn: "BaseLDAPConnection",
+        entry: LDAPEntry,
+        attrlist: Optional[List[str]],
+        timeout: Optional[float],
+    ) -> LDAPEntry:
+        """ Read an entry again, if it has a ranged attribute. """
+        if not any(";range=" in attr.lower() for attr in entry.keys()):
+            return entry
+        res = conn.search(entry.dn, 0, attrlist=attrlist, timeout=timeout)
+        return res[0] if res else entry
+
+    def load_ldif(self, input_file: TextIO) -> int:
+        """
+        Replace the content of the replica with the entries of an LDIF
+        file. The entries outside of the base DN are skipped.
+
+        :param input_file: a file-like object in LDIF format.
+        :return: the number of loaded entries.
+        """
+        state = _State(self.__index_attrs)
+        for entry in LDIFReader(input_file):
+            self.__insert(state, entry)
+        with self.__lock:
+            self.__state = state
+        return len(state.records)
+
+    def put(self, entry: LDAPEntry, uuid: Optional[bytes] = None) -> None:
+        """
+        Add an entry to the replica, or replace it, if it's already added.
+
+        :param LDAPEntry entry: the entry.
+        :param bytes uuid: the entryUUID of the entry, that identifies \
+        it in the content synchronization.
+        """
+        with self.__lock:
+            self.__insert(self.__state, entry, uuid)
+
+    def remove(self, dname: Union[str, LDAPDN]) -> bool:
+        """
+        Remove an entry from the replica.
+
+        :param str|LDAPDN dname: the DN of the entry.
+        :return: True, if the entry was in the replica.
+        """
+        with self.__lock:
+            return self.__delete(self.__state, _normalize_dn(str(dname)))
+
+    def apply(self, events: Iterable[SyncEvent]) -> None:
+        """
+        Apply the changes of a content synchronization. The deleted
+        entries are identified by their entryUUID.
+
+        :param events: the changes from :class:`bonsai.syncrepl.SyncConsumer`.
+        """
+        with self.__lock:
+            state = self.__state
+            for event in events:
+                if event.state == SyncState.DELETE:
+                    for uuid in event.uuids:
+                        normdn = state.uuids.get(uuid)
+                        if normdn is not None:
+                            self.__delete(state, normdn)
+                    if event.entry is not None:
+                        self.__delete(state, _normalize_dn(str(event.entry.dn)))
+                elif event.entry is not None:
+                    self.__insert(state, event.entry, event.uuids[0])
+
+    def sync(self, consumer: SyncConsumer, timeout: Optional[float] = None) -> int:
+        """
+        Refresh the replica with the changes of a refreshOnly content
+        synchronization. When the server finishes the refresh without
+        reporting the deleted entries, every synchronized entry that is
+        not reported as present is removed, as RFC 4533 requires. The
+        entries without entryUUID (e.g. loaded by :meth:`load_search`
+        or :meth:`load_ldif`) are kept.
+
+        :param SyncConsumer consumer: the consumer of the base DN.
+        :param float timeout: time limit in seconds for the request.
+        :return: the number of received changes.
+        """
+        events = consumer.refresh(timeout)
+        with self.__lock:
+            self.apply(events)
+            if not consumer.refresh_deletes:
+                present = set()
+                for event in events:
+                    if event.state != SyncState.DELETE:
+                        present.update(event.uuids)
+                state = self.__state
+                for normdn, record in list(state.records.items()):
+                    if record.uuid is not None and record.uuid not in present:
+                        self.__delete(state, normdn)
+        return len(events)
+
+    def get(self, dname: Union[str, LDAPDN]) -> Optional[LDAPEntry]:
+        """
+        Get an entry by its DN.
+
+        :param str|LDAPDN dname: the DN of the entry.
+        :return: the entry or None, if it's not in the replica.
+        """
+        record = self.__state.records.get(_normalize_dn(str(dname)))
+        if record is None:
+            return None
+        return self.__restore(record, None)
+
+    def search(
+        self,
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union["LDAPSearchScope", int]] = None,
+        filter_exp: Optional[Union[str, LDAPFilter]] = None,
+        attrlist: Optional[List[str]] = None,
+    ) -> List[LDAPEntry]:
+        """
+        Search the entries of the replica with the same parameters as
+        :meth:`LDAPConnection.search`.
+
+        :param str|LDAPDN base: the base DN of the search, the base DN of \
+        the replica by default.
+        :param int scope: the scope of the search, SUBTREE by default.
+        :param str|LDAPFilter filter_exp: string to filter the search in \
+        LDAP search filter syntax, or a compiled filter.
+        :param list attrlist: list of attribute's names to return only \
+        those attributes.
+        :return: the list of found entries.
+        :raises FilterError: if the filter is malformed.
+        """
+        normbase = self.__normbase if base is None else _normalize_dn(str(base))
+        scope = 2 if scope is None else int(scope)
+        if filter_exp is not None and not isinstance(filter_exp, LDAPFilter):
+            filter_exp = LDAPFilter(filter_exp) if filter_exp else None
+        attrs = None
+        if attrlist is not None and "*" not in attrlist:
+            attrs = {attr.lower() for attr in attrlist}
+        with self.__lock:
+            state = self.__state
+            if scope == 0:
+                record = state.records.get(normbase)
+                records = [record] if record is not None else []
+            else:
+                normdns = (
+                    self.__candidates(state, filter_exp._tree())
+                    if filter_exp is not None
+                    else None
+                )
+                if normdns is None:
+                    records = list(state.records.values())
+                else:
+                    records = [state.records[normdn] for normdn in normdns]
+                if scope == 1:
+                    records = [rec for rec in records if rec.parent == normbase]
+                elif normbase != self.__normbase:
+                    records = [
+                        rec for rec in records if _in_subtree(rec.normdn, normbase)
+                    ]
+        if filter_exp is not None:
+            match = filter_exp.match
+            records = [rec for rec in records if match(rec.attrs)]
+        return [self.__restore(rec, attrs) for rec in records]
+
+    @staticmethod
+    def __candidates(state: _State, node: Tuple[Any, ...]) -> Optional[Set[str]]:
+        """
+        Get the DNs that can match the filter from the indexes, or None,
+        if the filter can't be answered from the indexes.
+        """
+        if node[0] == "=":
+            index = state.indexes.get(node[1])
+            if index is None:
+                return None
+            return set(index.get(_value_key(node[2]), ()))
+        if node[0] == "&":
+            result = None
+            for child in node[1]:
+                normdns = LocalReplica.__candidates(state, child)
+                if normdns is not None:
+                    result = normdns if result is None else result & normdns
+            return result
+        if node[0] == "|":
+            result = set()
+            for child in node[1]:
+                normdns = LocalReplica.__candidates(state, child)
+                if normdns is None:
+                    return None
+                result |= normdns
+            return result
+        return None
+
+    def __insert(
+        self, state: _State, entry: LDAPEntry, uuid: Optional[bytes] = None
+    ) -> None:
+        normdn = _normalize_dn(str(entry.dn))
+        if not _in_subtree(normdn, self.__normbase):
+            return
+        old = state.records.get(normdn)
+        if old is not None:
+            if uuid is None:
+                uuid = old.uuid
+            self.__delete(state, normdn)
+        if uuid is not None and uuid in state.uuids:
+            # The entry is renamed.
+            self.__delete(state, state.uuids[uuid])
+        record = _Record(
+            str(entry.dn),
+            normdn,
+            _normalize_dn(entry.dn[1:]),
+            uuid,
+            {attr: tuple(values) for attr, values in entry.items(exclude_dn=True)},
+        )
+        state.records[normdn] = record
+        if uuid is not None:
+            state.uuids[uuid] = normdn
+        for attr, values in record.attrs.items():
+            # The values of the subtypes are matched too.
+            index = state.indexes.get(attr.lower().split(";")[0])
+            if index is None:
+                continue
+            for value in values:
+                index.setdefault(_value_key(value), set()).add(normdn)
+
+    @staticmethod
+    def __delete(state: _State, normdn: str) -> bool:
+        record = state.records.pop(normdn, None)
+        if record is None:
+            return False
+        if record.uuid is not None:
+            state.uuids.pop(record.uuid, None)
+        for attr, values in record.attrs.items():
+            index = state.indexes.get(attr.lower().split(";")[0])
+            if index is None:
+                continue
+            for value in values:
+                key = _value_key(value)
+                normdns = index.get(key)
+                if normdns is not None:
+                    normdns.discard(normdn)
+                    if not normdns:
+                        del index[key]
+        return True
+
+    @staticmethod
+    def __restore(record: _Record, attrs: Optional[Set[str]]) -> LDAPEntry:
+        entry = LDAPEntry(record.dname)
+        for attr, values in record.attrs.items():
+            if attrs is not None and attr.lower() not in attrs:
+                continue
+            entry[attr] = list(values)
+            # Same state as the entries of a search result.
+            entry[attr].status = 0
+            entry[attr].added.clear()
+        return entry
@@ -0,0 +1,215 @@
+import threading
+import time
+from collections import OrderedDict
+from typing import Any, Dict, Hashable, Iterator, List, Optional, Set, Tuple, Union
+
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import BaseLDAPConnection
+
+# The DN (or extended DN) and the attributes of an entry with tuple values.
+_Snapshot = Tuple[str, Tuple[Tuple[str, Tuple[Any, ...]], ...]]
+
+
+def _ancestors(dname: LDAPDN) -> Iterator[LDAPDN]:
+    """ Iterate over the `dname` itself and all of its ancestors. """
+    for idx in range(len(dname)):
+        yield dname if idx == 0 else LDAPDN(dname[idx:])
+    yield LDAPDN("")
+
+
+class SearchCache:
+    """
+    A thread-safe cache of search results. The results are kept as
+    immutable snapshots and every hit returns new LDAPEntry objects, thus
+    modifying a returned entry doesn't change the cached result. The
+    results expire after `ttl` seconds, and the least recently used ones
+    are dropped when the cache holds more than `maxsize` results or more
+    than `max_entries` entries in total.
+
+    Set the cache for an :class:`LDAPClient` with
+    :meth:`LDAPClient.set_search_cache`. The results are kept separately
+    for the different bound identities (the authentication mechanism and
+    credentials of the connections). The adding, modifying, renaming and
+    deleting of an entry through the client's connections drops every
+    cached result whose base is the entry, one of its ancestors or one of
+    its descendants.
+
+    :param float ttl: the time to live of a result in seconds.
+    :param int maxsize: the maximal number of cached results.
+    :param int max_entries: the maximal number of cached entries.
+    :raises ValueError: if a parameter is not positive.
+    """
+
+    def __init__(
+        self, ttl: float = 60.0, maxsize: int = 1024, max_entries: int = 100000
+    ) -> None:
+        if ttl <= 0:
+            raise ValueError("The ttl must be positive.")
+        if maxsize < 1:
+            raise ValueError("The maxsize must be positive.")
+        if max_entries < 1:
+            raise ValueError("The max_entries must be positive.")
+        self.__ttl = ttl
+        self.__maxsize = maxsize
+        self.__max_entries = max_entries
+        # Base DN, expiry time and entry snapshots by keys in LRU order.
+        self.__results: Dict[
+            Hashable, Tuple[LDAPDN, float, Tuple[_Snapshot, ...]]
+        ] = OrderedDict()
+        # Keys of the results by their base DNs, and the base DNs by each
+        # of their ancestors (and by themselves) to find the affected
+        # results of an invalidation without checking all of them.
+        self.__keys: Dict[LDAPDN, Set[Hashable]] = {}
+        self.__bases: Dict[LDAPDN, Set[LDAPDN]] = {}
+        self.__num_entries = 0
+        self.__generation = 0
+        self.__lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def __len__(self) -> int:
+        return len(self.__results)
+
+    @property
+    def generation(self) -> int:
+        """
+        Counter of the invalidations. A result is only stored if there
+        was no invalidation since its search had been started.
+        """
+        return self.__generation
+
+    def get(
+        self, key: Hashable, conn: Optional["BaseLDAPConnection"] = None
+    ) -> Optional[List[LDAPEntry]]:
+        """
+        Get a copy of the cached result.
+
+        :param key: the key of the search.
+        :param conn: the connection of the returned entries.
+        :return: the list of entries or None, if the result is not cached \
+        or it's expired.
+        """
+        with self.__lock:
+            item = self.__results.get(key)
+            if item is not None and item[1] <= time.monotonic():
+                self.__remove(key)
+                item = None
+            if item is None:
+                self.misses += 1
+                return None
+            self.__results.move_to_end(key)  # type: ignore
+            self.hits += 1
+            snapshots = item[2]
+        return [self.__restore(snapshot, conn) for snapshot in snapshots]
+
+    def put(
+        self,
+        key: Hashable,
+        base: Union[str, LDAPDN],
+        entries: List[Any],
+        generation: int,
+    ) -> None:
+        """
+        Store the result of a search.
+
+        :param key: the key of the search.
+        :param str|LDAPDN base: the base DN of the search.
+        :param list entries: the found entries.
+        :param int generation: the value of :attr:`generation` when the \
+        search started.
+        """
+        if len(entries) > self.__max_entries or not all(
+            isinstance(entry, LDAPEntry) for entry in entries
+        ):
+            # Too large, or there are references in the result.
+            return
+        snapshots = tuple(self.__snapshot(entry) for entry in entries)
+        base = LDAPDN(str(base))
+        with self.__lock:
+            if generation != self.__generation:
+                # Entries are written during the search, the result is stale.
+                return
+            self.__remove(key)
+            self.__results[key] = (base, time.monotonic() + self.__ttl, snapshots)
+            self.__num_entries += len(snapshots)
+            if base not in self.__keys:
+                self.__keys[base] = set()
+                for anc in _ancestors(base):
+                    self.__bases.setdefault(anc, set()).add(base)
+            self.__keys[base].add(key)
+            while (
+                len(self.__results) > self.__maxsize
+                or self.__num_entries > self.__max_entries
+            ):
+                self.__remove(next(iter(self.__results)))
+
+    def invalidate(self, dname: Union[str, LDAPDN]) -> None:
+        """
+        Drop the cached results whose base is the `dname`, one of its
+        ancestors or one of its descendants.
+
+        :param str|LDAPDN dname: the DN of the written entry.
+        """
+        if not isinstance(dname, LDAPDN):
+            dname = LDAPDN(dname)
+        with self.__lock:
+            self.__generation += 1
+            if not self.__results:
+                return
+            bases = set(self.__bases.get(dname, ()))
+            bases.update(anc for anc in _ancestors(dname) if anc in self.__keys)
+            for base in bases:
+                for key in list(self.__keys.get(base, ())):
+                    self.__remove(key)
+
+    def clear(self) -> None:
+        """ Drop every cached result. """
+        with self.__lock:
+            self.__generation += 1
+            self.__results.clear()
+            self.__keys.clear()
+            self.__bases.clear()
+            self.__num_entries = 0
+
+    def __remove(self, key: Hashable) -> None:
+        item = self.__results.pop(key, None)
+        if item is None:
+            return
+        base = item[0]
+        self.__num_entries -= len(item[2])
+        keys = self.__keys[base]
+        keys.discard(key)
+        if not keys:
+            del self.__keys[base]
+            for anc in _ancestors(base):
+                bases = self.__bases[anc]
+                bases.discard(base)
+                if not bases:
+                    del self.__bases[anc]
+
+    @staticmethod
+    def __snapshot(entry: LDAPEntry) -> _Snapshot:
+        return (
+            entry.extended_dn or str(entry.dn),
+            tuple(
+                (attr, tuple(values)) for attr, values in entry.items(exclude_dn=True)
+            ),
+        )
+
+    @staticmethod
+    def __restore(
+        snapshot: _Snapshot, conn: Optional["BaseLDAPConnection"]
+    ) -> LDAPEntry:
+        dname, attrs = snapshot
+        entry = LDAPEntry(dname, conn)
+        for attr, values in attrs:
+            entry[attr] = list(values)
+            # Same state as the entries of a search result.
+            entry[attr].status = 0
+            entry[attr].added.clear()
+        return entry
@@ -0,0 +1,257 @@
+from enum import IntEnum
+from typing import (
+    Any,
+    AsyncIterator,
+    Dict,
+    Iterator,
+    List,
+    NamedTuple,
+    Optional,
+    Union,
+)
+
+from .errors import SyncRefreshRequired
+from .ldapdn import LDAPDN
+from .ldapentry import LDAPEntry
+from .utils import _read_cookie, _write_cookie
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import BaseLDAPConnection, LDAPSearchScope
+
+REFRESH_ONLY = 1
+REFRESH_AND_PERSIST = 3
+
+
+class SyncState(IntEnum):
+    """ The state of the synchronized entries, as in RFC 4533. """
+
+    PRESENT = 0
+    ADD = 1
+    MODIFY = 2
+    DELETE = 3
+
+
+class SyncEvent(NamedTuple):
+    """
+    A change of the synchronized content. The `entry` is set for the
+    entries sent by the server, otherwise only the `uuids` of the present
+    or deleted entries are known.
+    """
+
+    state: SyncState
+    entry: Optional[LDAPEntry]
+    uuids: List[bytes]
+
+
+class SyncConsumer:
+    """
+    Content synchronization client of RFC 4533. The :meth:`refresh`
+    method returns the changes since the last synchronization, the
+    :meth:`listen` method keeps the search open after the refresh and
+    yields the changes as they are received. The cookie of the last
+    synchronization state is passed on between the requests, and if
+    `cookie_path` is set, it is also loaded from and saved to that file.
+
+    When the server can't resume the synchronization from the cookie,
+    the cookie is dropped and :class:`SyncRefreshRequired` is raised, the
+    content has to be reloaded with a new refresh.
+
+    :param conn: the connection.
+    :param str|LDAPDN base: the base DN of the search.
+    :param int scope: the scope of the search.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param bytes cookie: the cookie of a previous synchronization.
+    :param str cookie_path: path of the file that keeps the cookie.
+    :param bool reload_hint: ask the server to send the full content when \
+    it can't resume the synchronization from the cookie, instead of \
+    returning an error.
+    """
+
+    def __init__(
+        self,
+        conn: "BaseLDAPConnection",
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union["LDAPSearchScope", int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        cookie: Optional[bytes] = None,
+        cookie_path: Optional[str] = None,
+        reload_hint: bool = False,
+    ) -> None:
+        self.__conn = conn
+        self.__base = base
+        self.__scope = scope
+        self.__filter_exp = filter_exp
+        self.__attrlist = attrlist
+        self.__cookie_path = cookie_path
+        self.__reload_hint = reload_hint
+        if cookie is None and cookie_path is not None:
+            cookie = _read_cookie(cookie_path)
+        self.__cookie = cookie
+        self.__refresh_done = False
+        self.__refresh_deletes = False
+        # The message ID of the open refreshAndPersist search.
+        self.__msg_id: Optional[int] = None
+
+    def __enter__(self) -> "SyncConsumer":
+        return self
+
+    def __exit__(self, type, value, traceback) -> None:
+        self.close()
+
+    @property
+    def cookie(self) -> Optional[bytes]:
+        """ The cookie of the last received synchronization state. """
+        return self.__cookie
+
+    @property
+    def refresh_done(self) -> bool:
+        """ True, if the refresh stage of the last request is finished. """
+        return self.__refresh_done
+
+    @property
+    def refresh_deletes(self) -> bool:
+        """
+        True, if the server finished the refresh with sending the deleted
+        entries. Otherwise every entry that is not reported as present
+        has been deleted.
+        """
+        return self.__refresh_deletes
+
+    def refresh(self, timeout: Optional[float] = None) -> List[SyncEvent]:
+        """
+        Get the changes since the last synchronization with a
+        refreshOnly request.
+
+        :param float timeout: time limit in seconds for the request.
+        :return: the list of changes.
+        :raises SyncRefreshRequired: if the content has to be reloaded.
+        """
+        msg_id = self.__request(REFRESH_ONLY, timeout)
+        return self.__process(self.__receive(msg_id, timeout))
+
+    def listen(self, timeout: Optional[float] = None) -> Iterator[SyncEvent]:
+        """
+        Get the changes since the last synchronization, then keep the
+        search open and yield the changes as the server sends them with
+        a refreshAndPersist request. The iteration stops when the server
+        ends the search, or when no change is received in `timeout`
+        seconds. In the latter case the search is kept open and calling
+        this method again continues it.
+
+        :param float timeout: time limit in seconds to wait for a change.
+        :return: iterator of the changes.
+        :raises SyncRefreshRequired: if the content has to be reloaded.
+        """
+        if self.__msg_id is None:
+            self.__msg_id = self.__request(REFRESH_AND_PERSIST, None)
+        while self.__msg_id is not None:
+            events = self.__receive(self.__msg_id, timeout)
+            if events is None:
+                return
+            yield from self.__process(events)
+
+    async def refresh_async(self, timeout: Optional[float] = None) -> List[SyncEvent]:
+        """
+        The same as :meth:`refresh` for asynchronous connections.
+
+        :param float timeout: time limit in seconds for the request.
+        :return: the list of changes.
+        :raises SyncRefreshRequired: if the content has to be reloaded.
+        """
+        msg_id = self.__request(REFRESH_ONLY, timeout)
+        try:
+            events = await self.__conn._evaluate(msg_id, timeout)
+        except SyncRefreshRequired:
+            self.__drop_cookie()
+            raise
+        return self.__process(events)
+
+    async def listen_async(self) -> AsyncIterator[SyncEvent]:
+        """
+        The same as :meth:`listen` for asynchronous connections, without
+        a timeout. Cancelling the consuming task abandons the search.
+
+        :return: asynchronous iterator of the changes.
+        :raises SyncRefreshRequired: if the content has to be reloaded.
+        """
+        if self.__msg_id is None:
+            self.__msg_id = self.__request(REFRESH_AND_PERSIST, None)
+        while self.__msg_id is not None:
+            try:
+                events = await self.__conn._evaluate(self.__msg_id)
+            except SyncRefreshRequired:
+                self.__msg_id = None
+                self.__drop_cookie()
+                raise
+            for event in self.__process(events):
+                yield event
+
+    def close(self) -> None:
+        """ Abandon the open refreshAndPersist search. """
+        if self.__msg_id is not None:
+            msg_id = self.__msg_id
+            self.__msg_id = None
+            self.__conn._abandon_unwaited(msg_id)
+
+    def __request(self, mode: int, timeout: Optional[float]) -> int:
+        self.__refresh_done = False
+        return self.__conn._search_request(
+            self.__base,
+            self.__scope,
+            self.__filter_exp,
+            self.__attrlist,
+            timeout,
+            sync_mode=mode,
+            sync_cookie=self.__cookie,
+            reload_hint=self.__reload_hint,
+        )
+
+    def __receive(
+        self, msg_id: int, timeout: Optional[float]
+    ) -> Optional[List[Dict[str, Any]]]:
+        try:
+            return self.__conn._evaluate(msg_id, timeout)
+        except SyncRefreshRequired:
+            if msg_id == self.__msg_id:
+                self.__msg_id = None
+            self.__drop_cookie()
+            raise
+
+    def __process(self, events: List[Dict[str, Any]]) -> List[SyncEvent]:
+        changes = []
+        for event in events:
+            if event["type"] == "entry":
+                changes.append(
+                    SyncEvent(SyncState(event["state"]), event["entry"], [event["uuid"]])
+                )
+            elif event["type"] == "id_set":
+                state = SyncState.DELETE if event["refresh_deletes"] else SyncState.PRESENT
+                changes.append(SyncEvent(state, None, event["uuids"]))
+            elif event["type"] in ("refresh_delete", "refresh_present"):
+                if event["refresh_done"]:
+                    self.__refresh_done = True
+                    self.__refresh_deletes = event["type"] == "refresh_delete"
+            elif event["type"] == "done":
+                self.__refresh_done = True
+                self.__refresh_deletes = event["refresh_deletes"]
+                self.__msg_id = None
+            if event.get("cookie") is not None:
+                self.__set_cookie(event["cookie"])
+        return changes
+
+    def __set_cookie(self, cookie: Optional[bytes]) -> None:
+        if cookie == self.__cookie:
+            return
+        self.__cookie = cookie
+        if self.__cookie_path is not None:
+            _write_cookie(self.__cookie_path, cookie)
+
+    def __drop_cookie(self) -> None:
+        self.__refresh_done = False
+        self.__set_cookie(None)
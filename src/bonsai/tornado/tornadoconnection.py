@@ -5,7 +5,7 @@ from tornado.ioloop import IOLoop
 from tornado.concurrent import Future
 
 from ..ldapconnection import BaseLDAPConnection, LDAPSearchScope
-from ..errors import LDAPError, NotAllowedOnNonleaf
+from ..errors import ClosedConnection, NotAllowedOnNonleaf
 
 
 class TornadoLDAPConnection(BaseLDAPConnection):
@@ -22,6 +22,74 @@ class TornadoLDAPConnection(BaseLDAPConnection):
         self._ioloop = ioloop or IOLoop.instance()
         self._fileno = None
         self._timeout = None
+        # Futures and timeout handles of the ongoing operations by message ID.
+        self._waiters = {}
+        self._handler_fd = None
+
+    def close(self):
+        self._remove_handler()
+        waiters, self._waiters = self._waiters, {}
+        for fut, timeout in waiters.values():
+            if timeout is not None:
+                self._ioloop.remove_timeout(timeout)
+            if not fut.done():
+                fut.set_exception(ClosedConnection("The connection is closed."))
+        super().close()
+
+    def _remove_handler(self):
+        if self._handler_fd is not None:
+            self._ioloop.remove_handler(self._handler_fd)
+            self._handler_fd = None
+
+    def _resolve(self, msg_id):
+        """Remove the operation from the waiters, and return its future."""
+        fut, timeout = self._waiters.pop(msg_id)
+        if timeout is not None:
+            self._ioloop.remove_timeout(timeout)
+        if not self._waiters:
+            self._remove_handler()
+        return fut
+
+    def _dispatch(self, fd=None, events=None):
+        """
+        The single IO handler of an open connection. Check every ongoing
+        operation, and resolve the futures of the finished ones. Reading
+        a result can queue other operations' responses in libldap, that
+        won't make the socket readable again, so the ongoing operations
+        are checked until a full pass finds no finished one.
+        """
+        woken = True
+        while woken and self._waiters:
+            woken = False
+            for msg_id in list(self._waiters):
+                try:
+                    res = super().get_result(msg_id)
+                except Exception as exc:
+                    fut = self._resolve(msg_id)
+                    if not fut.done():
+                        fut.set_exception(exc)
+                    woken = True
+                    continue
+                if res is not None:
+                    fut = self._resolve(msg_id)
+                    if not fut.done():
+                        fut.set_result(res)
+                    woken = True
+
+    def _operation_timeout(self, msg_id):
+        if msg_id not in self._waiters:
+            return
+        fut, _ = self._waiters.pop(msg_id)
+        if not self._waiters:
+            self._remove_handler()
+        self._abandon_unwaited(msg_id)
+        if not fut.done():
+            fut.set_exception(gen.TimeoutError())
+
+    def _operation_done(self, msg_id, fut):
+        if fut.cancelled() and msg_id in self._waiters:
+            self._resolve(msg_id)
+            self._abandon_unwaited(msg_id)
 
     def _io_callback(self, fut, msg_id, fd=None, events=None):
         try:
@@ -41,7 +109,7 @@ class TornadoLDAPConnection(BaseLDAPConnection):
                 except FileExistsError as exc:
                     if exc.errno != 17:
                         raise exc
-        except LDAPError as exc:
+        except Exception as exc:
             fut.set_exception(exc)
 
     def _timeout_callback(self, fut):
@@ -49,6 +117,33 @@ class TornadoLDAPConnection(BaseLDAPConnection):
         fut.set_exception(gen.TimeoutError())
 
     def _evaluate(self, msg_id, timeout=None):
+        if self.closed:
+            # The connection is still being opened.
+            return self._evaluate_open(msg_id, timeout)
+        fut = Future()
+        try:
+            res = super().get_result(msg_id)
+        except Exception as exc:
+            fut.set_exception(exc)
+            return fut
+        # The read might have queued the responses of the waiting operations.
+        self._dispatch()
+        if res is not None:
+            fut.set_result(res)
+            return fut
+        handle = None
+        if timeout is not None:
+            handle = self._ioloop.call_later(
+                timeout, self._operation_timeout, msg_id
+            )
+        self._waiters[msg_id] = (fut, handle)
+        fut.add_done_callback(partial(self._operation_done, msg_id))
+        if self._handler_fd is None:
+            self._handler_fd = self.fileno()
+            self._ioloop.add_handler(self._handler_fd, self._dispatch, IOLoop.READ)
+        return fut
+
+    def _evaluate_open(self, msg_id, timeout=None):
         fut = Future()
         callback = partial(self._io_callback, fut, msg_id)
         self._fileno = self.fileno()
@@ -82,17 +177,6 @@ class TornadoLDAPConnection(BaseLDAPConnection):
             else:
                 raise exc
 
-    @gen.coroutine
-    def _search_iter_anext(self, search_iter):
-        try:
-            return next(search_iter)
-        except StopIteration:
-            msgid = search_iter.acquire_next_page()
-            if msgid is None:
-                raise StopAsyncIteration from None
-            search_iter = yield self._evaluate(msgid)
-            return next(search_iter)
-
     @gen.coroutine
     def get_result(self, msg_id, timeout=None):
         res = yield self._evaluate(msg_id, timeout)
@@ -2,7 +2,7 @@ import math
 import trio
 
 from ..ldapconnection import BaseLDAPConnection, LDAPSearchScope
-from ..errors import NotAllowedOnNonleaf, TimeoutError
+from ..errors import ClosedConnection, NotAllowedOnNonleaf, TimeoutError
 
 
 class TrioLDAPConnection(BaseLDAPConnection):
@@ -17,6 +17,10 @@ class TrioLDAPConnection(BaseLDAPConnection):
 
     def __init__(self, client):
         self.__open_coro = None
+        # Events of the tasks that wait on a result, by message ID.
+        self.__waiters = {}
+        self.__results = {}
+        self.__reader_running = False
         super().__init__(client, is_async=True)
 
     async def __aenter__(self):
@@ -34,7 +38,16 @@ class TrioLDAPConnection(BaseLDAPConnection):
         self.__open_coro = super().open(timeout)
         return self
 
-    async def _poll(self, msg_id, timeout=None):
+    def close(self):
+        if self.__reader_running:
+            # Wake up the reader task, that's waiting on the descriptor.
+            try:
+                trio.lowlevel.notify_closing(self)
+            except RuntimeError:
+                pass
+        super().close()
+
+    async def __poll_open(self, msg_id, timeout=None):
         tout_sec = timeout if timeout is not None else math.inf
         with trio.move_on_after(tout_sec):
             while True:
@@ -45,6 +58,81 @@ class TrioLDAPConnection(BaseLDAPConnection):
                     return res
         raise TimeoutError("Timeout is exceeded")
 
+    def __dispatch(self):
+        """
+        Check every waiting operation, and wake up the finished ones. Reading
+        a result can buffer other operations' responses in libldap, that
+        won't make the socket readable again, so the waiting operations are
+        checked until a full pass finds no finished one.
+        """
+        woken = True
+        while woken and self.__waiters:
+            woken = False
+            for msg_id, event in list(self.__waiters.items()):
+                try:
+                    res = super().get_result(msg_id)
+                except Exception as exc:
+                    res = exc
+                if res is not None:
+                    del self.__waiters[msg_id]
+                    self.__results[msg_id] = res
+                    event.set()
+                    woken = True
+
+    def __fail_waiters(self, exc):
+        for msg_id, event in self.__waiters.items():
+            self.__results[msg_id] = exc
+            event.set()
+        self.__waiters.clear()
+
+    async def __reader(self):
+        """
+        Reader task of the connection. Waits on the descriptor to be readable
+        as long as there are waiting operations, and dispatches the results.
+        """
+        try:
+            while self.__waiters:
+                await trio.lowlevel.wait_readable(self)
+                self.__dispatch()
+        except trio.ClosedResourceError:
+            self.__fail_waiters(ClosedConnection("The connection is closed."))
+        except trio.Cancelled:
+            raise
+        except Exception as exc:
+            self.__fail_waiters(exc)
+        finally:
+            self.__reader_running = False
+
+    async def _poll(self, msg_id, timeout=None):
+        if self.closed:
+            # The connection is still being opened.
+            return await self.__poll_open(msg_id, timeout)
+        res = super().get_result(msg_id)
+        # The read might have queued the responses of the waiting operations.
+        self.__dispatch()
+        if res is not None:
+            await trio.lowlevel.checkpoint()
+            return res
+        event = trio.Event()
+        self.__waiters[msg_id] = event
+        if not self.__reader_running:
+            self.__reader_running = True
+            trio.lowlevel.spawn_system_task(self.__reader)
+        tout_sec = timeout if timeout is not None else math.inf
+        try:
+            with trio.move_on_after(tout_sec):
+                await event.wait()
+        finally:
+            if not event.is_set() and self.__waiters.pop(msg_id, None) is not None:
+                # Timed out or cancelled, stop the operation on the server.
+                self._abandon_unwaited(msg_id)
+        if not event.is_set():
+            raise TimeoutError("Timeout is exceeded")
+        res = self.__results.pop(msg_id)
+        if isinstance(res, Exception):
+            raise res
+        return res
+
     def _evaluate(self, msg_id, timeout=None):
         return self._poll(msg_id, timeout)
 
@@ -62,15 +150,5 @@ class TrioLDAPConnection(BaseLDAPConnection):
             else:
                 raise exc
 
-    async def _search_iter_anext(self, search_iter):
-        try:
-            return next(search_iter)
-        except StopIteration:
-            msgid = search_iter.acquire_next_page()
-            if msgid is None:
-                raise StopAsyncIteration from None
-            search_iter = await self._evaluate(msgid)
-            return next(search_iter)
-
     async def get_result(self, msg_id, timeout=None):
         return await self._evaluate(msg_id, timeout)
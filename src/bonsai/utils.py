@@ -1,9 +1,14 @@
+import os
+from typing import Optional
+
 from bonsai._bonsai import (
     get_tls_impl_name,
     set_connect_async,
     get_vendor_info,
     has_krb5_support,
     _unique_contains,
+    _parse_dn,
+    _normalize_dn,
     set_debug,
 )
 
@@ -47,3 +52,24 @@ def escape_filter_exp(filter_exp: str) -> str:
     for char, repl in chars_to_escape:
         filter_exp = filter_exp.replace(char, repl)
     return filter_exp
+
+
+def _read_cookie(path: str) -> Optional[bytes]:
+    """ Read a saved cookie, return None if there's none. """
+    try:
+        with open(path, "rb") as cookie_file:
+            return cookie_file.read() or None
+    except FileNotFoundError:
+        return None
+
+
+def _write_cookie(path: str, cookie: Optional[bytes]) -> None:
+    """ Save the cookie, an empty file means no cookie. """
+    # Write to a temporary file and replace the old one, thus a crash
+    # can't leave a truncated cookie behind.
+    tmp_path = "{0}.tmp".format(path)
+    with open(tmp_path, "wb") as cookie_file:
+        cookie_file.write(cookie or b"")
+        cookie_file.flush()
+        os.fsync(cookie_file.fileno())
+    os.replace(tmp_path, path)
@@ -0,0 +1,208 @@
+from collections import OrderedDict
+from typing import Any, Dict, Iterator, List, Optional, Tuple, Union, overload
+
+from .errors import UnwillingToPerform
+from .ldapdn import LDAPDN
+
+MYPY = False
+
+if MYPY:
+    from .ldapconnection import LDAPConnection, LDAPSearchScope
+
+
+class VLVCursor:
+    """
+    Random access to a server-side sorted search result by using virtual
+    list view requests. The result is fetched in windows of `window_size`
+    entries, the received windows are kept in a least recently used cache
+    and the context ID of the server is passed on between the requests.
+    When `prefetch` is set, the next window in the direction of the
+    scrolling is requested in advance, while the current one is being read.
+
+    The cursor supports indexing and slicing with the 0-based position of
+    the entry in the sorted result list, and its length is the content
+    count reported by the server.
+
+    :param LDAPConnection conn: a synchronous connection.
+    :param str|LDAPDN base: the base DN of the search.
+    :param int scope: the scope of the search.
+    :param str filter_exp: string to filter the search in LDAP search \
+    filter syntax.
+    :param list attrlist: list of attribute's names to receive only those \
+    attributes from the directory server.
+    :param list sort_order: list of attribute's names to use for \
+    server-side ordering, start name with '-' for descending order.
+    :param int window_size: the number of entries requested at once.
+    :param int cache_size: the maximal number of windows kept in the cache.
+    :param bool prefetch: request the next window in the direction of \
+    the scrolling in advance.
+    :param float timeout: time limit in seconds for each request.
+    :raises UnwillingToPerform: if the `sort_order` is not set.
+    :raises ValueError: if the `window_size` or the `cache_size` is less \
+    than 1.
+    """
+
+    def __init__(
+        self,
+        conn: "LDAPConnection",
+        base: Optional[Union[str, LDAPDN]] = None,
+        scope: Optional[Union["LDAPSearchScope", int]] = None,
+        filter_exp: Optional[str] = None,
+        attrlist: Optional[List[str]] = None,
+        sort_order: Optional[List[str]] = None,
+        window_size: int = 100,
+        cache_size: int = 16,
+        prefetch: bool = True,
+        timeout: Optional[float] = None,
+    ) -> None:
+        # The offset and message ID of the prefetched window.
+        self.__pending: Optional[Tuple[int, int]] = None
+        if not sort_order:
+            raise UnwillingToPerform("Sort control is required with virtual list view.")
+        if window_size < 1:
+            raise ValueError("The window_size must be positive.")
+        if cache_size < 1:
+            raise ValueError("The cache_size must be positive.")
+        self.__conn = conn
+        self.__base = base
+        self.__scope = scope
+        self.__filter_exp = filter_exp
+        self.__attrlist = attrlist
+        self.__sort_order = sort_order
+        self.__window_size = window_size
+        self.__cache_size = cache_size
+        self.__prefetch = prefetch
+        self.__timeout = timeout
+        # Received windows by their 1-based offset, in least recently used order.
+        self.__windows: Dict[int, List[Any]] = OrderedDict()
+        self.__last_offset = 0
+        self.__backward = False
+        self.__list_count: Optional[int] = None
+        self.__context_id: Optional[bytes] = None
+
+    def __enter__(self) -> "VLVCursor":
+        return self
+
+    def __exit__(self, type, value, traceback) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        # The cursor is dropped without closing it.
+        self.__abandon_pending()
+
+    def __len__(self) -> int:
+        if self.__list_count is None:
+            self.__get_window(1)
+        return self.__list_count or 0
+
+    def __iter__(self) -> Iterator[Any]:
+        for idx in range(len(self)):
+            try:
+                yield self[idx]
+            except IndexError:
+                # The list is shrunk during the iteration.
+                return
+
+    @overload
+    def __getitem__(self, key: int) -> Any:
+        ...
+
+    @overload
+    def __getitem__(self, key: slice) -> List[Any]:
+        ...
+
+    def __getitem__(self, key):
+        if isinstance(key, slice):
+            return [self[idx] for idx in range(*key.indices(len(self)))]
+        idx = int(key)
+        if idx < 0:
+            idx += len(self)
+        if idx < 0 or (self.__list_count is not None and idx >= self.__list_count):
+            raise IndexError("VLVCursor index out of range")
+        offset = idx - idx % self.__window_size + 1
+        window = self.__get_window(offset)
+        try:
+            return window[idx % self.__window_size]
+        except IndexError:
+            raise IndexError("VLVCursor index out of range") from None
+
+    @property
+    def context_id(self) -> Optional[bytes]:
+        """ The context ID of the last virtual list view response. """
+        return self.__context_id
+
+    def clear_cache(self) -> None:
+        """ Drop the received windows, they will be requested again. """
+        self.__windows.clear()
+
+    def close(self) -> None:
+        """ Abandon the prefetch request and drop the received windows. """
+        self.__abandon_pending()
+        self.__windows.clear()
+
+    def __request(self, offset: int) -> int:
+        return self.__conn._search_request(
+            self.__base,
+            self.__scope,
+            self.__filter_exp,
+            self.__attrlist,
+            self.__timeout,
+            0,
+            False,
+            self.__sort_order,
+            0,
+            offset,
+            0,
+            self.__window_size - 1,
+            self.__list_count or 0,
+            None,
+            self.__context_id,
+        )
+
+    def __receive(self, offset: int, msg_id: int) -> List[Any]:
+        entries, ctrl = self.__conn._evaluate(msg_id, self.__timeout)
+        self.__list_count = ctrl["list_count"]
+        if ctrl.get("context_id") is not None:
+            self.__context_id = ctrl["context_id"]
+        self.__windows[offset] = entries
+        while len(self.__windows) > self.__cache_size:
+            self.__windows.popitem(last=False)
+        return entries
+
+    def __abandon_pending(self) -> None:
+        if self.__pending is not None:
+            _, msg_id = self.__pending
+            self.__pending = None
+            self.__conn._abandon_unwaited(msg_id)
+
+    def __get_window(self, offset: int) -> List[Any]:
+        if offset != self.__last_offset:
+            self.__backward = offset < self.__last_offset
+            self.__last_offset = offset
+        if offset in self.__windows:
+            self.__windows.move_to_end(offset)  # type: ignore
+            window = self.__windows[offset]
+        else:
+            if self.__pending is not None and self.__pending[0] == offset:
+                _, msg_id = self.__pending
+                self.__pending = None
+            else:
+                # Keep only one request in flight.
+                self.__abandon_pending()
+                msg_id = self.__request(offset)
+            window = self.__receive(offset, msg_id)
+        if self.__prefetch:
+            step = -self.__window_size if self.__backward else self.__window_size
+            self.__prefetch_window(offset + step)
+        return window
+
+    def __prefetch_window(self, offset: int) -> None:
+        if offset < 1 or (self.__list_count is not None and offset > self.__list_count):
+            return
+        if offset in self.__windows:
+            return
+        if self.__pending is not None:
+            if self.__pending[0] == offset:
+                return
+            self.__abandon_pending()
+        self.__pending = (offset, self.__request(offset))
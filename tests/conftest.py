@@ -6,7 +6,7 @@ from contextlib import contextmanager
 
 import pytest
 
-from bonsai import LDAPClient
+from bonsai import LDAPClient, LDAPEntry
 from bonsai.active_directory.acl import ACE, ACEFlag, ACEType
 from bonsai.active_directory.sid import SID
 
@@ -50,6 +50,28 @@ def client():
     return cli
 
 
+@pytest.fixture(scope="module")
+def conn(client):
+    """Get an opened connection of the client."""
+    with client.connect() as conn:
+        yield conn
+
+
+@pytest.fixture
+def entry(conn, basedn):
+    """Get a new entry that is deleted (also by its renamed DN) after the test."""
+    entry = LDAPEntry("cn=test_entry,ou=nerdherd,%s" % basedn)
+    entry["objectClass"] = ["top", "inetOrgPerson"]
+    entry["sn"] = "test_entry"
+    entry["cn"] = "test_entry"
+    yield entry
+    for dname in (entry.dn, "cn=test_entry2,ou=nerdherd,%s" % basedn):
+        try:
+            conn.delete(dname)
+        except Exception:
+            pass
+
+
 @pytest.fixture(scope="module")
 def basedn():
     """Get base DN."""
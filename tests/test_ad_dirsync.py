@@ -0,0 +1,95 @@
+import asyncio
+import sys
+
+import pytest
+
+from bonsai import LDAPEntry
+from bonsai.active_directory import DirSync, DirSyncFlag
+
+DIRSYNC_OID = "1.2.840.113556.1.4.841"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def dirsync_supported(client):
+    """ Skip the tests, if the DirSync control is not supported. """
+    if DIRSYNC_OID not in client.get_rootDSE()["supportedControl"]:
+        pytest.skip("DirSync control is not supported by the server")
+
+
+@pytest.fixture
+def group(conn, basedn):
+    """ Get a group that is deleted after the test. """
+    group = LDAPEntry("cn=dirsync_test,ou=nerdherd,%s" % basedn)
+    group["objectClass"] = ["top", "groupOfNames"]
+    group["cn"] = "dirsync_test"
+    group["member"] = ["cn=chuck,ou=nerdherd,%s" % basedn]
+    conn.add(group)
+    yield group
+    try:
+        conn.delete(group.dn)
+    except Exception:
+        pass
+
+
+def test_changes(conn, basedn, group, tmp_path):
+    """ Test getting the changes with incremental values. """
+    cookie_path = str(tmp_path / "dirsync.cookie")
+    dirsync = DirSync(conn, basedn, cookie_path=cookie_path, max_bytes=2)
+    changes = list(dirsync.changes())
+    assert len(changes) == len(conn.search(basedn, 2))
+    assert group.dn in [chg.entry.dn for chg in changes]
+    cookie = dirsync.cookie
+    assert cookie is not None
+    with open(cookie_path, "rb") as cookie_file:
+        assert cookie_file.read() == cookie
+    group.change_attribute("member", 0, "cn=jeff,ou=nerdherd,%s" % basedn)
+    group.change_attribute("member", 1, "cn=chuck,ou=nerdherd,%s" % basedn)
+    group["description"] = "DirSync test"
+    group.modify()
+    dirsync = DirSync(conn, basedn, cookie_path=cookie_path)
+    assert dirsync.cookie == cookie
+    changes = list(dirsync.changes())
+    assert len(changes) == 1
+    change = changes[0]
+    assert change.entry.dn == group.dn
+    assert not change.deleted
+    assert change.entry["description"] == ["DirSync test"]
+    assert "member" not in change.entry
+    assert [str(val).lower() for val in change.added["member"]] == [
+        "cn=jeff,ou=nerdherd,%s" % basedn
+    ]
+    assert [str(val).lower() for val in change.removed["member"]] == [
+        "cn=chuck,ou=nerdherd,%s" % basedn
+    ]
+    assert list(dirsync.changes()) == []
+    conn.delete(group.dn)
+    changes = list(dirsync.changes())
+    assert len(changes) == 1
+    assert changes[0].deleted
+
+
+def test_changes_full_values(conn, basedn, group):
+    """ Test getting every value of the changed attributes. """
+    dirsync = DirSync(conn, basedn, "(cn=dirsync_test)", flags=0)
+    changes = list(dirsync.changes())
+    assert [chg.entry.dn for chg in changes] == [group.dn]
+    group.change_attribute("member", 0, "cn=jeff,ou=nerdherd,%s" % basedn)
+    group.modify()
+    changes = list(dirsync.changes())
+    assert len(changes) == 1
+    assert len(changes[0].entry["member"]) == 2
+    assert changes[0].added == {}
+
+
+@pytest.mark.skipif(
+    sys.platform == "win32", reason="Selector event loop is required on Windows"
+)
+def test_changes_async(client, conn, basedn, group):
+    """ Test getting the changes with an async connection. """
+
+    async def changes():
+        async with client.connect(True) as aconn:
+            dirsync = DirSync(aconn, basedn, "(cn=dirsync_test)")
+            return [chg async for chg in dirsync.changes_async()]
+
+    assert [chg.entry.dn for chg in asyncio.run(changes())] == [group.dn]
@@ -33,6 +33,17 @@ async def test_connection(client):
     assert conn.closed == False
 
 
+@asyncio_test
+async def test_concurrent_connections(client):
+    """Test opening more connections concurrently than the init pool size."""
+    conns = await asyncio.gather(*(client.connect(True) for _ in range(12)))
+    assert len(set(conn.fileno() for conn in conns)) == 12
+    for conn in conns:
+        assert conn.closed == False
+        assert await conn.whoami() is not None
+        conn.close()
+
+
 @asyncio_test
 async def test_search(client):
     """Test search."""
@@ -67,6 +78,47 @@ async def test_add_and_delete(client, basedn):
         assert entry not in res
 
 
+@asyncio_test
+async def test_search_ranged_attribute(client, basedn):
+    """Test retrieving every value of a ranged attribute."""
+    async with client.connect(True) as conn:
+        group = LDAPEntry("cn=async_ranged_test,%s" % basedn)
+        group["objectclass"] = ["top", "groupOfNames"]
+        group["cn"] = "async_ranged_test"
+        group["member"] = ["cn=member_%d,%s" % (idx, basedn) for idx in range(17)]
+        try:
+            await conn.add(group)
+        except bonsai.errors.AlreadyExists:
+            await conn.delete(group.dn)
+            await conn.add(group)
+        try:
+            res = await conn.search(group.dn, 0, attrlist=["member"])
+            assert sorted(res[0]["member"]) == sorted(group["member"])
+            assert not any(";range=" in key for key in res[0].keys())
+        finally:
+            await conn.delete(group.dn)
+
+
+@asyncio_test
+async def test_compare(client, basedn):
+    """Test comparing attribute values one by one and pipelined."""
+    async with client.connect(True) as conn:
+        dname = "cn=chuck,ou=nerdherd,%s" % basedn
+        assert await conn.compare(dname, "cn", "chuck") is True
+        assert await conn.compare(dname, "cn", "jeff") is False
+        assertions = [(dname, "cn", name) for name in ("chuck", "jeff", "CHUCK")]
+        assert await conn.compare_many(assertions, pipeline_depth=2) == [
+            True,
+            False,
+            True,
+        ]
+        assert await conn.compare_many([]) == []
+        with pytest.raises(ValueError):
+            _ = conn.compare_many(assertions, pipeline_depth=0)
+        with pytest.raises(bonsai.errors.NoSuchObjectError):
+            await conn.compare_many([("cn=nobody,%s" % basedn, "cn", "x")] + assertions)
+
+
 @asyncio_test
 async def test_recursive_delete(client, basedn):
     """Test removing a subtree recursively."""
@@ -168,6 +220,28 @@ async def test_search_timeout(client):
                 await conn.search(timeout=4.0)
 
 
+@asyncio_test
+async def test_cancel_abandons_operation(client, basedn):
+    """Test that a cancelled operation is abandoned on the server."""
+    async with client.connect(True) as conn:
+        abandoned = []
+        abandon = conn.abandon
+
+        def abandon_spy(msg_id):
+            abandoned.append(msg_id)
+            abandon(msg_id)
+
+        conn.abandon = abandon_spy
+        task = asyncio.ensure_future(conn.search(basedn, 2))
+        await asyncio.sleep(0)  # Let the task send the request.
+        task.cancel()
+        with pytest.raises(asyncio.CancelledError):
+            await task
+        assert len(abandoned) == 1
+        # The connection is still usable.
+        assert await conn.whoami() is not None
+
+
 @asyncio_test
 async def test_paged_search(client, basedn):
     """Test paged results control."""
@@ -202,6 +276,31 @@ async def test_paged_search_with_auto_acq(client, basedn):
         assert cnt == 6
 
 
+@asyncio_test
+async def test_paged_search_prefetch(client, basedn):
+    """Test that the next page is requested before the current one is consumed."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    async with client.connect(True) as conn:
+        abandoned = []
+        abandon = conn.abandon
+
+        def abandon_spy(msg_id):
+            abandoned.append(msg_id)
+            abandon(msg_id)
+
+        conn.abandon = abandon_spy
+        result = await conn.paged_search(search_dn, 1, page_size=2)
+        res_iter = result.__aiter__()
+        assert isinstance(await res_iter.__anext__(), LDAPEntry)
+        # Stopping the iteration abandons the already requested next page.
+        del res_iter
+        assert len(abandoned) == 1
+        cnt = 0
+        async for item in await conn.paged_search(search_dn, 1, page_size=2):
+            cnt += 1
+        assert cnt == 6
+
+
 @asyncio_test
 async def test_async_with(client):
     """Test async with context manager (with backward compatibility)."""
@@ -253,6 +352,43 @@ async def test_pool_get_put(client):
     assert time.time() - start >= delay
 
 
+@asyncio_test
+async def test_pool_open_concurrently(client):
+    """Test opening the pool's connections concurrently."""
+    pool = AIOConnectionPool(client, minconn=6, maxconn=6, warmup_limit=3)
+    await pool.open()
+    assert pool.closed == False
+    assert pool.idle_connection == 6
+    assert pool.warmup_errors == []
+    await pool.close()
+
+
+@asyncio_test
+async def test_pool_open_cancelled(client):
+    """Test that a cancelled warm-up closes the already opened connections."""
+    pool = AIOConnectionPool(client, minconn=3, maxconn=3, warmup_limit=1)
+    opened = []
+    connect = client.connect
+
+    async def connect_spy(*args, **kwargs):
+        if len(opened) == 2:
+            raise asyncio.CancelledError()
+        conn = await connect(*args, **kwargs)
+        opened.append(conn)
+        return conn
+
+    client.connect = connect_spy
+    try:
+        with pytest.raises(asyncio.CancelledError):
+            await pool.open()
+    finally:
+        del client.connect
+    assert len(opened) == 2
+    assert all(conn.closed for conn in opened)
+    assert pool.closed == True
+    assert pool.idle_connection == 0
+
+
 @asyncio_test
 async def test_pool_close(client):
     """Test closing the pool."""
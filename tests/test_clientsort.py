@@ -0,0 +1,53 @@
+import pytest
+
+from bonsai import LDAPEntry
+from bonsai.clientsort import ExternalSorter
+
+
+def make_entry(name, **attrs):
+    entry = LDAPEntry("cn=%s,dc=bonsai,dc=test" % name)
+    entry["cn"] = [name]
+    for key, values in attrs.items():
+        entry[key] = values
+    return entry
+
+
+def test_init():
+    """ Test ExternalSorter's parameter checks. """
+    with pytest.raises(ValueError):
+        _ = ExternalSorter([])
+    with pytest.raises(ValueError):
+        _ = ExternalSorter(["cn"], buffer_size=0)
+
+
+@pytest.mark.parametrize("buffer_size", [100, 3, 1])
+def test_sort(buffer_size):
+    """ Test sorting entries in memory and with spilled runs. """
+    names = ["delta", "Alpha", "echo", "charlie", "bravo", "golf", "foxtrot"]
+    sorter = ExternalSorter(["cn"], buffer_size)
+    sorter.extend(make_entry(name) for name in names)
+    assert sorter.spilled_runs == len(names) // buffer_size
+    result = list(sorter)
+    assert [ent["cn"][0] for ent in result] == sorted(names, key=str.lower)
+    assert all(isinstance(ent, LDAPEntry) for ent in result)
+    assert result[0].dn == "cn=Alpha,dc=bonsai,dc=test"
+
+
+def test_sort_multiple_keys():
+    """ Test sorting by multiple keys with descending order. """
+    sorter = ExternalSorter(["-uidNumber", "cn"], buffer_size=2)
+    sorter.add(make_entry("a", uidNumber=[1]))
+    sorter.add(make_entry("b", uidNumber=[2]))
+    sorter.add(make_entry("c", uidNumber=[1, 3]))
+    sorter.add(make_entry("d"))
+    sorter.add(make_entry("e", uidNumber=[2]))
+    # The largest value of a multivalued attribute is used for descending
+    # order, and the entries without the attribute are sorted first.
+    assert [ent["cn"][0] for ent in sorter] == ["d", "c", "b", "e", "a"]
+    sorter = ExternalSorter(["uidNumber", "cn"], buffer_size=2)
+    sorter.add(make_entry("a"))
+    sorter.add(make_entry("b", uidNumber=[2]))
+    sorter.add(make_entry("c", uidNumber=[1, 3]))
+    # In ascending order the smallest value is used and the entries
+    # without the attribute are sorted last.
+    assert [ent["cn"][0] for ent in sorter] == ["c", "b", "a"]
@@ -1,8 +1,12 @@
 import sys
+import time
+from unittest import mock
+
 import bonsai.errors
 from bonsai import get_vendor_info
 from bonsai import LDAPClient
 from bonsai import LDAPEntry
+from bonsai.ldapconnection import BaseLDAPConnection
 
 import pytest
 from conftest import get_config, network_delay
@@ -158,6 +162,56 @@ def test_whoami(gclient):
         assert obj in expected_res
 
 
+def test_compare_many(gclient, basedn):
+    """ Test comparing pipelined values. """
+    dname = "cn=chuck,ou=nerdherd,%s" % basedn
+    with gclient.connect(True) as conn:
+        assertions = [(dname, "cn", name) for name in ("chuck", "jeff", "CHUCK")]
+        assert conn.compare_many(assertions, pipeline_depth=2) == [True, False, True]
+        assert conn.compare_many([]) == []
+
+
+def test_concurrent_operations(gclient):
+    """ Test running multiple operations on the same connection concurrently. """
+    with gclient.connect(True) as conn:
+        expected = conn.search()
+        greenlets = [gevent.spawn(conn.search) for _ in range(10)]
+        greenlets.append(gevent.spawn(conn.whoami))
+        gevent.joinall(greenlets, timeout=10, raise_error=True)
+    assert all(grl.successful() for grl in greenlets)
+    assert all(len(grl.value) == len(expected) for grl in greenlets[:-1])
+
+
+def test_dispatch_queued_response(gclient):
+    """
+    Test that a response, that's queued by libldap while reading the
+    response of another operation, still wakes up its waiting greenlet.
+    """
+    get_result = BaseLDAPConnection.get_result
+    held = []
+    released = []
+
+    def get_result_spy(self, msg_id, *args, **kwargs):
+        if not held:
+            held.append(msg_id)
+        if msg_id == held[0] and not released:
+            # Pretend that the response hasn't arrived yet.
+            return None
+        res = get_result(self, msg_id, *args, **kwargs)
+        if res is not None:
+            released.append(msg_id)
+        return res
+
+    with gclient.connect(True) as conn:
+        with mock.patch.object(BaseLDAPConnection, "get_result", get_result_spy):
+            greenlets = [gevent.spawn(conn.whoami) for _ in range(2)]
+            gevent.idle()
+            # Block the hub to receive both responses in one read.
+            time.sleep(1)
+            gevent.joinall(greenlets, timeout=10, raise_error=True)
+    assert all(grl.successful() for grl in greenlets)
+
+
 @pytest.mark.skipif(
     get_vendor_info()[1] < 20445 or sys.platform != "linux",
     reason="No async timeout support",
@@ -4,7 +4,7 @@ import pytest
 from conftest import get_config, network_delay
 
 import bonsai
-from bonsai import LDAPClient
+from bonsai import LDAPClient, LDAPDN
 from bonsai.ldapconnection import LDAPConnection
 
 
@@ -186,6 +186,15 @@ def test_auto_acquire_prop(client):
     assert not client.auto_page_acquire
 
 
+def test_auto_range_acquire_prop(client):
+    """Test auto_range_acquire property."""
+    with pytest.raises(TypeError):
+        client.set_auto_range_acquire("A")
+    assert client.auto_range_acquire
+    client.auto_range_acquire = False
+    assert not client.auto_range_acquire
+
+
 def test_server_chase_referrals(client):
     """Test server_chase_referrals property."""
     with pytest.raises(TypeError):
@@ -327,3 +336,22 @@ def test_set_sasl_sec_properties(url):
     )
     with client.connect() as conn:
         assert conn is not None
+
+
+def test_dn_attributes(client):
+    """Test setting DN attributes to convert their values to LDAPDN."""
+    with pytest.raises(TypeError):
+        client.set_dn_attributes([5])
+    with pytest.raises(ValueError):
+        client.dn_attributes = ["member", "Member"]
+    client.set_dn_attributes(["namingContexts", "objectClass"])
+    assert client.dn_attributes == ["namingContexts", "objectClass"]
+    conn = client.connect()
+    root_dse = conn.search("", 0, attrlist=["namingContexts", "objectClass"])[0]
+    assert isinstance(root_dse["namingContexts"][0], LDAPDN)
+    assert root_dse["namingContexts"][0] == client.get_rootDSE()["namingContexts"][0]
+    # The shared objects cannot be changed in place.
+    with pytest.raises(TypeError):
+        root_dse["namingContexts"][0][0] = "dc=other"
+    # Not valid DN values are kept as strings.
+    assert isinstance(root_dse["objectClass"][0], str)
@@ -3,6 +3,7 @@ import sys
 import subprocess
 import tempfile
 import time
+from unittest import mock
 
 import pytest
 from conftest import get_config, network_delay
@@ -14,7 +15,7 @@ from bonsai import LDAPConnection
 from bonsai import LDAPSearchScope
 import bonsai.errors
 from bonsai.errors import ClosedConnection, SizeLimitError
-from bonsai.ldapconnection import BaseLDAPConnection
+from bonsai.ldapconnection import BaseLDAPConnection, _RangedAttribute
 
 
 class SimpleAsyncConn(BaseLDAPConnection):
@@ -584,6 +585,45 @@ def test_vlv_attrvalue(conn, basedn):
     assert res[0]["uidNumber"][0] == 1
 
 
+def test_vlv_cursor(conn, basedn):
+    """Test random access of a search result with VLV cursor."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    with pytest.raises(bonsai.UnwillingToPerform):
+        _ = conn.virtual_list_cursor(search_dn, 1)
+    with pytest.raises(ValueError):
+        _ = conn.virtual_list_cursor(search_dn, 1, sort_order=["uidNumber"], window_size=0)
+    with conn.virtual_list_cursor(
+        search_dn,
+        1,
+        attrlist=["uidNumber"],
+        sort_order=["uidNumber"],
+        window_size=2,
+        cache_size=2,
+    ) as cursor:
+        assert len(cursor) == 6
+        assert cursor[0]["uidNumber"][0] == 0
+        assert cursor[-1]["uidNumber"][0] == 5
+        assert [ent["uidNumber"][0] for ent in cursor[1:5]] == [1, 2, 3, 4]
+        assert [ent["uidNumber"][0] for ent in cursor[::-2]] == [5, 3, 1]
+        assert len(list(cursor)) == 6
+        with pytest.raises(IndexError):
+            _ = cursor[6]
+
+
+def test_vlv_cursor_dropped(conn, basedn):
+    """Test that dropping a VLV cursor abandons its prefetch request."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    cursor = conn.virtual_list_cursor(
+        search_dn, 1, attrlist=["uidNumber"], sort_order=["uidNumber"], window_size=2
+    )
+    assert cursor[0]["uidNumber"][0] == 0
+    with mock.patch.object(conn, "_abandon_unwaited") as abandon:
+        del cursor
+    abandon.assert_called_once()
+    # The connection is still usable.
+    assert conn.whoami() is not None
+
+
 def test_vlv_without_sort_order(conn, basedn):
     """Test VLV control without sort control."""
     search_dn = "ou=nerdherd,%s" % basedn
@@ -633,6 +673,63 @@ def test_paged_search_with_auto_acq(cfg, basedn):
     assert res.acquire_next_page() is None
 
 
+def test_paged_search_client_sort(conn, basedn):
+    """Test paged search with client side sorting."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    res = conn.paged_search(
+        search_dn,
+        1,
+        attrlist=["uidNumber"],
+        sort_order=["-uidNumber"],
+        page_size=2,
+        client_sort=True,
+        sort_buffer_size=2,
+    )
+    assert [ent["uidNumber"][0] for ent in res] == [5, 4, 3, 2, 1, 0]
+    with pytest.raises(ValueError):
+        _ = conn.paged_search(search_dn, 1, page_size=2, client_sort=True)
+
+
+def test_paged_search_client_sort_page_size(conn, basedn):
+    """Test the default page size of paged search with client side sorting."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    with mock.patch.object(
+        BaseLDAPConnection,
+        "paged_search",
+        autospec=True,
+        side_effect=BaseLDAPConnection.paged_search,
+    ) as paged_search:
+        res = conn.paged_search(
+            search_dn,
+            1,
+            attrlist=["uidNumber"],
+            sort_order=["uidNumber"],
+            client_sort=True,
+            sort_buffer_size=4,
+        )
+        assert [ent["uidNumber"][0] for ent in res] == [0, 1, 2, 3, 4, 5]
+    # The page size is the sort buffer size, not a single entry.
+    assert paged_search.call_args[0][9] == 4
+
+
+def test_paged_search_dirsync(conn, basedn):
+    """Test that DirSync can't be used with paged search."""
+    with pytest.raises(ValueError):
+        _ = conn._search_request(basedn, 2, page_size=2, dirsync_flags=0)
+
+
+def test_paged_search_dropped(conn, basedn):
+    """Test dropping a paged search before acquiring every page."""
+    search_dn = "ou=nerdherd,%s" % basedn
+    res = conn.paged_search(search_dn, 1, page_size=2)
+    assert len(res) == 2
+    del res
+    # The connection is still usable, and a new paged search can be started.
+    res = conn.paged_search(search_dn, 1, page_size=2)
+    assert len(res) == 2
+    assert conn.whoami() is not None
+
+
 @pytest.mark.timeout(15)
 def test_search_timeout(conn, basedn):
     """Test search method's timeout."""
@@ -904,3 +1001,256 @@ def test_paged_search_large_result(conn, anonym_conn, basedn, large_org):
         result = anonym_conn.get_result(msgid)
 
     assert entry_num == collected_entry
+
+
+class RangedEntry(bonsai.LDAPEntry):
+    """An entry with settable ranges, like the entries of a search result."""
+
+    _ranges = None
+
+
+def ranged_entry(attr, values, next_range=None):
+    """Get an entry with a slice of a ranged attribute's values."""
+    entry = RangedEntry("cn=ranged,dc=bonsai,dc=test")
+    entry[attr] = values
+    # Same state as the values of a search result.
+    entry[attr].status = 0
+    entry[attr].added.clear()
+    entry._ranges = {attr: next_range} if next_range is not None else {}
+    return entry
+
+
+def test_ranged_attribute_add():
+    """Test joining the slices of a ranged attribute in order."""
+    entry = ranged_entry("member", list(range(1500)), 1500)
+    rattr = _RangedAttribute(entry, "member", 1500)
+    assert rattr.next_ranges(3) == [1500, 3000, 4500]
+    # The slice out of order is kept until the previous one arrives.
+    rattr.add(3000, [ranged_entry("member", list(range(3000, 3200)))])
+    assert not rattr.done
+    assert rattr.values == []
+    assert rattr.next_ranges(3) == [1500, 4500]
+    rattr.add(1500, [ranged_entry("member", list(range(1500, 3000)), 3000)])
+    assert rattr.done
+    assert rattr.values == list(range(1500, 3200))
+    rattr.merge()
+    assert entry["member"] == list(range(3200))
+    assert entry["member"].status == 0
+    assert entry["member"].added == []
+    assert entry._ranges == {}
+
+
+def test_ranged_attribute_last_range():
+    """Test receiving the last range and a smaller range than expected."""
+    entry = ranged_entry("member", list(range(1500)), 1500)
+    rattr = _RangedAttribute(entry, "member", 1500)
+    # The server returns fewer values than the previous range had, thus
+    # the slice requested at 3000 doesn't follow it and it's requested again.
+    rattr.add(3000, [ranged_entry("member", list(range(3000, 3500)), 3500)])
+    rattr.add(1500, [ranged_entry("member", list(range(1500, 2500)), 2500)])
+    assert not rattr.done
+    assert rattr.next_ranges(3) == [2500, 3500, 4500]
+    # The last range (e.g. member;range=2500-*) has no next range.
+    rattr.add(2500, [ranged_entry("member", list(range(2500, 2600)))])
+    assert rattr.done
+    rattr.merge()
+    assert entry["member"] == list(range(2600))
+
+
+def test_ranged_attribute_empty_range():
+    """Test receiving a range without any values."""
+    entry = ranged_entry("member", list(range(1500)), 1500)
+    rattr = _RangedAttribute(entry, "member", 1500)
+    rattr.add(1500, [])
+    assert rattr.done
+    assert rattr.values == []
+    rattr.merge()
+    assert entry["member"] == list(range(1500))
+    assert entry._ranges == {}
+    rattr = _RangedAttribute(ranged_entry("member", ["a"], 1), "member", 1)
+    rattr.add(1, [ranged_entry("cn", ["ranged"])])
+    assert rattr.done
+    assert rattr.values == []
+
+
+@pytest.fixture
+def large_group(conn, basedn):
+    """Create a group with many members, that is deleted after the test."""
+    group = bonsai.LDAPEntry(f"cn=ranged_test,ou=nerdherd,{basedn}")
+    group["objectclass"] = ["top", "groupOfNames"]
+    group["cn"] = "ranged_test"
+    group["member"] = [f"cn=member_{idx},ou=nerdherd,{basedn}" for idx in range(23)]
+    try:
+        conn.add(group)
+    except bonsai.AlreadyExists:
+        conn.delete(group.dn)
+        conn.add(group)
+    yield group
+    conn.delete(group.dn)
+
+
+def test_search_ranged_attribute(conn, large_group):
+    """Test retrieving every value of a ranged attribute."""
+    obj = conn.search(large_group.dn, 0, attrlist=["cn", "member"])[0]
+    assert not any(";range=" in key for key in obj.keys())
+    assert sorted(obj["member"]) == sorted(large_group["member"])
+    assert obj["member"].status == 0
+    assert obj["member"].added == []
+    assert not obj._ranges
+    res, _ = conn.virtual_list_search(
+        large_group.dn, 0, attrlist=["member"], sort_order=["cn"], offset=1
+    )
+    assert len(res[0]["member"]) == len(large_group["member"])
+
+
+def test_search_ranged_attribute_disabled(conn, large_group):
+    """Test that the ranges are kept without auto range acquiring."""
+    client = _generate_client(get_config())
+    client.auto_range_acquire = False
+    with client.connect() as rconn:
+        obj = rconn.search(large_group.dn, 0, attrlist=["member"])[0]
+    keys = [key for key in obj.keys() if key.lower().startswith("member")]
+    if keys == ["member"]:
+        pytest.skip("The server does not return ranged attributes")
+    assert len(keys) == 1
+    assert keys[0].lower().startswith("member;range=0-")
+    assert len(obj[keys[0]]) < len(large_group["member"])
+    assert obj._ranges is None
+
+
+def test_asq_control():
+    """Test encoding the ASQ control and decoding its response."""
+    from bonsai._bonsai import _decode_asq_control, _encode_asq_control
+
+    # SEQUENCE { sourceAttribute OCTET STRING }
+    assert _encode_asq_control("member") == b"\x30\x08\x04\x06member"
+    # SEQUENCE { searchResult ENUMERATED }
+    assert _decode_asq_control(b"\x30\x03\x0a\x01\x00") == 0
+    assert _decode_asq_control(b"\x30\x03\x0a\x01\x35") == 53
+    with pytest.raises(bonsai.LDAPError):
+        _ = _decode_asq_control(b"\x04\x01\x00")
+
+
+def test_attribute_scoped_search(conn, basedn, large_group):
+    """Test searching the entries referenced by a DN-valued attribute."""
+    root_dse = conn.search("", 0, attrlist=["supportedControl"])[0]
+    if "1.2.840.113556.1.4.1504" not in root_dse["supportedControl"]:
+        pytest.skip("Attribute scoped query is not supported by the server")
+    group = bonsai.LDAPEntry(f"cn=asq_test,ou=nerdherd,{basedn}")
+    group["objectclass"] = ["top", "groupOfNames"]
+    group["cn"] = "asq_test"
+    group["member"] = [
+        f"cn=chuck,ou=nerdherd,{basedn}",
+        f"cn=jeff,ou=nerdherd,{basedn}",
+        str(large_group.dn),
+    ]
+    try:
+        conn.add(group)
+    except bonsai.AlreadyExists:
+        conn.delete(group.dn)
+        conn.add(group)
+    try:
+        res = conn.attribute_scoped_search(group.dn, "member", attrlist=["cn"])
+        assert {str(ent["cn"][0]) for ent in res} == {"chuck", "jeff", "ranged_test"}
+        res = conn.attribute_scoped_search(
+            group.dn, "member", "(objectClass=person)", ["cn"], sort_order=["cn"]
+        )
+        assert [ent["cn"][0] for ent in res] == ["chuck", "jeff"]
+        pages = conn.attribute_scoped_search(
+            group.dn, "member", attrlist=["cn"], page_size=1
+        )
+        dnames = set()
+        while True:
+            assert len(pages) == 1
+            dnames.update(ent.dn for ent in pages)
+            msg_id = pages.acquire_next_page()
+            if msg_id is None:
+                break
+            pages = conn.get_result(msg_id)
+        assert dnames == {LDAPDN(dn) for dn in group["member"]}
+    finally:
+        conn.delete(group.dn)
+
+
+def test_compare(conn, basedn, large_group):
+    """Test comparing attribute values."""
+    assert conn.compare(large_group.dn, "cn", "ranged_test") is True
+    assert conn.compare(str(large_group.dn), "cn", "RANGED_TEST") is True
+    assert conn.compare(large_group.dn, "cn", "other") is False
+    assert conn.compare(large_group.dn, "member", large_group["member"][7]) is True
+    assert conn.compare(large_group.dn, "member", b"cn=nobody") is False
+    with pytest.raises(bonsai.NoSuchObjectError):
+        _ = conn.compare(f"cn=nobody,ou=nerdherd,{basedn}", "cn", "nobody")
+    with pytest.raises(TypeError):
+        _ = conn.compare(large_group.dn, 1, "ranged_test")
+
+
+def test_compare_many(conn, basedn, large_group):
+    """Test pipelining compare operations."""
+    members = large_group["member"]
+    assertions = [
+        (large_group.dn, "member", members[idx] if idx % 3 else f"cn=x{idx}")
+        for idx in range(len(members))
+    ]
+    expected = [idx % 3 != 0 for idx in range(len(members))]
+    assert conn.compare_many(assertions) == expected
+    assert conn.compare_many(iter(assertions), pipeline_depth=4) == expected
+    assert conn.compare_many([]) == []
+    with pytest.raises(ValueError):
+        _ = conn.compare_many(assertions, pipeline_depth=0)
+    bad = assertions[:5] + [(f"cn=nobody,{basedn}", "cn", "x")] + assertions[5:]
+    with pytest.raises(bonsai.NoSuchObjectError):
+        _ = conn.compare_many(bad, pipeline_depth=3)
+    # The remaining requests are abandoned, the connection is usable.
+    assert conn.compare(large_group.dn, "cn", "ranged_test") is True
+
+
+def test_compare_many_timeout(conn, basedn):
+    """Test that the timed out compare is abandoned with the outstanding ones."""
+    dname = f"cn=chuck,ou=nerdherd,{basedn}"
+    with mock.patch.object(
+        conn, "_evaluate", side_effect=bonsai.TimeoutError
+    ), mock.patch.object(
+        conn, "_abandon_unwaited", wraps=conn._abandon_unwaited
+    ) as abandon:
+        with pytest.raises(bonsai.TimeoutError):
+            _ = conn.compare_many([(dname, "cn", "chuck")] * 3, pipeline_depth=2)
+    assert abandon.call_count == 2
+    assert conn.compare(dname, "cn", "chuck") is True
+
+
+def test_search_values_filter(conn, large_group):
+    """Test receiving only the matching values with the matched values control."""
+    with pytest.raises(bonsai.errors.FilterError):
+        _ = conn.search(large_group.dn, 0, values_filter="(member=cn=x")
+    with pytest.raises(bonsai.errors.FilterError):
+        _ = conn.search(large_group.dn, 0, values_filter="(&(cn=a)(sn=b))")
+    with pytest.raises(bonsai.errors.FilterError):
+        _ = conn.search(large_group.dn, 0, values_filter="(member:dn:=x)")
+    root_dse = conn.search("", 0, attrlist=["supportedControl"])[0]
+    if "1.2.826.0.1.3344810.2.3" not in root_dse["supportedControl"]:
+        pytest.skip("Matched values control is not supported by the server")
+    # DN-valued attributes are matched by equality, substrings are used
+    # only for the attributes with a substring matching rule.
+    members = large_group["member"]
+    obj = conn.search(
+        large_group.dn, 0, attrlist=["member"], values_filter=f"(member={members[1]})"
+    )[0]
+    assert obj["member"] == [members[1]]
+    obj = conn.search(
+        large_group.dn,
+        0,
+        attrlist=["cn", "member"],
+        values_filter=f"((member={members[2]})(member={members[12]})(cn=ranged*))",
+    )[0]
+    assert obj["cn"] == ["ranged_test"]
+    assert sorted(obj["member"]) == sorted([members[2], members[12]])
+    res = conn.paged_search(
+        large_group.dn,
+        0,
+        attrlist=["member"],
+        page_size=2,
+        values_filter=f"(member={members[7]})",
+    )
+    assert len(res) == 1
+    assert list(res)[0]["member"] == [members[7]]
@@ -13,12 +13,10 @@ def dnobj():
 
 
 def test_rdn(dnobj):
-    """ Test methods for retrieving and changing RDNs. """
+    """ Test methods for retrieving RDNs. """
     assert dnobj.rdns[0] == (("cn", "user"),)
     assert dnobj[0] == "cn=user"
     assert dnobj[1:] == "dc=test,dc=local"
-    dnobj[1:] = "dc=test2"
-    assert dnobj == "cn=user,dc=test2"
     with pytest.raises(IndexError):
         _ = dnobj[7]
     with pytest.raises(TypeError):
@@ -58,22 +56,14 @@ def test_special_char():
 
 
 def test_setitem():
-    """ Test setting RDNs for DN object. """
+    """ Test that the RDNs of a DN object cannot be set. """
     dnobj = LDAPDN("sn=some+gn=thing,dc=test,dc=local")
     assert "sn=some+gn=thing" == dnobj[0]
-    dnobj[0] = "cn=user"
-    assert "cn=user,dc=test,dc=local" == dnobj
-    dnobj[1] = "ou=group1,ou=group2"
-    assert "cn=user,ou=group1,ou=group2,dc=local" == dnobj
-    dnobj[2:] = "dc=local"
-    assert "cn=user,ou=group1,dc=local" == dnobj
-
     with pytest.raises(TypeError):
-        dnobj["invalid"] = "ou=group1,ou=group2"
-    with pytest.raises(ValueError):
-        dnobj[0] = 3
-    with pytest.raises(errors.InvalidDN):
-        dnobj[1] = "test,group"
+        dnobj[0] = "cn=user"
+    with pytest.raises(TypeError):
+        dnobj[2:] = "dc=local"
+    assert "sn=some+gn=thing,dc=test,dc=local" == dnobj
 
 
 def test_repr(dnobj):
@@ -90,3 +80,63 @@ def test_space_after_comma():
     dn = LDAPDN("cn=user, dc=test, dc=local")
     assert str(dn) == "cn=user, dc=test, dc=local"
     assert dn.rdns[1][0][0] == "dc"
+
+
+def test_normalized_equal():
+    """ Test comparing DNs by their normalized forms. """
+    dnobj = LDAPDN("sn=Some+gn=thing, dc=test , dc=local")
+    assert dnobj == "GN=thing+SN=some,dc=test,dc=local"
+    assert dnobj == LDAPDN("gn=thing + sn=some,dc=test,dc=local")
+    assert dnobj != "sn=some,dc=test,dc=local"
+    assert LDAPDN(r"cn=special\, name,dc=local") == r"cn=special\2C name,dc=local"
+    assert LDAPDN('cn="special, name",dc=local') == r"cn=special\, name,dc=local"
+    assert LDAPDN(r"cn=\C3\A9,dc=local") == "cn=É,dc=local"
+    assert LDAPDN("cn=#04024869,dc=local") == "cn=#04024869,DC=local"
+
+
+def test_hash():
+    """ Test hashing LDAPDN objects. """
+    dnobj = LDAPDN(VALID_STRDN)
+    assert hash(dnobj) == hash(LDAPDN(VALID_STRDN.upper()))
+    dns = {dnobj: 1, LDAPDN("CN=user, dc=test, dc=local"): 2}
+    assert len(dns) == 1
+    assert hash(dnobj) != hash(LDAPDN("cn=other,dc=test,dc=local"))
+
+
+def test_negative_index():
+    """ Test negative indices of LDAPDN. """
+    dnobj = LDAPDN(VALID_STRDN)
+    assert dnobj[-1] == "dc=local"
+    assert dnobj[-2:] == "dc=test,dc=local"
+    assert len(dnobj) == 3
+    assert len(LDAPDN("")) == 0
+
+
+def test_rdns_unescaped():
+    """ Test that the RDNs contain the unescaped attribute values. """
+    dnobj = LDAPDN(r"cn=special\, name+sn=a\2Cb,ou=\ spaced\ ,dc=local")
+    assert dnobj.rdns[0] == (("cn", "special, name"), ("sn", "a,b"))
+    assert dnobj.rdns[1] == (("ou", " spaced "),)
+    assert dnobj[0] == r"cn=special\, name+sn=a\2Cb"
+    assert LDAPDN('cn="quoted, value",dc=local').rdns[0] == (
+        ("cn", "quoted, value"),
+    )
+    assert LDAPDN(r"cn=\C3\A9 ,dc=local").rdns[0] == (("cn", "é"),)
+    assert LDAPDN("cn=#04024869,dc=local").rdns[0] == (("cn", "#04024869"),)
+
+
+def test_invalid_values():
+    """ Test InvalidDN exception for malformed attribute values. """
+    for strdn in (
+        "cn=test,",
+        "=test",
+        "cn=te<st",
+        "cn=#0",
+        r"cn=test\x",
+        'cn="test',
+        "1.=test",
+    ):
+        with pytest.raises(errors.InvalidDN):
+            _ = LDAPDN(strdn)
+    with pytest.raises(TypeError):
+        _ = LDAPDN(1)
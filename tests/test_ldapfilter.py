@@ -0,0 +1,147 @@
+import pytest
+
+from bonsai import LDAPEntry, LDAPFilter
+from bonsai.errors import FilterError
+
+
+@pytest.fixture
+def entry():
+    """ Get an entry for matching. """
+    entry = LDAPEntry("cn=Test User,ou=nerdherd,dc=bonsai,dc=test")
+    entry["objectClass"] = ["top", "inetOrgPerson"]
+    entry["cn"] = ["Test User"]
+    entry["sn"] = "User"
+    entry["mail"] = ["test.user@bonsai.test", "TU@Bonsai.test"]
+    entry["uidNumber"] = 1042
+    entry["userAccountControl"] = 514
+    entry["jpegPhoto"] = b"\x00\xff(*)"
+    entry["description;lang-en"] = "English"
+    return entry
+
+
+def test_parse():
+    """ Test parsing valid and malformed filters. """
+    flt = LDAPFilter("(&(cn=a*b*c)(!(sn~=x))(|(uid>=1)(uid<=2))(mail=*))")
+    assert str(flt) == "(&(cn=a*b*c)(!(sn~=x))(|(uid>=1)(uid<=2))(mail=*))"
+    assert flt._tree() == (
+        "&",
+        [
+            ("*", "cn", b"a", [b"b"], b"c"),
+            ("!", ("~=", "sn", b"x")),
+            ("|", [(">=", "uid", b"1"), ("<=", "uid", b"2")]),
+            ("=*", "mail"),
+        ],
+    )
+    assert LDAPFilter(" uid=test ")._tree() == ("=", "uid", b"test ")
+    assert LDAPFilter("(cn=a\\2a\\28\\29)")._tree() == ("=", "cn", b"a*()")
+    assert LDAPFilter("(cn:dn:2.5.13.5:=Test)")._tree() == (
+        ":=",
+        "cn",
+        "2.5.13.5",
+        True,
+        b"Test",
+    )
+    assert LDAPFilter("(&)")._tree() == ("&", [])
+    for invalid in (
+        "",
+        "(cn=test",
+        "(cn=te(st)",
+        "(cn=a\\zz)",
+        "((cn=test))",
+        "(cn>x)",
+        "(cn~=a*)",
+        "(:=test)",
+        "(cn=test))",
+        "(!(a=b)(c=d))",
+    ):
+        with pytest.raises(FilterError):
+            LDAPFilter(invalid)
+    with pytest.raises(TypeError):
+        LDAPFilter(b"(cn=test)")
+
+
+def test_match(entry):
+    """ Test matching an entry. """
+    assert LDAPFilter("(cn=test user)").match(entry)
+    assert LDAPFilter("(objectClass=*)").match(LDAPEntry("cn=x"))
+    assert LDAPFilter("(mail=tu@bonsai.TEST)").match(entry)
+    assert not LDAPFilter("(mail=tu)").match(entry)
+    assert LDAPFilter("(mail=*@bonsai.test)").match(entry)
+    assert LDAPFilter("(mail=test*user*)").match(entry)
+    assert not LDAPFilter("(mail=test*bonsai*user)").match(entry)
+    assert not LDAPFilter("(cn=test*user*user)").match(entry)
+    assert LDAPFilter("(uidNumber>=999)").match(entry)
+    assert not LDAPFilter("(uidNumber<=999)").match(entry)
+    assert LDAPFilter("(sn<=v)").match(entry)
+    assert LDAPFilter("(userAccountControl:1.2.840.113556.1.4.803:=2)").match(entry)
+    assert not LDAPFilter("(userAccountControl:1.2.840.113556.1.4.803:=3)").match(
+        entry
+    )
+    assert LDAPFilter("(userAccountControl:1.2.840.113556.1.4.804:=3)").match(entry)
+    assert not LDAPFilter("(sn:caseExactMatch:=user)").match(entry)
+    assert LDAPFilter("(:caseExactMatch:=User)").match(entry)
+    assert LDAPFilter("(jpegPhoto=\\00\\ff\\28\\2a\\29)").match(entry)
+    assert LDAPFilter("(description=english)").match(entry)
+    assert not LDAPFilter("(description;lang-hu=*)").match(entry)
+    assert LDAPFilter("(&(sn=user)(|(uid=x)(!(uid=*))))").match(entry)
+    assert not LDAPFilter("(|)").match(entry)
+    assert not LDAPFilter("(dn=*)").match(entry)
+    with pytest.raises(ValueError):
+        LDAPFilter("(member:1.2.840.113556.1.4.1941:=cn=x)").match(entry)
+    with pytest.raises(TypeError):
+        LDAPFilter("(cn=x)").match([])
+
+
+def test_parse_like_libldap():
+    """ Test that the accepted filters are the same as libldap's. """
+    assert LDAPFilter("(&(cn=a)\n(sn=b))")._tree() == (
+        "&",
+        [("=", "cn", b"a"), ("=", "sn", b"b")],
+    )
+    assert LDAPFilter("(&(cn=a)\t(sn=b))")._tree() == (
+        "&",
+        [("=", "cn", b"a"), ("=", "sn", b"b")],
+    )
+    assert LDAPFilter("(|(cn=a)(cn=b)\n)")._tree() == (
+        "|",
+        [("=", "cn", b"a"), ("=", "cn", b"b")],
+    )
+    assert LDAPFilter("(cn::=x)")._tree() == (":=", "cn", None, False, b"x")
+    assert LDAPFilter("(cn:dn::=x)")._tree() == (":=", "cn", None, True, b"x")
+    assert LDAPFilter("(:dn:caseExactMatch:=x)")._tree() == (
+        ":=",
+        None,
+        "caseexactmatch",
+        True,
+        b"x",
+    )
+    assert LDAPFilter("(2.5.4.3;lang-en=x)")._tree() == ("=", "2.5.4.3;lang-en", b"x")
+    for invalid in (
+        "(_cn=a)",
+        "(c_n=a)",
+        "(c.n=a)",
+        "(cn;=a)",
+        "(2.5..4=a)",
+        "(cn:x_y:=a)",
+        "(cn:a:b:=x)",
+        "(cn:::=x)",
+        "(:dn:=x)",
+    ):
+        with pytest.raises(FilterError):
+            LDAPFilter(invalid)
+
+
+def test_filter(entry):
+    """ Test filtering entries and dicts. """
+    entries = [entry, {"cn": ("other",)}, {"CN": "Test User"}]
+    flt = LDAPFilter("(cn=test user)")
+    assert list(flt.filter(entries)) == [entry, {"CN": "Test User"}]
+
+
+def test_search_validation(client):
+    """ Test that malformed filters are not sent to the server. """
+    with client.connect() as conn:
+        with pytest.raises(FilterError):
+            conn.search(filter_exp="(cn=sam")
+        res = conn.search(filter_exp=LDAPFilter("(cn=sam)"))
+        assert len(res) == 1
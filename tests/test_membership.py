@@ -0,0 +1,183 @@
+import pytest
+
+from bonsai import LDAPDN, LDAPEntry, LDAPSearchScope
+from bonsai.errors import AlreadyExists
+from bonsai.membership import (
+    LDAP_MATCHING_RULE_IN_CHAIN,
+    MembershipResolver,
+    _MembershipCache,
+)
+from bonsai.pool import ThreadedConnectionPool
+
+
+@pytest.fixture(scope="module")
+def pool(client):
+    """ Get an opened threaded connection pool. """
+    pool = ThreadedConnectionPool(client, minconn=1, maxconn=3)
+    pool.open()
+    yield pool
+    pool.close()
+
+
+@pytest.fixture(scope="module")
+def groups(pool, basedn):
+    """
+    Create nested groups with a cycle: chuck is in A, A is in B, B and C
+    are in each other, jeff is in C.
+    """
+    ou = LDAPEntry("ou=mb_test,%s" % basedn)
+    ou["objectClass"] = ["top", "organizationalUnit"]
+    ou["ou"] = "mb_test"
+    users = {
+        "chuck": LDAPDN("cn=chuck,ou=nerdherd,%s" % basedn),
+        "jeff": LDAPDN("cn=jeff,ou=nerdherd,%s" % basedn),
+    }
+    dns = {name: LDAPDN("cn=mb_%s,%s" % (name, ou.dn)) for name in "abc"}
+    members = {
+        "a": [users["chuck"]],
+        "b": [dns["a"], dns["c"]],
+        "c": [dns["b"], users["jeff"]],
+    }
+    with pool.spawn() as conn:
+        try:
+            conn.add(ou)
+        except AlreadyExists:
+            conn.delete(ou.dn, recursive=True)
+            conn.add(ou)
+        for name, dname in dns.items():
+            group = LDAPEntry(dname)
+            group["objectClass"] = ["top", "groupOfNames"]
+            group["cn"] = "mb_%s" % name
+            group["member"] = [str(member) for member in members[name]]
+            conn.add(group)
+    dns.update(users)
+    dns["ou"] = ou.dn
+    yield dns
+    with pool.spawn() as conn:
+        conn.delete(ou.dn, recursive=True)
+
+
+def test_init(pool):
+    """ Test the parameters. """
+    with pytest.raises(ValueError):
+        _ = MembershipResolver(pool, pipeline_depth=0)
+    with pytest.raises(ValueError):
+        _ = MembershipResolver(pool, max_workers=0)
+    with pytest.raises(ValueError):
+        _ = MembershipResolver(pool, ttl=0)
+    with pytest.raises(ValueError):
+        _ = MembershipResolver(pool, maxsize=0)
+    pool.client.auto_range_acquire = False
+    try:
+        with pytest.raises(ValueError):
+            _ = MembershipResolver(pool)
+    finally:
+        pool.client.auto_range_acquire = True
+
+
+def test_groups_of(pool, groups):
+    """ Test resolving the nested groups of principals by walking the graph. """
+    resolver = MembershipResolver(pool, groups["ou"], use_in_chain=False)
+    assert not resolver.use_in_chain
+    res = resolver.groups_of([groups["chuck"], str(groups["jeff"]), groups["a"]])
+    assert res == {
+        groups["chuck"]: {groups["a"], groups["b"], groups["c"]},
+        groups["jeff"]: {groups["b"], groups["c"]},
+        groups["a"]: {groups["b"], groups["c"]},
+    }
+
+
+def test_members_of(pool, groups):
+    """ Test resolving the nested members of groups by walking the graph. """
+    resolver = MembershipResolver(
+        pool, groups["ou"], use_in_chain=False, pipeline_depth=1, max_workers=1
+    )
+    res = resolver.members_of([groups["b"], groups["a"]])
+    assert res == {
+        groups["b"]: {groups["a"], groups["c"], groups["chuck"], groups["jeff"]},
+        groups["a"]: {groups["chuck"]},
+    }
+
+
+def test_members_of_ranged(pool, groups):
+    """ Test resolving the members of a group with a ranged member attribute. """
+    group = LDAPEntry("cn=mb_large,%s" % groups["ou"])
+    group["objectClass"] = ["top", "groupOfNames"]
+    group["cn"] = "mb_large"
+    group["member"] = ["cn=mb_member_%d,%s" % (idx, groups["ou"]) for idx in range(23)]
+    with pool.spawn() as conn:
+        conn.add(group)
+    try:
+        resolver = MembershipResolver(pool, groups["ou"], use_in_chain=False)
+        res = resolver.members_of([group.dn])
+        assert res[group.dn] == {LDAPDN(member) for member in group["member"]}
+    finally:
+        with pool.spawn() as conn:
+            conn.delete(group.dn)
+
+
+def test_shared_dns(pool, groups):
+    """ Test that the results share the immutable memoized DNs. """
+    resolver = MembershipResolver(pool, groups["ou"], use_in_chain=False)
+    first = resolver.groups_of([groups["chuck"]])[groups["chuck"]]
+    first.clear()
+    second = resolver.groups_of([groups["chuck"]])[groups["chuck"]]
+    assert second == {groups["a"], groups["b"], groups["c"]}
+    with pytest.raises(TypeError):
+        next(iter(second))[0] = "cn=changed"
+
+
+def test_cache(pool, groups):
+    """ Test that the lookups are memoized until the cache is cleared. """
+    resolver = MembershipResolver(pool, groups["ou"], use_in_chain=False)
+    assert resolver.groups_of([groups["jeff"]])[groups["jeff"]] == {
+        groups["b"],
+        groups["c"],
+    }
+    with pool.spawn() as conn:
+        group = conn.search(groups["c"], LDAPSearchScope.BASE)[0]
+        group["member"].remove(str(groups["jeff"]))
+        group.modify()
+        try:
+            assert resolver.groups_of([groups["jeff"]])[groups["jeff"]] == {
+                groups["b"],
+                groups["c"],
+            }
+            resolver.clear_cache()
+            assert resolver.groups_of([groups["jeff"]])[groups["jeff"]] == set()
+        finally:
+            group["member"].append(str(groups["jeff"]))
+            group.modify()
+
+
+def test_cache_maxsize():
+    """ Test that the least recently used lookups are dropped. """
+    cache = _MembershipCache(60, 2)
+    cache.put("a", frozenset())
+    cache.put("b", frozenset())
+    assert cache.get("a") is not None
+    cache.put("c", frozenset())
+    assert cache.get("b") is None
+    assert cache.get("a") is not None
+    assert cache.get("c") is not None
+
+
+def test_in_chain(pool, basedn, groups):
+    """ Test resolving the memberships with the in chain matching rule. """
+    with pool.spawn() as conn:
+        res = conn.search(
+            groups["ou"],
+            LDAPSearchScope.SUBTREE,
+            "(member:%s:=%s)" % (LDAP_MATCHING_RULE_IN_CHAIN, groups["chuck"]),
+            ["1.1"],
+        )
+    if len(res) != 3:
+        pytest.skip("The in chain matching rule is not supported by the server")
+    resolver = MembershipResolver(pool, groups["ou"], use_in_chain=True)
+    assert resolver.groups_of([groups["chuck"], groups["jeff"]]) == {
+        groups["chuck"]: {groups["a"], groups["b"], groups["c"]},
+        groups["jeff"]: {groups["b"], groups["c"]},
+    }
+    # The members are searched under the base too.
+    resolver = MembershipResolver(pool, basedn, use_in_chain=True)
+    assert resolver.members_of([groups["a"]]) == {groups["a"]: {groups["chuck"]}}
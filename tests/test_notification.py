@@ -0,0 +1,176 @@
+import asyncio
+import sys
+from itertools import islice
+from unittest import mock
+
+import pytest
+
+from bonsai import LDAPDN, LDAPSearchScope
+from bonsai.notification import (
+    AD_NOTIFICATION,
+    ChangeNotifier,
+    ChangeType,
+)
+from bonsai.searchcache import SearchCache
+
+pytestmark = pytest.mark.skipif(
+    sys.platform == "win32", reason="Change notification is not supported"
+)
+
+PSEARCH_OID = "2.16.840.1.113730.3.4.3"
+AD_NOTIFICATION_OID = "1.2.840.113556.1.4.528"
+
+
+@pytest.fixture(scope="module")
+def controls(client):
+    """ Get the supported controls of the server. """
+    return client.get_rootDSE()["supportedControl"]
+
+
+def receive(notifier, num):
+    """ Wait for the given number of changes, without waiting for more. """
+    return list(islice(notifier.listen(timeout=10), num))
+
+
+def test_init(conn):
+    """ Test the mode parameter. """
+    with pytest.raises(ValueError):
+        _ = ChangeNotifier(conn, mode=0)
+
+
+def test_listen(client, conn, controls, basedn, entry):
+    """ Test receiving the changes of a persistent search. """
+    if PSEARCH_OID not in controls:
+        pytest.skip("Persistent search is not supported by the server")
+    base = "ou=nerdherd,%s" % basedn
+    cache = SearchCache()
+    cache.put("key", base, [], cache.generation)
+    with client.connect() as wconn:
+        with ChangeNotifier(
+            conn, base, LDAPSearchScope.ONELEVEL, search_cache=cache
+        ) as notifier:
+            assert notifier.search_cache is cache
+            assert list(notifier.listen(timeout=0.5)) == []
+            wconn.add(entry)
+            changes = receive(notifier, 1)
+            assert [(chg.change_type, chg.entry.dn) for chg in changes] == [
+                (ChangeType.ADD, entry.dn)
+            ]
+            assert cache.get("key") is None
+            entry["sn"] = "changed"
+            entry.modify()
+            changes = receive(notifier, 1)
+            assert [chg.change_type for chg in changes] == [ChangeType.MODIFY]
+            assert changes[0].entry["sn"] == ["changed"]
+            old_dn = entry.dn
+            entry.rename("cn=test_entry2,%s" % base)
+            changes = receive(notifier, 1)
+            assert [chg.change_type for chg in changes] == [ChangeType.MODDN]
+            assert changes[0].previous_dn == old_dn
+            wconn.delete(entry.dn)
+            changes = receive(notifier, 1)
+            assert [chg.change_type for chg in changes] == [ChangeType.DELETE]
+            assert changes[0].change_number is None or changes[0].change_number > 0
+
+
+def test_change_types(conn, controls, basedn, entry):
+    """ Test filtering the types of the changes and the initial content. """
+    if PSEARCH_OID not in controls:
+        pytest.skip("Persistent search is not supported by the server")
+    base = "ou=nerdherd,%s" % basedn
+    with ChangeNotifier(
+        conn,
+        base,
+        LDAPSearchScope.ONELEVEL,
+        "(objectClass=inetOrgPerson)",
+        change_types=ChangeType.DELETE,
+        changes_only=False,
+    ) as notifier:
+        expected = conn.search(
+            base, LDAPSearchScope.ONELEVEL, "(objectClass=inetOrgPerson)"
+        )
+        changes = receive(notifier, len(expected))
+        assert len(changes) == len(expected)
+        assert all(chg.change_type is None for chg in changes)
+        conn.add(entry)
+        assert list(notifier.listen(timeout=0.5)) == []
+        conn.delete(entry.dn)
+        changes = receive(notifier, 1)
+        assert [chg.change_type for chg in changes] == [ChangeType.DELETE]
+
+
+def test_ad_notification(client, conn, controls, basedn, entry):
+    """ Test the change notification of Active Directory. """
+    if AD_NOTIFICATION_OID not in controls:
+        pytest.skip("Change notification is not supported by the server")
+    base = "ou=nerdherd,%s" % basedn
+    with client.connect() as wconn:
+        with ChangeNotifier(
+            conn,
+            base,
+            LDAPSearchScope.ONELEVEL,
+            "(objectClass=*)",
+            mode=AD_NOTIFICATION,
+        ) as notifier:
+            assert list(notifier.listen(timeout=0.5)) == []
+            wconn.add(entry)
+            changes = receive(notifier, 1)
+            assert [(chg.change_type, chg.entry.dn) for chg in changes] == [
+                (None, entry.dn)
+            ]
+
+
+def test_listen_async(client, conn, controls, basedn, entry):
+    """ Test receiving the changes with an async connection. """
+    if PSEARCH_OID not in controls:
+        pytest.skip("Persistent search is not supported by the server")
+
+    base = "ou=nerdherd,%s" % basedn
+    expected = len(conn.search(base, LDAPSearchScope.ONELEVEL))
+
+    async def listen():
+        async with client.connect(True) as aconn:
+            notifier = ChangeNotifier(
+                aconn, base, LDAPSearchScope.ONELEVEL, changes_only=False
+            )
+            stream = notifier.listen_async()
+            # The initial content shows that the search is already open.
+            for _ in range(expected):
+                change = await asyncio.wait_for(stream.__anext__(), 5)
+                assert change.change_type is None
+            conn.add(entry)
+            change = await asyncio.wait_for(stream.__anext__(), 5)
+            assert change.change_type == ChangeType.ADD
+            assert change.entry.dn == LDAPDN(str(entry.dn))
+            await stream.aclose()
+            notifier.close()
+
+    asyncio.run(listen())
+
+
+def test_listen_async_cancel(client, controls, basedn):
+    """ Test that cancelling the consuming task abandons the search. """
+    if PSEARCH_OID not in controls:
+        pytest.skip("Persistent search is not supported by the server")
+
+    async def listen():
+        async with client.connect(True) as aconn:
+            notifier = ChangeNotifier(
+                aconn, "ou=nerdherd,%s" % basedn, LDAPSearchScope.ONELEVEL
+            )
+            with mock.patch.object(
+                aconn, "_abandon_unwaited", wraps=aconn._abandon_unwaited
+            ) as abandon:
+                task = asyncio.ensure_future(notifier.listen_async().__anext__())
+                # Let the task send the request and wait for the changes.
+                await asyncio.sleep(0)
+                task.cancel()
+                with pytest.raises(asyncio.CancelledError):
+                    await task
+                assert abandon.called
+                # The search is already abandoned.
+                abandon.reset_mock()
+                notifier.close()
+                assert not abandon.called
+
+    asyncio.run(listen())
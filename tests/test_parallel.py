@@ -0,0 +1,74 @@
+import pytest
+
+from bonsai import LDAPSearchScope
+from bonsai.errors import SizeLimitError
+from bonsai.parallel import parallel_search, split_search
+from bonsai.pool import ThreadedConnectionPool
+
+
+@pytest.fixture(scope="module")
+def pool(client):
+    """ Get an opened threaded connection pool. """
+    pool = ThreadedConnectionPool(client, minconn=1, maxconn=4)
+    pool.open()
+    yield pool
+    pool.close()
+
+
+def test_split_search_onelevel(pool, basedn):
+    """ Test partitioning a one level search by attribute prefixes. """
+    with pool.spawn() as conn:
+        expected = conn.search(basedn, LDAPSearchScope.ONELEVEL)
+        with pytest.raises(SizeLimitError):
+            conn.search(basedn, LDAPSearchScope.ONELEVEL, sizelimit=2)
+    res = split_search(pool, basedn, LDAPSearchScope.ONELEVEL, sizelimit=2)
+    assert len(res) == len(expected)
+    assert {ent.dn for ent in res} == {ent.dn for ent in expected}
+
+
+def test_split_search_subtree(pool, basedn):
+    """ Test splitting a subtree search by children and prefixes. """
+    with pool.spawn() as conn:
+        expected = conn.search(basedn, LDAPSearchScope.SUBTREE)
+    res = split_search(pool, basedn, LDAPSearchScope.SUBTREE, "objectClass=*", sizelimit=3)
+    assert len(res) == len(expected)
+    assert {ent.dn for ent in res} == {ent.dn for ent in expected}
+    res = split_search(pool, basedn, LDAPSearchScope.SUBTREE, "(cn=*)", ["cn"], sizelimit=2)
+    assert all(list(ent.keys()) == ["dn", "cn"] for ent in res)
+    assert {ent.dn for ent in res} == {ent.dn for ent in expected if "cn" in ent}
+
+
+def test_split_search_limit(pool, basedn):
+    """ Test that the error is raised, when the search can't be split. """
+    with pytest.raises(SizeLimitError):
+        split_search(
+            pool, basedn, LDAPSearchScope.ONELEVEL, sizelimit=1, max_depth=0
+        )
+
+
+def test_parallel_search(pool, basedn):
+    """ Test searching the subtrees of the children concurrently. """
+    with pool.spawn() as conn:
+        expected = conn.search(basedn, LDAPSearchScope.SUBTREE, "(objectClass=*)")
+    res = list(parallel_search(pool, basedn, "(objectClass=*)"))
+    assert len(res) == len(expected)
+    assert {ent.dn for ent in res} == {ent.dn for ent in expected}
+    # Split the subtrees as soon as possible.
+    res = list(
+        parallel_search(
+            pool, basedn, "(objectClass=*)", parallelism=4, page_size=1, split_threshold=1
+        )
+    )
+    assert len(res) == len(expected)
+    assert {ent.dn for ent in res} == {ent.dn for ent in expected}
+    # Stopping the iteration early leaves the pool's connections usable.
+    res = parallel_search(pool, basedn, "(objectClass=*)", page_size=1)
+    assert next(res) is not None
+    res.close()
+    # The workers are finished, their connections are back in the pool.
+    assert pool.shared_connection == 0
+    res = list(parallel_search(pool, basedn, "(cn=chuck)", ["cn"]))
+    assert len(res) == 1
+    assert res[0]["cn"] == ["chuck"]
+    with pytest.raises(ValueError):
+        _ = parallel_search(pool, basedn, parallelism=0)
@@ -1,5 +1,6 @@
 import pytest
 
+import bonsai
 from bonsai import LDAPClient
 from bonsai.pool import (
     ClosedPool,
@@ -9,6 +10,7 @@ from bonsai.pool import (
     ThreadedConnectionPool,
 )
 
+import itertools
 import math
 import threading
 import time
@@ -21,12 +23,15 @@ def test_init():
         _ = ConnectionPool(cli, minconn=-3)
     with pytest.raises(ValueError):
         _ = ConnectionPool(cli, minconn=5, maxconn=3)
+    with pytest.raises(ValueError):
+        _ = ConnectionPool(cli, warmup_limit=0)
     pool = ConnectionPool(cli, minconn=2, maxconn=5)
     assert pool.closed == True
     assert pool.empty == False
     assert pool.max_connection == 5
     assert pool.shared_connection == 0
     assert pool.idle_connection == 0
+    assert pool.client is cli
 
 
 def test_open(client):
@@ -37,6 +42,36 @@ def test_open(client):
     assert pool.idle_connection == 5
 
 
+def test_open_warmup_errors(client, monkeypatch):
+    """ Test opening the pool when some of the connections fail. """
+    connect = client.connect
+    calls = itertools.count(1)
+
+    def failing_connect(*args, **kwargs):
+        if next(calls) % 2 == 0:
+            # Let the successful connections finish first.
+            time.sleep(0.5)
+            raise bonsai.errors.ConnectionError("Can't contact LDAP server.")
+        return connect(*args, **kwargs)
+
+    monkeypatch.setattr(client, "connect", failing_connect)
+    pool = ConnectionPool(client, minconn=6, warmup_limit=3)
+    pool.open()
+    assert pool.closed == False
+    assert pool.idle_connection == 3
+    assert len(pool.warmup_errors) == 3
+    assert all(
+        isinstance(err, bonsai.errors.ConnectionError) for err in pool.warmup_errors
+    )
+    pool.close()
+    cli = LDAPClient("ldap://invalid.host")
+    pool = ConnectionPool(cli, minconn=4, warmup_limit=2)
+    with pytest.raises(bonsai.errors.ConnectionError):
+        pool.open()
+    assert pool.closed == True
+    assert pool.idle_connection == 0
+
+
 def test_close(client):
     """ Test closing the connection. """
     pool = ConnectionPool(client, minconn=1)
@@ -179,3 +214,168 @@ def test_threaded_pool_close(client):
     pool.close()
     assert pool.closed
     t0.join()
+
+
+def test_threaded_pool_timeout(client):
+    """ Test that get raises EmptyPool after the timeout. """
+    pool = ThreadedConnectionPool(client, minconn=1, maxconn=1)
+    pool.open()
+    conn = pool.get()
+    start = time.time()
+    with pytest.raises(EmptyPool):
+        _ = pool.get(timeout=0.5)
+    assert time.time() - start >= 0.5
+    pool.put(conn)
+    assert pool.get(timeout=0.5) is conn
+    pool.close()
+
+
+def test_threaded_pool_fifo(client):
+    """ Test that the waiting threads are served in FIFO order. """
+    pool = ThreadedConnectionPool(client, minconn=1, maxconn=1)
+    pool.open()
+    conn = pool.get()
+    order = []
+
+    def wait(num):
+        with pool.spawn() as conn:
+            order.append(num)
+
+    threads = []
+    for num in range(4):
+        thr = threading.Thread(target=wait, args=(num,))
+        thr.start()
+        threads.append(thr)
+        time.sleep(0.2)
+    pool.put(conn)
+    for thr in threads:
+        thr.join(5)
+    assert order == [0, 1, 2, 3]
+    pool.close()
+
+
+def test_threaded_pool_lifo(client):
+    """ Test that the most recently used idle connection is reused. """
+    pool = ThreadedConnectionPool(client, minconn=3, maxconn=3)
+    pool.open()
+    conns = [pool.get() for _ in range(3)]
+    for conn in conns:
+        pool.put(conn)
+    assert pool.get() is conns[-1]
+    pool.close()
+
+
+def backdate(pool, conns, secs):
+    """ Move the creation and idle times of the connections to the past. """
+    for conn in conns:
+        pool._created[conn] -= secs
+        if conn in pool._idle_since:
+            pool._idle_since[conn] -= secs
+
+
+def test_threaded_pool_max_lifetime(client):
+    """ Test that connections are replaced after their max lifetime. """
+    pool = ThreadedConnectionPool(client, minconn=1, maxconn=2, max_lifetime=60)
+    pool.open()
+    conn = pool.get()
+    pool.put(conn)
+    assert pool.get() is conn
+    backdate(pool, [conn], 61)
+    # Expired connection is not put back to the pool.
+    pool.put(conn)
+    assert conn.closed
+    assert pool.idle_connection == 0
+    new_conn = pool.get()
+    assert new_conn is not conn
+    pool.put(new_conn)
+    backdate(pool, [new_conn], 61)
+    # Expired idle connection is not reused.
+    last_conn = pool.get()
+    assert new_conn.closed
+    assert last_conn is not new_conn
+    assert not last_conn.closed
+    pool.close()
+    with pytest.raises(ValueError):
+        _ = ThreadedConnectionPool(client, max_lifetime=0)
+
+
+def test_threaded_pool_idle_timeout(client):
+    """ Test closing timed out idle connections without maintenance. """
+    pool = ThreadedConnectionPool(client, minconn=2, maxconn=4, idle_timeout=60)
+    pool.open()
+    conns = [pool.get() for _ in range(4)]
+    for conn in conns:
+        pool.put(conn)
+    assert pool.idle_connection == 4
+    backdate(pool, conns[:3], 61)
+    # The least recently used connections are closed up to minconn.
+    conn = pool.get()
+    assert conn is conns[3]
+    assert all(conn.closed for conn in conns[:2])
+    assert not conns[2].closed
+    assert pool.idle_connection == 1
+    pool.put(conn)
+    backdate(pool, [conns[2]], 61)
+    pool.put(pool.get())
+    assert pool.idle_connection == 2
+    assert not conns[2].closed
+    pool.close()
+
+
+def test_threaded_pool_maintenance(client):
+    """ Test reaping idle connections and refilling the pool. """
+    pool = ThreadedConnectionPool(
+        client, minconn=2, maxconn=4, idle_timeout=60, maintenance_interval=0.1
+    )
+
+    def wait_for(cond):
+        deadline = time.monotonic() + 10
+        while not cond() and time.monotonic() < deadline:
+            time.sleep(0.05)
+        return cond()
+
+    pool.open()
+    conns = [pool.get() for _ in range(4)]
+    for conn in conns:
+        pool.put(conn)
+    assert pool.idle_connection == 4
+    backdate(pool, conns, 61)
+    assert wait_for(lambda: pool.idle_connection == 2)
+    # The most recently used connections are kept.
+    assert all(not conn.closed for conn in conns[2:])
+    assert all(conn.closed for conn in conns[:2])
+    conn = pool.get()
+    conn.close()
+    pool.put(conn)
+    assert wait_for(lambda: pool.idle_connection == 2)
+    pool.close()
+    assert pool.closed
+
+
+def test_threaded_pool_io_without_lock(client):
+    """ Test that opening and closing connections does not hold the lock. """
+    pool = ThreadedConnectionPool(client, minconn=2, maxconn=2)
+    locked = []
+    connect = client.connect
+
+    def connect_spy(*args, **kwargs):
+        locked.append(pool._lock.locked())
+        conn = connect(*args, **kwargs)
+        close = conn.close
+
+        def close_spy(*args, **kwargs):
+            locked.append(pool._lock.locked())
+            return close(*args, **kwargs)
+
+        conn.close = close_spy
+        return conn
+
+    client.connect = connect_spy
+    try:
+        pool.open()
+        assert pool.idle_connection == 2
+        pool.close()
+    finally:
+        del client.connect
+    assert len(locked) == 4
+    assert not any(locked)
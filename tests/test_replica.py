@@ -0,0 +1,180 @@
+import io
+import sys
+
+import pytest
+
+from bonsai import LDAPDN, LDAPEntry, LDAPSearchScope
+from bonsai.errors import FilterError
+from bonsai.replica import LocalReplica
+from bonsai.syncrepl import SyncConsumer
+
+LDIF = """dn: ou=people,dc=local,dc=test
+objectClass: organizationalUnit
+ou: people
+
+dn: cn=Alice,ou=people,dc=local,dc=test
+objectClass: inetOrgPerson
+cn: Alice
+sn: Smith
+uid: alice
+mail: Alice@Local.test
+
+dn: cn=Bob,ou=people,dc=local,dc=test
+objectClass: inetOrgPerson
+cn: Bob
+sn: Smith
+uid: bob
+
+dn: cn=admins,dc=local,dc=test
+objectClass: groupOfNames
+cn: admins
+member: cn=Alice,ou=people,dc=local,dc=test
+
+dn: cn=outside,dc=other,dc=test
+objectClass: person
+cn: outside
+sn: outside
+"""
+
+
+@pytest.fixture
+def replica():
+    """ Get a replica loaded from LDIF. """
+    replica = LocalReplica("dc=local,dc=test")
+    assert replica.load_ldif(io.StringIO(LDIF)) == 4
+    return replica
+
+
+def test_search_ldif(replica):
+    """ Test searching the replica with the supported filters. """
+    assert len(replica) == 4
+    assert "CN=alice, ou=People,dc=local,dc=test" in replica
+    assert "cn=outside,dc=other,dc=test" not in replica
+    res = replica.search(filter_exp="(uid=ALICE)")
+    assert [str(ent.dn) for ent in res] == ["cn=Alice,ou=people,dc=local,dc=test"]
+    assert res[0]["mail"] == ["Alice@Local.test"]
+    assert replica.search(filter_exp="(mail=alice@local.test)")[0]["uid"] == ["alice"]
+    res = replica.search(filter_exp="(sn=smith)")
+    assert len(res) == 2
+    res = replica.search(filter_exp="(&(sn=smith)(!(uid=alice)))")
+    assert [ent["cn"][0] for ent in res] == ["Bob"]
+    res = replica.search(filter_exp="(|(uid=alice)(uid=bob)(uid=carol))")
+    assert len(res) == 2
+    res = replica.search(filter_exp="(&(objectClass=*)(mail=*))")
+    assert len(res) == 1
+    res = replica.search(
+        filter_exp="(member=cn=alice,ou=people,dc=local,dc=test)", attrlist=["cn"]
+    )
+    assert list(res[0].keys()) == ["dn", "cn"]
+    assert res[0]["cn"].status == 0
+    res = replica.search(filter_exp="(&(cn=a*)(uid<=b))")
+    assert [str(ent.dn) for ent in res] == ["cn=Alice,ou=people,dc=local,dc=test"]
+    with pytest.raises(FilterError):
+        replica.search(filter_exp="(uid=alice")
+
+
+def test_scope(replica):
+    """ Test the base and the scope of the search. """
+    res = replica.search("ou=people,dc=local,dc=test", LDAPSearchScope.ONELEVEL)
+    assert len(res) == 2
+    res = replica.search("ou=people,dc=local,dc=test", LDAPSearchScope.SUBTREE)
+    assert len(res) == 3
+    res = replica.search(
+        "cn=bob,ou=people,dc=local,dc=test", LDAPSearchScope.BASE, "(uid=bob)"
+    )
+    assert len(res) == 1
+    res = replica.search("dc=local,dc=test", LDAPSearchScope.ONELEVEL, "(uid=alice)")
+    assert res == []
+
+
+def test_put_and_remove(replica):
+    """ Test that the indexes are maintained. """
+    entry = LDAPEntry("cn=Bob,ou=people,dc=local,dc=test")
+    entry["uid"] = "robert"
+    replica.put(entry)
+    assert replica.search(filter_exp="(uid=bob)") == []
+    assert replica.get(LDAPDN("cn=bob,ou=people,dc=local,dc=test"))["uid"] == [
+        "robert"
+    ]
+    replica.put(LDAPEntry("cn=x,dc=other,dc=test"))
+    assert len(replica) == 4
+    assert replica.remove("cn=bob,ou=people,dc=local,dc=test")
+    assert not replica.remove("cn=bob,ou=people,dc=local,dc=test")
+    assert replica.search(filter_exp="(uid=robert)") == []
+    assert replica.get("cn=bob,ou=people,dc=local,dc=test") is None
+
+
+def test_load_search(client, basedn):
+    """ Test loading the replica with a paged search. """
+    replica = LocalReplica(basedn)
+    with client.connect() as conn:
+        expected = len(conn.search(basedn, 2))
+        assert replica.load_search(conn, page_size=2) == expected
+        res = replica.search(filter_exp="(uid=sam)")
+        assert [ent.dn for ent in res] == [
+            ent.dn for ent in conn.search(basedn, 2, "(uid=sam)")
+        ]
+        assert res[0]["cn"] == ["sam"]
+
+
+def test_load_search_ranged(client, basedn):
+    """ Test that the paged loading acquires every value of a ranged attribute. """
+    group = LDAPEntry("cn=ranged_test,ou=nerdherd,%s" % basedn)
+    group["objectclass"] = ["top", "groupOfNames"]
+    group["cn"] = "ranged_test"
+    group["member"] = [
+        "cn=member_%d,ou=nerdherd,%s" % (idx, basedn) for idx in range(23)
+    ]
+    replica = LocalReplica(basedn)
+    with client.connect() as conn:
+        conn.add(group)
+        try:
+            replica.load_search(conn, page_size=2)
+        finally:
+            conn.delete(group.dn)
+    obj = replica.get(group.dn)
+    assert not any(";range=" in key for key in obj.keys())
+    assert sorted(obj["member"]) == sorted(group["member"])
+
+
+@pytest.mark.skipif(
+    sys.platform == "win32", reason="Content synchronization is not supported"
+)
+def test_sync_keeps_loaded(client, basedn):
+    """ Test that the entries without entryUUID are not removed by a sync. """
+    base = "ou=nerdherd,%s" % basedn
+    replica = LocalReplica(base)
+    loaded = LDAPEntry("cn=loaded,%s" % base)
+    loaded["uid"] = "loaded"
+    replica.put(loaded)
+    with client.connect() as conn:
+        consumer = SyncConsumer(conn, base)
+        replica.sync(consumer)
+        assert replica.get(loaded.dn)["uid"] == ["loaded"]
+        assert len(replica) == len(conn.search(base, 2)) + 1
+
+
+@pytest.mark.skipif(
+    sys.platform == "win32", reason="Content synchronization is not supported"
+)
+def test_sync(client, basedn):
+    """ Test keeping the replica current with content synchronization. """
+    base = "ou=nerdherd,%s" % basedn
+    replica = LocalReplica(base)
+    with client.connect() as conn:
+        consumer = SyncConsumer(conn, base)
+        replica.sync(consumer)
+        assert len(replica) == len(conn.search(base, 2))
+        entry = LDAPEntry("cn=replica_test,%s" % base)
+        entry["objectClass"] = ["top", "inetOrgPerson"]
+        entry["sn"] = "replica_test"
+        entry["uid"] = "replica_test"
+        conn.add(entry)
+        try:
+            replica.sync(consumer)
+            assert replica.search(filter_exp="(uid=replica_test)")[0].dn == entry.dn
+        finally:
+            conn.delete(entry.dn)
+        replica.sync(consumer)
+        assert replica.search(filter_exp="(uid=replica_test)") == []
+        assert len(replica) == len(conn.search(base, 2))
@@ -0,0 +1,177 @@
+import asyncio
+import time
+
+import pytest
+
+import bonsai
+from bonsai import LDAPDN, LDAPEntry, LDAPSearchScope
+from bonsai.searchcache import SearchCache
+
+
+@pytest.fixture
+def cache(client):
+    """ Set a search cache for the client. """
+    cache = SearchCache(ttl=60)
+    client.set_search_cache(cache)
+    yield cache
+    client.set_search_cache(None)
+
+
+def test_init():
+    """ Test the parameters of the cache. """
+    with pytest.raises(ValueError):
+        _ = SearchCache(ttl=0)
+    with pytest.raises(ValueError):
+        _ = SearchCache(maxsize=0)
+    with pytest.raises(ValueError):
+        _ = SearchCache(max_entries=0)
+    cli = bonsai.LDAPClient()
+    assert cli.search_cache is None
+    with pytest.raises(TypeError):
+        cli.set_search_cache({})
+
+
+def test_lru_and_ttl():
+    """ Test the expiration and the memory bounds of the cache. """
+    cache = SearchCache(ttl=0.5, maxsize=2, max_entries=3)
+    ent = LDAPEntry("cn=test,dc=bonsai,dc=test")
+    ent["cn"] = "test"
+    cache.put("a", "dc=bonsai,dc=test", [ent], cache.generation)
+    cache.put("b", "dc=bonsai,dc=test", [ent], cache.generation)
+    assert cache.get("a") is not None
+    cache.put("c", "dc=bonsai,dc=test", [ent], cache.generation)
+    # The least recently used is dropped.
+    assert cache.get("b") is None
+    assert len(cache) == 2
+    cache.put("d", "dc=bonsai,dc=test", [ent, ent], cache.generation)
+    assert cache.get("a") is None
+    assert len(cache) == 2
+    assert cache.get("d")[1]["cn"] == ["test"]
+    cache.put("e", "dc=bonsai,dc=test", [ent] * 4, cache.generation)
+    assert cache.get("e") is None
+    time.sleep(0.6)
+    assert cache.get("c") is None
+    assert cache.get("d") is None
+    assert len(cache) == 0
+    # Not stored, when an invalidation happens during the search.
+    generation = cache.generation
+    cache.invalidate("cn=other,dc=bonsai,dc=test")
+    cache.put("a", "dc=bonsai,dc=test", [ent], generation)
+    assert cache.get("a") is None
+
+
+def test_invalidate():
+    """ Test dropping the results of the ancestors and descendants. """
+    cache = SearchCache()
+    bases = [
+        "dc=bonsai,dc=test",
+        "ou=nerdherd,dc=bonsai,dc=test",
+        "cn=chuck,ou=nerdherd,dc=bonsai,dc=test",
+        "ou=groups,dc=bonsai,dc=test",
+    ]
+    for base in bases:
+        cache.put(base, base, [], cache.generation)
+    cache.invalidate(LDAPDN("OU=Nerdherd,dc=bonsai,dc=test"))
+    assert [base for base in bases if cache.get(base) is not None] == [bases[3]]
+    cache.clear()
+    assert len(cache) == 0
+    # A result of the root DSE is affected by every write.
+    cache.put("root", "", [], cache.generation)
+    cache.put("other", "dc=other", [], cache.generation)
+    cache.invalidate("cn=test,dc=bonsai,dc=test")
+    assert cache.get("root") is None
+    assert cache.get("other") is not None
+    cache.invalidate("dc=other")
+    assert len(cache) == 0
+
+
+def test_search(conn, cache, basedn):
+    """ Test that the search results are cached and copied. """
+    res = conn.search(basedn, LDAPSearchScope.SUBTREE, "(cn=chuck)", ["cn", "sn"])
+    assert cache.misses == 1
+    res[0]["sn"] = "modified"
+    cached = conn.search(basedn, LDAPSearchScope.SUBTREE, "(cn=chuck)", ["cn", "sn"])
+    assert cache.hits == 1
+    assert cached[0].dn == res[0].dn
+    assert cached[0]["sn"] != ["modified"]
+    assert cached[0]["sn"].status == 0
+    assert cached[0].connection is conn
+    _ = conn.search(basedn, LDAPSearchScope.SUBTREE, "(cn=chuck)", ["cn"])
+    assert cache.misses == 2
+
+
+def test_write_invalidates(conn, cache, basedn):
+    """ Test that writing an entry drops the results of its subtree. """
+    dname = "cn=cache-test,ou=nerdherd,%s" % basedn
+    search = lambda: conn.search(
+        "ou=nerdherd,%s" % basedn,
+        LDAPSearchScope.ONELEVEL,
+        "(|(cn=cache-test)(cn=cache-test2))",
+        ["sn"],
+    )
+    assert search() == []
+    entry = LDAPEntry(dname)
+    entry.update(
+        {"objectclass": ["top", "inetorgperson"], "cn": "cache-test", "sn": "a"}
+    )
+    try:
+        conn.add(entry)
+        assert search()[0]["sn"] == ["a"]
+        entry["sn"] = "b"
+        entry.modify()
+        assert search()[0]["sn"] == ["b"]
+        entry.rename("cn=cache-test2,ou=nerdherd,%s" % basedn)
+        assert search()[0].dn == LDAPDN("cn=cache-test2,ou=nerdherd,%s" % basedn)
+        assert cache.hits == 0
+    finally:
+        conn.delete(entry.dn)
+    assert search() == []
+    assert cache.hits == 0
+
+
+def test_bound_identity(client, conn, cache, basedn):
+    """ Test that the results are not shared between different users. """
+    other = bonsai.LDAPClient(client.url)
+    # Bind anonymously.
+    other.set_credentials("SIMPLE")
+    other.set_search_cache(cache)
+    search = lambda conn: conn.search(
+        basedn, LDAPSearchScope.SUBTREE, "(cn=chuck)", ["cn"]
+    )
+    _ = search(conn)
+    with other.connect() as other_conn:
+        _ = search(other_conn)
+        assert cache.hits == 0
+        assert len(cache) == 2
+        _ = search(other_conn)
+    _ = search(conn)
+    assert cache.hits == 2
+
+
+def test_async_write_invalidates(client, conn, cache, basedn):
+    """ Test that an asynchronous write drops the results cached meanwhile. """
+    entry = LDAPEntry("cn=cache-async-test,ou=nerdherd,%s" % basedn)
+    entry.update(
+        {"objectclass": ["top", "inetorgperson"], "cn": "cache-async-test", "sn": "a"}
+    )
+    search = lambda: conn.search(
+        "ou=nerdherd,%s" % basedn,
+        LDAPSearchScope.ONELEVEL,
+        "(cn=cache-async-test)",
+        ["sn"],
+    )
+
+    async def add():
+        async with client.connect(True) as aconn:
+            pending = aconn.add(entry)
+            # Cache a result while the add operation is running.
+            _ = search()
+            assert len(cache) == 1
+            await pending
+        assert len(cache) == 0
+
+    try:
+        asyncio.run(add())
+        assert search()[0]["sn"] == ["a"]
+    finally:
+        conn.delete(entry.dn)
@@ -0,0 +1,100 @@
+import asyncio
+import sys
+
+import pytest
+
+from bonsai import LDAPSearchScope
+from bonsai.errors import SyncRefreshRequired
+from bonsai.syncrepl import SyncConsumer, SyncState
+
+pytestmark = pytest.mark.skipif(
+    sys.platform == "win32", reason="Content synchronization is not supported"
+)
+
+
+def test_refresh(conn, basedn, entry):
+    """ Test refreshOnly synchronization with a cookie. """
+    consumer = SyncConsumer(conn, "ou=nerdherd,%s" % basedn, LDAPSearchScope.ONELEVEL)
+    events = consumer.refresh()
+    assert consumer.refresh_done
+    assert consumer.cookie is not None
+    assert len(events) == len(conn.search("ou=nerdherd,%s" % basedn, 1))
+    assert all(evt.state == SyncState.ADD for evt in events)
+    assert all(len(evt.uuids[0]) == 16 for evt in events)
+    conn.add(entry)
+    events = consumer.refresh()
+    assert [evt.entry.dn for evt in events] == [entry.dn]
+    uuid = events[0].uuids[0]
+    conn.delete(entry.dn)
+    events = consumer.refresh()
+    assert consumer.refresh_deletes
+    assert [(evt.state, evt.entry, evt.uuids) for evt in events] == [
+        (SyncState.DELETE, None, [uuid])
+    ]
+    assert consumer.refresh() == []
+
+
+def test_cookie_path(conn, basedn, tmp_path):
+    """ Test loading and saving the cookie. """
+    path = str(tmp_path / "cookie")
+    consumer = SyncConsumer(conn, basedn, cookie_path=path)
+    consumer.refresh()
+    with open(path, "rb") as cookie_file:
+        assert cookie_file.read() == consumer.cookie
+    consumer = SyncConsumer(conn, basedn, cookie_path=path)
+    assert consumer.cookie is not None
+    assert consumer.refresh() == []
+
+
+def test_refresh_required(conn, basedn, tmp_path):
+    """ Test that the cookie is dropped, when the content must be reloaded. """
+    path = str(tmp_path / "cookie")
+    consumer = SyncConsumer(conn, basedn, cookie=b"stale", cookie_path=path)
+    with pytest.raises(SyncRefreshRequired):
+        consumer.refresh()
+    assert consumer.cookie is None
+    assert len(consumer.refresh()) > 0
+
+
+def test_listen(client, conn, basedn, entry):
+    """ Test refreshAndPersist synchronization. """
+    with client.connect() as listen_conn:
+        with SyncConsumer(
+            listen_conn, "ou=nerdherd,%s" % basedn, LDAPSearchScope.ONELEVEL
+        ) as consumer:
+            events = list(consumer.listen(timeout=1))
+            assert consumer.refresh_done
+            assert len(events) > 0
+            cookie = consumer.cookie
+            conn.add(entry)
+            events = list(consumer.listen(timeout=1))
+            assert [(evt.state, evt.entry.dn) for evt in events] == [
+                (SyncState.ADD, entry.dn)
+            ]
+            assert consumer.cookie != cookie
+            conn.delete(entry.dn)
+            events = list(consumer.listen(timeout=1))
+            assert [evt.state for evt in events] == [SyncState.DELETE]
+
+
+def test_listen_async(client, conn, basedn, entry):
+    """ Test refreshAndPersist synchronization with an async connection. """
+
+    async def listen():
+        async with client.connect(True) as aconn:
+            consumer = SyncConsumer(
+                aconn, "ou=nerdherd,%s" % basedn, LDAPSearchScope.ONELEVEL
+            )
+            events = await consumer.refresh_async()
+            assert len(events) > 0
+            stream = consumer.listen_async()
+            conn.add(entry)
+            # The entry is received either in the refresh or in the persist stage.
+            evt = await asyncio.wait_for(stream.__anext__(), 5)
+            while evt.entry is None or evt.entry.dn != entry.dn:
+                evt = await asyncio.wait_for(stream.__anext__(), 5)
+            assert evt.state in (SyncState.ADD, SyncState.MODIFY)
+            await stream.aclose()
+            consumer.close()
+
+    asyncio.run(listen())
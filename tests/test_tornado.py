@@ -1,11 +1,14 @@
 import unittest
+from unittest import mock
 import sys
+import time
 
 import pytest
 from conftest import get_config, network_delay
 
 from bonsai import LDAPClient
 from bonsai import LDAPEntry
+from bonsai.ldapconnection import BaseLDAPConnection
 import bonsai.errors
 
 
@@ -181,6 +184,57 @@ class TornadoLDAPConnectionTest(TestCaseClass):
             ]
             assert obj in expected_res
 
+    @gen_test(timeout=20.0)
+    def test_concurrent_operations(self):
+        """Test running multiple operations on the same connection concurrently."""
+        with (yield self.client.connect(True, ioloop=self.io_loop)) as conn:
+            expected = yield conn.search()
+            results = yield [conn.search() for _ in range(10)]
+            whoami = yield conn.whoami()
+            assert all(len(res) == len(expected) for res in results)
+            assert whoami is not None
+
+    @gen_test(timeout=10.0)
+    def test_dispatch_queued_response(self):
+        """
+        Test that a response, that's queued by libldap while reading the
+        response of another operation, still resolves its future.
+        """
+        get_result = BaseLDAPConnection.get_result
+        held = []
+        released = []
+
+        def get_result_spy(conn, msg_id, *args, **kwargs):
+            if not held:
+                held.append(msg_id)
+            if msg_id == held[0] and not released:
+                # Pretend that the response hasn't arrived yet.
+                return None
+            res = get_result(conn, msg_id, *args, **kwargs)
+            if res is not None:
+                released.append(msg_id)
+            return res
+
+        with (yield self.client.connect(True, ioloop=self.io_loop)) as conn:
+            with mock.patch.object(BaseLDAPConnection, "get_result", get_result_spy):
+                futs = [conn.whoami() for _ in range(2)]
+                # Block the loop to receive both responses in one read.
+                time.sleep(1)
+                results = yield futs
+            assert all(res is not None for res in results)
+
+    @gen_test(timeout=20.0)
+    def test_dispatch_error(self):
+        """Test that an unexpected error fails the pending operation."""
+        with (yield self.client.connect(True, ioloop=self.io_loop)) as conn:
+            fut = conn.search()
+            with mock.patch.object(
+                BaseLDAPConnection, "get_result", side_effect=RuntimeError("fail")
+            ):
+                with pytest.raises(RuntimeError):
+                    yield fut
+            assert conn._waiters == {}
+
     @gen_test(timeout=12.0)
     def test_connection_timeout(self):
         """Test connection timeout."""
@@ -1,14 +1,18 @@
 import sys
+import time
 from functools import wraps, partial
+from unittest import mock
 
 import pytest
 from conftest import get_config, network_delay
 
 from bonsai import LDAPEntry, LDAPClient
+from bonsai.ldapconnection import BaseLDAPConnection
 import bonsai.errors
 
 try:
     import trio
+    import trio.testing
     from bonsai.trio import TrioLDAPConnection
 except ImportError:
     pass
@@ -166,6 +170,62 @@ async def test_whoami(tclient):
         assert obj in expected_res
 
 
+@trio_test
+async def test_concurrent_operations(tclient):
+    """Test running multiple operations on the same connection concurrently."""
+    results = []
+
+    async def search(conn):
+        results.append(await conn.search())
+
+    async with tclient.connect(True) as conn:
+        expected = await conn.search()
+        async with trio.open_nursery() as nursery:
+            for _ in range(10):
+                nursery.start_soon(search, conn)
+            nursery.start_soon(conn.whoami)
+    assert len(results) == 10
+    assert all(len(res) == len(expected) for res in results)
+
+
+@trio_test
+async def test_dispatch_queued_response(tclient):
+    """
+    Test that a response, that's queued by libldap while reading the
+    response of another operation, still wakes up its waiting task.
+    """
+    get_result = BaseLDAPConnection.get_result
+    held = []
+    released = []
+
+    def get_result_spy(self, msg_id, *args, **kwargs):
+        if not held:
+            held.append(msg_id)
+        if msg_id == held[0] and not released:
+            # Pretend that the response hasn't arrived yet.
+            return None
+        res = get_result(self, msg_id, *args, **kwargs)
+        if res is not None:
+            released.append(msg_id)
+        return res
+
+    results = []
+
+    async def whoami(conn):
+        results.append(await conn.whoami())
+
+    async with tclient.connect(True) as conn:
+        with mock.patch.object(BaseLDAPConnection, "get_result", get_result_spy):
+            with trio.fail_after(10):
+                async with trio.open_nursery() as nursery:
+                    nursery.start_soon(whoami, conn)
+                    nursery.start_soon(whoami, conn)
+                    await trio.testing.wait_all_tasks_blocked()
+                    # Block the loop to receive both responses in one read.
+                    time.sleep(1)
+    assert len(results) == 2
+
+
 @pytest.mark.timeout(18)
 @trio_test
 async def test_connection_timeout(tclient):